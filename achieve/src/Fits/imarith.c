@@ -26,6 +26,12 @@ Examples:
 
     in the 1st and 2nd extensions of the file data.fit
 
+- synthimage -p 256 - | imarith - 2.0 mul - | imstat -
+
+    with "-" for the standard input and output, so that the images are
+    piped between the tools without files on disk; the error messages
+    go to the standard error, so that they do not mix with the output
+
 This program first opens the input images. If 2 images, it checks that
 they have the same dimensions. It then creates the empty output file
 and copies the header of the first image into it (thus duplicating the
@@ -34,10 +40,12 @@ of the images. The program computes the output image values by reading
 one row at a time from the input image(s), performing the desired
 arithmetic operation, and then writing the resulting row to the output
 file. The program reads and writes the row of data in double precision
-format, regardless of the intrinsic datatype of the images; CFITSIO
-transparently converts the data format if necessary as the rows are
-read and written. This program also supports 3D data cubes by looping
-through each plane of the cube.
+format, unless the first image is stored as floats and the second one
+(if any) as floats or short integers, in which case the rows are read
+and written as floats with no conversion, and only the arithmetic is
+done in double precision; CFITSIO transparently converts the data 
+format if necessary as the rows are read and written. This program 
+also supports 3D data cubes by looping through each plane of the cube.
 
 2010-08-19  modified to allow numeric second argument 
    (contributed by Michal Szymanski, Warsaw University Observatory)
@@ -67,9 +75,13 @@ int main(int argc, char *argv[])
     fitsfile *afptr, *bfptr, *outfptr;  /* FITS file pointers */
     int status = 0;  /* CFITSIO status value MUST be initialized to zero! */
     int atype, btype, anaxis, bnaxis, check = 1, ii, op;
+    int abitpix, bbitpix;      // BITPIX of the stored pixels
+    int pixtype = TDOUBLE;     // type in which the rows are read and written
     long npixels = 1, firstpix[3] = {1,1,1}, ntodo;
     long anaxes[3] = {1,1,1}, bnaxes[3]={1,1,1};
     double *apix, *bpix, value;
+    float *afpix, *bfpix;      // the rows, if they are read as floats
+    double aval, bval;         // the values of a pair of pixels
     int image2=1;
     
     if (argc != 5) { 
@@ -82,6 +94,7 @@ int main(int argc, char *argv[])
       printf("Examples: \n");
       printf("  imarith in1.fits in2.fits a out.fits - add the 2 files\n");
       printf("  imarith in1.fits 1000.0 mul out.fits - mult in1 by 1000\n");
+      printf("  imarith - 1000.0 mul - - from stdin to stdout\n");
       return(0);
     }
 
@@ -94,7 +107,7 @@ int main(int argc, char *argv[])
     if (status) {
       value = atof(argv[2]);
       if (value == 0.0) {
-	printf("Error: second argument is neither an image name"
+	fprintf(stderr,"Error: second argument is neither an image name"
 	       " nor a valid numerical value.\n");
 	return(status);
       }
@@ -107,20 +120,33 @@ int main(int argc, char *argv[])
     fits_get_img_size(afptr, 3, anaxes, &status);
     if (image2) fits_get_img_size(bfptr, 3, bnaxes, &status);
 
+    /* read the rows as floats if the output (which has the type of the first */
+    /* image) is stored as floats and floats hold the second image exactly    */
+    fits_get_img_type(afptr, &abitpix, &status);
+    fits_get_img_equivtype(afptr, &atype, &status);
+    if (image2) {
+      fits_get_img_type(bfptr, &bbitpix, &status);
+      fits_get_img_equivtype(bfptr, &btype, &status);
+    }
+    if (abitpix == FLOAT_IMG && atype == FLOAT_IMG &&
+	(!image2 || (bbitpix == FLOAT_IMG && btype == FLOAT_IMG) ||
+	 btype == BYTE_IMG || btype == SBYTE_IMG || btype == SHORT_IMG || btype == USHORT_IMG))
+      pixtype = TFLOAT;
+
     if (status) {
        fits_report_error(stderr, status); /* print error message */
        return(status);
     }
 
     if (anaxis > 3) {
-       printf("Error: images with > 3 dimensions are not supported\n");
+       fprintf(stderr,"Error: images with > 3 dimensions are not supported\n");
        check = 0;
     }
          /* check that the input 2 images have the same size */
     else if ( image2 && ( anaxes[0] != bnaxes[0] || 
 			  anaxes[1] != bnaxes[1] || 
 			  anaxes[2] != bnaxes[2] ) ) {
-       printf("Error: input images don't have same size\n");
+       fprintf(stderr,"Error: input images don't have same size\n");
        check = 0;
     }
 
@@ -133,7 +159,7 @@ int main(int argc, char *argv[])
     else if (*argv[3] == 'd' || *argv[3] == 'D')
       op = 4;
     else {
-      printf("Error: unknown arithmetic operator\n");
+      fprintf(stderr,"Error: unknown arithmetic operator\n");
       check = 0;
     }
 
@@ -147,9 +173,11 @@ int main(int argc, char *argv[])
 
       apix = (double *) malloc(npixels * sizeof(double)); /* mem for 1 row */
       if (image2) bpix = (double *) malloc(npixels * sizeof(double)); 
+      afpix = (float *) apix;   /* the same memory, if read as floats */
+      bfpix = (image2 ? (float *) bpix : NULL);
 
       if (apix == NULL || (image2 && bpix == NULL)) {
-        printf("Memory allocation error\n");
+        fprintf(stderr,"Memory allocation error\n");
         return(1);
       }
 
@@ -159,54 +187,51 @@ int main(int argc, char *argv[])
         /* loop over all rows of the plane */
         for (firstpix[1] = 1; firstpix[1] <= anaxes[1]; firstpix[1]++)
         {
-          /* Read both images as doubles, regardless of actual datatype.  */
+          /* Read both images as doubles (or floats, see above).          */
           /* Give starting pixel coordinate and no. of pixels to read.    */
           /* This version does not support undefined pixels in the image. */
 
-          if (fits_read_pix(afptr, TDOUBLE, firstpix, npixels, NULL, apix,
+          if (fits_read_pix(afptr, pixtype, firstpix, npixels, NULL, apix,
                             NULL, &status))
 	    break;   /* jump out of loop on error */
-	  if (image2 && fits_read_pix(bfptr, TDOUBLE, firstpix, npixels,
+	  if (image2 && fits_read_pix(bfptr, pixtype, firstpix, npixels,
 				      NULL, bpix, NULL, &status))
 	    break;   /* jump out of loop on error */
 
-          switch (op) {
-          case 1:         
-            for(ii=0; ii< npixels; ii++)
-	      if (image2)
-		apix[ii] += bpix[ii];
-	      else
-		apix[ii] += value;
-            break;
-          case 2:
-            for(ii=0; ii< npixels; ii++)
-	      if (image2)
-		apix[ii] -= bpix[ii];
-	      else
-		apix[ii] -= value;
-            break;
-          case 3:
-            for(ii=0; ii< npixels; ii++)
-	      if (image2)
-		apix[ii] *= bpix[ii];
-	      else
-		apix[ii] *= value;
-            break;
-          case 4:
-            for(ii=0; ii< npixels; ii++) {
-	      if (image2) {
-		if (bpix[ii] !=0.)
-		  apix[ii] /= bpix[ii];
-		else
-		  apix[ii] = 0.;
-	      }
-	      else {
-		apix[ii] /= value;
-	      }
+          /* the arithmetic is done in double precision in either case */
+          for(ii=0; ii< npixels; ii++) {
+            aval = (pixtype == TFLOAT ? afpix[ii] : apix[ii]);
+            if (image2)
+              bval = (pixtype == TFLOAT ? bfpix[ii] : bpix[ii]);
+            else
+              bval = value;
+
+            switch (op) {
+            case 1:         
+              aval += bval;
+              break;
+            case 2:
+              aval -= bval;
+              break;
+            case 3:
+              aval *= bval;
+              break;
+            case 4:
+              if (!image2)
+                aval /= bval;
+              else if (bval != 0.)
+                aval /= bval;
+              else
+                aval = 0.;
             }
+
+            if (pixtype == TFLOAT)
+              afpix[ii] = aval;
+            else
+              apix[ii] = aval;
           }
 
-          fits_write_pix(outfptr, TDOUBLE, firstpix, npixels,
+          fits_write_pix(outfptr, pixtype, firstpix, npixels,
                        apix, &status); /* write new values to output image */
         }
       }    /* end of loop over planes */
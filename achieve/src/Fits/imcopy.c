@@ -269,7 +269,7 @@ int main(int argc, char *argv[])
           }
 
           if (!array)  {
-              printf("Memory allocation error\n");
+              fprintf(stderr,"Memory allocation error\n");
               return(0);
           }
 
@@ -22,8 +22,10 @@ that the HDU is a 2D image. (It could easily be extended to support 3D
 data cubes as well, as is done in the imarith program). It then
 allocates memory to hold 1 row of pixels, and loops through the image,
 accumulating the statistics row by row. Note that the program reads
-the image into an array of doubles, regardless of the intrinsic
-datatype of the image.
+the image into an array of doubles, unless it is stored as floats or
+short integers, which floats hold exactly; then it reads the image 
+into an array of floats, with no conversion, and still accumulates 
+the statistics in double precision.
 
 Version 1.0: September 29, 2017 (DP)
  
@@ -53,8 +55,12 @@ int main(int argc, char *argv[])
     fitsfile *fptr;  /* FITS file pointer */
     int status = 0;  /* CFITSIO status value MUST be initialized to zero! */
     int hdutype, naxis, ii;
+    int bitpix, equivtype;           // BITPIX of the stored and of the scaled pixels
+    int pixtype = TDOUBLE;           // type in which the rows are read
     long naxes[2], totpix, fpixel[2];
     double *pix, sum = 0., meanval = 0., minval = 1.E33, maxval = -1.E33;
+    float *fpix;                     // the row, if it is read as floats
+    double value;                    // the value of a pixel
     int xlocmax,ylocmax,xlocmin,ylocmin;     // pixel location of max and min values
     double xcenter=0.0,ycenter=0.0;   // brightness center of the image
     
@@ -86,7 +92,15 @@ int main(int argc, char *argv[])
         return(1);
       }
 
+      // read the rows as floats if floats hold the pixels exactly
+      fits_get_img_type(fptr, &bitpix, &status);
+      fits_get_img_equivtype(fptr, &equivtype, &status);
+      if ((bitpix == FLOAT_IMG && equivtype == FLOAT_IMG) || equivtype == BYTE_IMG ||
+	  equivtype == SBYTE_IMG || equivtype == SHORT_IMG || equivtype == USHORT_IMG)
+	pixtype = TFLOAT;
+
       pix = (double *) malloc(naxes[0] * sizeof(double)); /* memory for 1 row */
+      fpix = (float *) pix;                               /* the same memory, if read as floats */
 
       if (pix == NULL) {
         printf("Memory allocation error\n");
@@ -100,25 +114,26 @@ int main(int argc, char *argv[])
       for (fpixel[1] = 1; fpixel[1] <= naxes[1]; fpixel[1]++)
       {  
          /* give starting pixel coordinate and number of pixels to read */
-         if (fits_read_pix(fptr, TDOUBLE, fpixel, naxes[0],0, pix,0, &status))
+         if (fits_read_pix(fptr, pixtype, fpixel, naxes[0],0, pix,0, &status))
             break;   /* jump out of loop on error */
 
          for (ii = 0; ii < naxes[0]; ii++) {
-           sum += pix[ii];                      /* accumlate sum */
-           if (pix[ii] < minval)
+           value = (pixtype == TFLOAT ? fpix[ii] : pix[ii]);
+           sum += value;                        /* accumlate sum */
+           if (value < minval)
 	     {
-	       minval = pix[ii];        /* find min value,  */
+	       minval = value;          /* find min value,  */
 	       xlocmin = fpixel[1];     /* its x-location */
 	       ylocmin = ii;            /* and its x-location */
 	     }
-           if (pix[ii] > maxval)
+           if (value > maxval)
 	     {
-	       maxval = pix[ii];        /* find max value,   */
+	       maxval = value;          /* find max value,   */
 	       xlocmax = fpixel[1];     /* its x-location */
 	       ylocmax = ii;            /* and its x-location */
 	     }
-	   xcenter+= pix[ii]*fpixel[1];      // accumulate weighted x-location
-	   ycenter+= pix[ii]*ii;             // accumulate weighted y-location
+	   xcenter+= value*fpixel[1];        // accumulate weighted x-location
+	   ycenter+= value*ii;               // accumulate weighted y-location
          }
       }
       
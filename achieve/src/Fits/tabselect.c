@@ -41,7 +41,7 @@ int main(int argc, char *argv[])
     {
         if (fits_get_hdu_type(infptr, &hdutype,&status) || 
             hdutype==IMAGE_HDU) {
-            printf("Error: input HDU is not a table\n");
+            fprintf(stderr,"Error: input HDU is not a table\n");
         } else {
 
             fits_get_hdu_num(infptr, &hdunum);  /* save current HDU location */
@@ -0,0 +1,724 @@
+#define _XOPEN_SOURCE 700                // for nftw()
+#include<stdio.h>
+#include<math.h>
+#include<stdlib.h>
+#include<unistd.h>
+#include<string.h>
+#include<strings.h>
+#include<ftw.h>
+#include<fnmatch.h>
+#include<sys/stat.h>
+#ifdef _OPENMP
+#include<omp.h>
+#endif
+
+#include "io.h"
+/*! \file
+  \brief
+  Creates and updates a catalog of the metadata of a library of FITS images
+
+  \details
+  This program walks one or more directory trees, reads the metadata of
+  each FITS file in them, and stores it in a compact binary catalog (see
+  writeFITSIndex() in io.c). For each file, the catalog has its size and
+  the time of its last modification, the sizes (NAXISn) and the BITPIX
+  of its primary image, the axes of type TIME and STOKES, the keywords
+  CDELT1, CDELT2, OBJECT, FREQ, and MJD (or MJD-OBS), and the number and
+  the types of its HDUs. The batch tools (e.g., image2uv -I catalog) then
+  take the sizes of their inputs from the catalog, with a stat() of each
+  file instead of opening it and parsing its header, and the catalog can
+  be listed instead of globbing the directory trees again.
+
+  The files are those with the names ending in .fits, .fit, .fts, .fits.gz,
+  .fit.gz, or .fz (in upper or lower case). The directories are walked on
+  one thread and the headers of the files are read in parallel (with
+  OpenMP, if CFITSIO is reentrant).
+
+  If the catalog already exists, it is updated: only the files that are
+  new or whose size or time of last modification has changed are read
+  again, the files that are no longer in the directories are removed,
+  and the files of the catalog outside the directories are kept.
+
+  Use: achieve-index [-svr] [-j Nthreads] [-I catalog] directory [directory ...]
+       achieve-index -l|-L [-g pattern] [-I catalog]
+
+  The required options are:
+  - "directory": a directory tree with FITS files (or a single FITS file)
+
+  The optional options are:
+  - "-I catalog": sets the filename of the catalog (default: achieve.idx)
+  - "-r": reads all the files in the directories again, even if they are up to date in the catalog, and replaces a catalog that cannot be read (e.g., one written on a machine with a different byte order)
+  - "-j Nthreads": reads the headers of the files on Nthreads threads (default: 1)
+  - "-l": lists the filenames in the catalog, one per line, instead of updating it (e.g., as the manifest of image2uv -l)
+  - "-L": lists the filenames in the catalog with their metadata: the sizes of the primary image, BITPIX, CDELT1, CDELT2, the types of the HDUs (I: image, A: ASCII table, B: binary table), OBJECT, FREQ, MJD, and the size of the file
+  - "-g pattern": lists only the files whose names match the shell wildcard pattern (e.g., "lib/MAD/a+0.5/image_*_80.fits")
+  - "-s": silent mode. It does not print anything
+  - "-v": verbose mode. It also prints the names of the files that could not be read
+
+  If no options are given, it prints a help message
+
+  Examples:
+
+  - achieve-index -j 16 -I lib.idx lib
+
+  Reads the metadata of all the FITS files under the directory lib into
+  lib.idx; running it again reads only the files that changed
+
+  - achieve-index -l -g 'lib/MAD/image_*.fits' -I lib.idx | image2uv -I lib.idx -p 512 -d uv -l -
+
+  Transforms all the images of the MAD models in the library, without
+  walking the directories or opening each file to read its sizes
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+// Definitions
+
+#define DEFAULTINDEXFILE "achieve.idx"   //!< default filename of the catalog, if -I option is not given
+#define VMODEDEFAULT 1                   //!< default verbose mode "medium"
+#define MAXPATH 1024                     //!< maximum number of characters for paths
+#define NTHREADSDEFAULT 1                //!< default number of threads
+#define NFTWFDS 32                       //!< maximum number of directories kept open while walking a tree
+#define RED "\x1B[31m"                   //!< color RED for error output
+#define RESETCOLOR "\x1B[0m"             //!< color to reset to normal
+
+/*!
+  \brief Options of achieve-index, as set on the command line
+*/
+typedef struct
+{
+  char indexFile[MAXPATH];      //!< filename of the catalog
+  char **roots;                 //!< the directory trees that are walked
+  int Nroots;                   //!< number of directory trees
+  int vmode;                    //!< flag for verbose mode (0:silent, 1: normal, 2: verbose)
+  int rescan;                   //!< flag for reading all the files again (-r)
+  int nthreads;                 //!< number of threads
+  int list;                     //!< flag for listing the catalog (0: update it, 1: names (-l), 2: metadata (-L))
+  char *pattern;                //!< wildcard pattern of the listed filenames, or NULL
+} indexOptions;
+
+/*!
+  \brief A file of the new catalog, while it is built
+*/
+typedef struct
+{
+  char *name;                   //!< filename
+  fitsIndexEntry entry;         //!< metadata of the file (the offsets of the strings are set at the end)
+  char *object;                 //!< value of OBJECT
+  int walked;                   //!< flag for a file found in the directories (not only in the old catalog)
+  int read;                     //!< flag for a file whose header is read
+} indexFile;
+
+/*!
+  \brief The files found while walking the directories with nftw(), which takes no argument for them
+*/
+static struct
+{
+  indexFile *files;             //!< the files
+  int Nfiles;                   //!< number of files
+  int capacity;                 //!< number of files that fit in the memory allocated
+  int vmode;                    //!< flag for verbose mode
+} walk;
+
+/*!
+\brief Prints an error message
+
+\details
+
+\version 1.0
+
+@param errmsg[] a string with the error message to be printed
+
+\return nothing
+
+*/
+void printErrorIndex(char errmsg[])
+{
+  fprintf(stderr,RED "achieve-index: %s" RESETCOLOR,errmsg);
+
+  return;
+}
+
+/*!
+\brief Prints a help message when no other arguments are given
+
+\details
+
+\version 1.0
+
+\pre It is called from parse()
+
+@param no parameters
+
+\return nothing
+
+*/
+void printhelp(void)
+{
+  printf("\n");
+  printf("Reads the metadata of all the FITS files in one or more directory trees\n");
+  printf("into a catalog, which is updated when it is created again, and lists it.\n");
+  printf("\n");
+  printf("Use: achieve-index [-svr] [-j Nthreads] [-I <catalog>] <dir> [<dir> ...]\n");
+  printf("     achieve-index -l|-L [-g <pattern>] [-I <catalog>]\n");
+  printf("\n");
+  printf("Options:\n");
+  printf("\n");
+  printf("-I <catalog>: sets the filename of the catalog (default: %s).\n",DEFAULTINDEXFILE);
+  printf("-r: reads all the files again, even if they are up to date in the catalog.\n");
+  printf("-j Nthreads: reads the headers of the files on Nthreads threads (default: %d).\n",NTHREADSDEFAULT);
+  printf("-l: lists the filenames in the catalog, one per line.\n");
+  printf("-L: lists the filenames in the catalog with their sizes, BITPIX, CDELT1, CDELT2, HDUs,\n");
+  printf("    OBJECT, FREQ, MJD, and the sizes of the files.\n");
+  printf("-g <pattern>: lists only the files whose names match the wildcard <pattern>.\n");
+  printf("-s: silent mode. It does not print anything.\n");
+  printf("-v: verbose mode. It also prints the names of the files that could not be read.\n");
+  printf("\n");
+}
+
+/*!
+\brief Parses the command line
+
+\details
+It returns the options in opt. The non-option arguments are the
+directory trees that are walked; they are not needed to list the
+catalog.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param argc an int (as is piped from the unix prompt)
+
+@param argv[] an array of strings (as is piped from the unix prompt)
+
+@param *opt a pointer to the options, which returns the values set on the command line
+
+\return Returns zero if successful, 1 if not
+
+*/
+int parse(int argc, char *argv[], indexOptions *opt)
+{
+  int option = 0;
+  int index;
+  int length;          // length of a directory name
+
+  opterr=0;            // do not print any other errors
+
+  if (argc==1)         // if no options are given
+    {
+      printhelp();     // print help message and return with a code to do nothing
+      return 1;
+    }
+
+  strcpy(opt->indexFile,DEFAULTINDEXFILE);  // default filename of the catalog
+  opt->vmode=VMODEDEFAULT;                  // default verbose mode "medium"
+  opt->rescan=0;                            // only the files that changed are read by default
+  opt->nthreads=NTHREADSDEFAULT;            // default number of threads
+  opt->list=0;                              // update the catalog by default
+  opt->pattern=NULL;                        // list all the files by default
+
+  // parse through arguments with options
+  while ((option = getopt(argc, argv, "I:svrj:lLg:")) != -1)
+    {
+      switch(option)
+	{
+	case 'I':
+	  snprintf(opt->indexFile,MAXPATH,"%s",optarg);
+	  break;
+	case 's':
+	  opt->vmode=0;                     // verbose mode "silent"
+	  break;
+	case 'v':
+	  opt->vmode=2;                     // verbose mode "verbose"
+	  break;
+	case 'r':
+	  opt->rescan=1;                    // read all the files again
+	  break;
+	case 'j':                           // number of threads
+	  opt->nthreads=strtol(optarg, NULL, 10);
+	  if (opt->nthreads<=0)
+	    {
+	      printErrorIndex("Invalid number of threads\n");
+	      return 1;
+	    }
+	  break;
+	case 'l':
+	  opt->list=1;                      // list the filenames
+	  break;
+	case 'L':
+	  opt->list=2;                      // list the filenames with their metadata
+	  break;
+	case 'g':
+	  opt->pattern=optarg;
+	  break;
+	case '?':
+	    {
+	      printErrorIndex("Invalid option received\n");
+	    }
+	  break;
+	}
+    }
+
+  // all the non-option arguments are directory trees, without their trailing slashes
+  opt->roots=argv+optind;
+  opt->Nroots=argc-optind;
+  for (index=0;index<opt->Nroots;index++)
+    {
+      length=strlen(opt->roots[index]);
+      while (length>1 && opt->roots[index][length-1]=='/')
+	opt->roots[index][--length]='\0';
+    }
+
+  if (opt->list==0 && opt->Nroots==0)
+    {
+      printErrorIndex("Expected a directory after options\n");
+      return 1;
+    }
+
+  if (opt->list!=0 && opt->Nroots>0)
+    {
+      printErrorIndex("-l and -L list the catalog and do not take directories\n");
+      return 1;
+    }
+
+  if (opt->list==0 && opt->pattern!=NULL)
+    {
+      printErrorIndex("-g can only be used with -l or -L\n");
+      return 1;
+    }
+
+  return 0;
+}
+
+/*!
+\brief Checks whether a filename has the extension of a FITS file
+
+\details
+The extensions are .fits, .fit, .fts, their gzipped versions .fits.gz
+and .fit.gz, and .fz (the tile-compressed files of fpack), in upper
+or lower case.
+
+\version 1.0
+
+@param *fname a string with the filename
+
+\return Returns one if the file is a FITS file and zero if it isn't
+
+*/
+int isFITSName(const char *fname)
+{
+  static const char *suffixes[]={".fits",".fit",".fts",".fits.gz",".fit.gz",".fz"}; // extensions of FITS files
+  size_t iSuffix;                           // dummy index for counting extensions
+  size_t length=strlen(fname);              // length of the filename
+  size_t suffixLength;                      // length of an extension
+
+  for (iSuffix=0;iSuffix<sizeof(suffixes)/sizeof(suffixes[0]);iSuffix++)
+    {
+      suffixLength=strlen(suffixes[iSuffix]);
+      if (length>suffixLength && strcasecmp(fname+length-suffixLength,suffixes[iSuffix])==0)
+	return 1;
+    }
+
+  return 0;
+}
+
+/*!
+\brief Adds a file to the files of the new catalog
+
+\details
+The name is copied, and the entry is copied if it is not NULL.
+
+\version 1.0
+
+@param *name a string with the filename
+@param *entry a pointer to the metadata of the file in the old catalog, or NULL
+@param *object a string with the value of OBJECT in the old catalog, or NULL
+
+\return Returns a pointer to the file, or NULL if there is not enough memory
+
+*/
+indexFile *addIndexFile(const char *name, fitsIndexEntry *entry, char *object)
+{
+  indexFile *files;                         // enlarged list of files
+  indexFile *file;                          // the new file
+
+  if (walk.Nfiles==walk.capacity)
+    {
+      walk.capacity=(walk.capacity>0 ? 2*walk.capacity : 1024);
+      files=(indexFile *)realloc(walk.files,sizeof(indexFile)*walk.capacity);
+      if (files==NULL)
+	{
+	  printErrorIndex("malloc failed!\n");
+	  return NULL;
+	}
+      walk.files=files;
+    }
+
+  file=walk.files+walk.Nfiles;
+  memset(file,0,sizeof(indexFile));
+  file->name=strdup(name);
+  if (file->name==NULL)
+    {
+      printErrorIndex("malloc failed!\n");
+      return NULL;
+    }
+  if (entry!=NULL)
+    file->entry=*entry;
+  file->object=object;
+  walk.Nfiles++;
+
+  return file;
+}
+
+/*!
+\brief Adds each FITS file found by nftw() to the files of the new catalog
+
+\details
+The size and the time of the last modification of the file are taken
+from the stat() of nftw(), so that the walk does not stat each file
+twice. Directories that cannot be read are reported and skipped.
+
+\version 1.0
+
+@param *fpath a string with the path of the file
+@param *st a pointer to the information on the file
+@param typeflag an int with the type of the file (FTW_F for a regular file)
+@param *ftwbuf a pointer to the position of the file in the tree (not used)
+
+\return Returns zero to continue the walk, or one if there is not enough memory
+
+*/
+int walkFile(const char *fpath, const struct stat *st, int typeflag, struct FTW *ftwbuf)
+{
+  indexFile *file;                          // the file
+  char errmsg[MAXPATH+40];                  // error message
+
+  if (typeflag==FTW_DNR)
+    {
+      if (walk.vmode!=0)
+	{
+	  snprintf(errmsg,sizeof errmsg,"could not read the directory %s\n",fpath);
+	  printErrorIndex(errmsg);
+	}
+      return 0;
+    }
+
+  if (typeflag!=FTW_F || !isFITSName(fpath))
+    return 0;
+
+  file=addIndexFile(fpath,NULL,NULL);
+  if (file==NULL)
+    return 1;
+  setFITSIndexStat(&file->entry,(struct stat *)st);
+  file->walked=1;
+
+  return 0;
+}
+
+/*!
+\brief Compares two files by name, for sorting them with qsort()
+
+\details
+The files found in the directories come before the same files in the
+old catalog.
+
+\version 1.0
+
+@param *a a pointer to the first file
+@param *b a pointer to the second file
+
+\return Returns a negative, zero, or positive int if the first file comes before, with, or after the second one
+
+*/
+int compareIndexFiles(const void *a, const void *b)
+{
+  const indexFile *fa=(const indexFile *)a;   // the first file
+  const indexFile *fb=(const indexFile *)b;   // the second file
+  int cmp=strcmp(fa->name,fb->name);          // comparison of the names
+
+  if (cmp!=0)
+    return cmp;
+
+  return fb->walked-fa->walked;
+}
+
+/*!
+\brief Checks whether a file of the old catalog is in one of the directory trees that are walked
+
+\version 1.0
+
+@param *opt a pointer to the options
+@param *name a string with the filename
+
+\return Returns one if it is in one of the trees and zero if it isn't
+
+*/
+int inIndexRoots(indexOptions *opt, char *name)
+{
+  int index;                                // dummy index for counting trees
+  size_t length;                            // length of the name of a tree
+
+  for (index=0;index<opt->Nroots;index++)
+    {
+      length=strlen(opt->roots[index]);
+      if (strncmp(name,opt->roots[index],length)==0 &&
+	  (name[length]=='\0' || name[length]=='/' || opt->roots[index][length-1]=='/'))
+	return 1;
+    }
+
+  return 0;
+}
+
+/*!
+\brief Lists the files in the catalog
+
+\details
+With -l it prints the filenames, one per line, and with -L it prints,
+separated by tabs, the filename, the sizes of the primary image (e.g.,
+512x512), BITPIX, CDELT1, CDELT2, the types of the HDUs (I: image,
+A: ASCII table, B: binary table, + for more than FITSINDEXHDUS HDUs),
+OBJECT (- if missing), FREQ, MJD, and the size of the file in bytes. A
+file that could not be read is listed with its CFITSIO error code.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param *opt a pointer to the options
+
+\return Returns zero if successful, 1 if not
+
+*/
+int listIndex(indexOptions *opt)
+{
+  fitsIndex index;                          // the catalog
+  fitsIndexEntry *entry;                    // a file in the catalog
+  char *name;                               // the filename
+  int iEntry;                               // dummy index for counting files
+  int axis;                                 // dummy index for counting axes
+  int hdu;                                  // dummy index for counting HDUs
+  char sizes[80];                           // the sizes of the image
+  char hdus[FITSINDEXHDUS+2];               // the types of the HDUs
+  int length;                               // length of a string
+
+  if (readFITSIndex(opt->indexFile,&index)!=0)
+    return 1;
+
+  for (iEntry=0;iEntry<index.Nentries;iEntry++)
+    {
+      entry=index.entries+iEntry;
+      name=index.strings+entry->name;
+      if (opt->pattern!=NULL && fnmatch(opt->pattern,name,0)!=0)
+	continue;
+
+      if (opt->list==1)
+	{
+	  printf("%s\n",name);
+	  continue;
+	}
+      if (entry->status!=0)
+	{
+	  printf("%s\terror %d\n",name,entry->status);
+	  continue;
+	}
+
+      length=0;
+      sizes[0]='\0';
+      for (axis=0;axis<entry->naxis && axis<FITSINDEXAXES;axis++)
+	length+=snprintf(sizes+length,sizeof(sizes)-length,(axis==0 ? "%d" : "x%d"),entry->naxes[axis]);
+      if (entry->naxis==0)
+	strcpy(sizes,"0");
+      for (hdu=0;hdu<entry->Nhdu && hdu<FITSINDEXHDUS;hdu++)
+	hdus[hdu]="IAB?"[(entry->hduTypes>>(2*hdu))&3];
+      if (entry->Nhdu>FITSINDEXHDUS)
+	hdus[hdu++]='+';
+      hdus[hdu]='\0';
+
+      printf("%s\t%s\t%d\t%g\t%g\t%s\t%s\t%g\t%.6f\t%lld\n",name,sizes,entry->bitpix,entry->xScale,entry->yScale,
+	     hdus,(entry->object!=0 ? index.strings+entry->object : "-"),entry->freq,entry->mjd,
+	     (long long)entry->size);
+    }
+
+  freeFITSIndex(&index);
+
+  return 0;
+}
+
+/*!
+\brief Main routine
+
+\details
+It walks the directory trees, takes the files that are up to date from
+the old catalog (if it exists), reads the headers of the rest in
+parallel, and writes the new catalog, sorted by filename.
+
+\version 1.0
+
+*/
+int main(int argc, char *argv[])
+{
+  indexOptions opt;                         // options set on the command line
+  fitsIndex old;                            // the old catalog
+  fitsIndex index;                          // the new catalog
+  fitsIndexEntry *entry;                    // a file in the old catalog
+  indexFile *file;                          // a file of the new catalog
+  char *objects;                            // values of OBJECT of the files that are read
+  int iFile,iRoot,iEntry;                   // dummy indices for counting files, trees, and entries
+  int Nfiles;                               // number of files without the duplicates
+  int Nread=0;                              // number of files that are read
+  int Nfailed=0;                            // number of files that could not be read
+  char errmsg[MAXPATH+40];                  // error message
+  int status=0;                             // flag for errors
+
+  if (parse(argc,argv,&opt)!=0)
+    return 1;
+
+  if (opt.list!=0)
+    return listIndex(&opt);
+
+  // the old catalog, if it exists
+  if (access(opt.indexFile,F_OK)!=0 || readFITSIndex(opt.indexFile,&old)!=0)
+    {
+      if (access(opt.indexFile,F_OK)==0 && !opt.rescan)
+	{
+	  printErrorIndex("use -r to create the catalog again\n");
+	  return 1;
+	}
+      if (initFITSIndex(&old)!=0)
+	return 1;
+    }
+
+  // the FITS files in the directory trees
+  walk.files=NULL;
+  walk.Nfiles=0;
+  walk.capacity=0;
+  walk.vmode=opt.vmode;
+  for (iRoot=0;iRoot<opt.Nroots;iRoot++)
+    if (nftw(opt.roots[iRoot],walkFile,NFTWFDS,FTW_PHYS)!=0)
+      {
+	snprintf(errmsg,sizeof errmsg,"could not walk the directory %s\n",opt.roots[iRoot]);
+	printErrorIndex(errmsg);
+	return 1;
+      }
+
+  // the files of the old catalog outside the trees are kept
+  for (iEntry=0;iEntry<old.Nentries;iEntry++)
+    {
+      entry=old.entries+iEntry;
+      if (!inIndexRoots(&opt,old.strings+entry->name) &&
+	  addIndexFile(old.strings+entry->name,entry,old.strings+entry->object)==NULL)
+	return 1;
+    }
+
+  // sort the files by name and remove the duplicates (e.g., of trees inside other trees)
+  qsort(walk.files,walk.Nfiles,sizeof(indexFile),compareIndexFiles);
+  Nfiles=0;
+  for (iFile=0;iFile<walk.Nfiles;iFile++)
+    if (Nfiles==0 || strcmp(walk.files[iFile].name,walk.files[Nfiles-1].name)!=0)
+      walk.files[Nfiles++]=walk.files[iFile];
+    else
+      free(walk.files[iFile].name);
+
+  // the files that are up to date in the old catalog are not read again
+  for (iFile=0;iFile<Nfiles;iFile++)
+    {
+      file=walk.files+iFile;
+      if (!file->walked)
+	continue;
+      entry=findFITSIndexEntry(&old,file->name);
+      if (!opt.rescan && entry!=NULL && entry->size==file->entry.size && entry->mtime==file->entry.mtime)
+	{
+	  file->entry=*entry;
+	  file->object=old.strings+entry->object;
+	}
+      else
+	{
+	  file->read=1;
+	  Nread++;
+	}
+    }
+
+  // the headers of the rest are read in parallel, if CFITSIO is reentrant
+  objects=(char *)malloc((size_t)FLEN_VALUE*(Nread>0 ? Nread : 1));
+  if (objects==NULL)
+    {
+      printErrorIndex("malloc failed!\n");
+      return 1;
+    }
+  for (iFile=0,iEntry=0;iFile<Nfiles;iFile++)
+    if (walk.files[iFile].read)
+      walk.files[iFile].object=objects+(size_t)FLEN_VALUE*(iEntry++);
+  if (opt.nthreads>1 && !fits_is_reentrant())
+    {
+      if (opt.vmode!=0)
+	printf("achieve-index: CFITSIO is not reentrant; reading the files on one thread\n");
+      opt.nthreads=1;
+    }
+#ifdef _OPENMP
+  omp_set_num_threads(opt.nthreads);
+#else
+  if (opt.nthreads>1)
+    printErrorIndex("built without OpenMP; reading the files on one thread\n");
+#endif
+#pragma omp parallel for schedule(dynamic)
+  for (iFile=0;iFile<Nfiles;iFile++)
+    if (walk.files[iFile].read)
+      readFITSIndexEntry(walk.files[iFile].name,&walk.files[iFile].entry,walk.files[iFile].object);
+
+  // build the new catalog, in the order of the filenames
+  if (initFITSIndex(&index)!=0)
+    return 1;
+  index.entries=(fitsIndexEntry *)malloc(sizeof(fitsIndexEntry)*(Nfiles>0 ? Nfiles : 1));
+  if (index.entries==NULL)
+    {
+      printErrorIndex("malloc failed!\n");
+      return 1;
+    }
+  for (iFile=0;iFile<Nfiles;iFile++)
+    {
+      file=walk.files+iFile;
+      entry=index.entries+iFile;
+      *entry=file->entry;
+      if (addFITSIndexString(&index,file->name,&entry->name)!=0)
+	return 1;
+      entry->object=0;
+      if (file->object[0]!='\0' && addFITSIndexString(&index,file->object,&entry->object)!=0)
+	return 1;
+
+      if (file->read && entry->status!=0)
+	{
+	  Nfailed++;
+	  if (opt.vmode==2)
+	    {
+	      snprintf(errmsg,sizeof errmsg,"could not read %s (CFITSIO error %d)\n",file->name,entry->status);
+	      printErrorIndex(errmsg);
+	    }
+	}
+    }
+  index.Nentries=Nfiles;
+
+  if (writeFITSIndex(opt.indexFile,&index)!=0)
+    status=1;
+  else if (opt.vmode!=0)
+    {
+      printf("achieve-index: %d files in %s, %d read, %d up to date\n",Nfiles,opt.indexFile,Nread,Nfiles-Nread);
+      if (Nfailed>0)
+	printf("achieve-index: %d files could not be read\n",Nfailed);
+    }
+
+  for (iFile=0;iFile<Nfiles;iFile++)
+    free(walk.files[iFile].name);
+  free(walk.files);
+  free(objects);
+  freeFITSIndex(&old);
+  freeFITSIndex(&index);
+
+  return status;
+}
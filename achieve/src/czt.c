@@ -0,0 +1,473 @@
+#include<stdio.h>
+#include<math.h>
+#include<stdlib.h>
+#include<string.h>
+#include<fftw3.h>
+
+#include "czt.h"
+/*! \file
+  \brief
+  Zoomed Fourier transform of images on an arbitrary rectangular window, with the chirp-z transform
+
+  \details
+  Calculates the Fourier transform of an Ny by Nx image
+  \f[
+  V_{l,k}=\sum_{r=0}^{N_y-1}\sum_{c=0}^{N_x-1} I_{r,c}
+      e^{-2\pi i\left[\xi_k (c-x_0)+\eta_l (r-y_0)\right]}
+  \f]
+  on a regular Nv by Nu window of points \f$\xi_k=\xi_0+k\,d\xi\f$ and
+  \f$\eta_l=\eta_0+l\,d\eta\f$ (in cycles per pixel), with arbitrary origin
+  and spacing. The transform is separable and is calculated first along the
+  rows and then along the columns of the image.
+
+  Along each direction, it uses the chirp-z transform of
+  <a href="http://adsabs.harvard.edu/abs/1969ITAE...17...86R">Rabiner, Schafer & Rader</a>,
+  1969, IEEE Trans. Audio Electroacoustics 17, 86 (Bluestein's algorithm):
+  writing \f$nk=[n^2+k^2-(k-n)^2]/2\f$, the sum over the N input points
+  becomes a convolution with the chirp \f$e^{i\pi d\xi m^2}\f$, which is
+  calculated with FFTs of length L>=N+M-1, where M is the number of output points.
+
+  The cost is that of Ny FFTs of length Lx and Nu FFTs of length Ly, instead of
+  that of the FFT of an image padded until its u-v grid has the same spacing.
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+
+#define RED "\x1B[31m"                   //!< color RED for error output
+#define RESETCOLOR "\x1B[0m"             //!< color to reset to normal
+
+/*!
+\brief Prints an error message
+
+\details
+
+\version 1.0
+
+@param errmsg[] a string with the error message to be printed
+
+\return nothing
+
+*/
+void printErrorCzt(char errmsg[])
+{
+  fprintf(stderr,RED "czt: %s" RESETCOLOR,errmsg);
+
+  return;
+}
+
+/*!
+  \brief
+  Finds a length of FFT that is efficient with FFTW
+
+  \details
+  Returns the smallest integer that is not smaller than Nmin and has no
+  prime factors other than 2, 3, 5, and 7.
+
+  @param Nmin an int with the minimum length
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+  \return Returns the length of the FFT
+
+*/
+int cztLength(int Nmin)
+{
+  int L;                         // candidate length
+  int rest;                      // what is left after removing the small factors
+
+  for (L=(Nmin>1 ? Nmin : 1);;L++)
+    {
+      rest=L;
+      while (rest%2==0) rest/=2;
+      while (rest%3==0) rest/=3;
+      while (rest%5==0) rest/=5;
+      while (rest%7==0) rest/=7;
+      if (rest==1)
+	return L;
+    }
+}
+
+/*!
+  \brief
+  Returns exp(-2 pi i phase) for a phase in cycles
+
+  \details
+  The integer part of the phase is removed before calling the trigonometric
+  functions, so that the chirps keep their accuracy for large n^2.
+
+  @param phase a double with the phase (in cycles)
+  @param z on return, the complex number exp(-2 pi i phase)
+
+  \version 1.0
+
+*/
+static void cztPhase(double phase, fftw_complex z)
+{
+  phase-=floor(phase);
+  z[0]=cos(2.*M_PI*phase);
+  z[1]=-sin(2.*M_PI*phase);
+
+  return;
+}
+
+/*!
+  \brief
+  Sets up the chirp-z transform of N points to M points along one direction
+
+  \details
+  The transform is \f$X_k=\sum_n x_n e^{-2\pi i (f_0+k\,df) n}\f$, for
+  k=0,...,M-1. It calculates the chirps that multiply the input and the
+  output, and the FFT of the convolution kernel.
+
+  @param *t a pointer to the transform to be set up
+  @param N an int with the number of input points
+  @param M an int with the number of output points
+  @param f0 a double with the first output frequency (in cycles per point)
+  @param df a double with the spacing of the output frequencies (in cycles per point)
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+  \return Returns zero if successful, 1 if not
+
+*/
+static int czt1dInit(czt1d *t, int N, int M, double f0, double df)
+{
+  int n;                         // dummy index for counting points
+  fftw_plan p;                   // plan for the FFT of the kernel
+
+  t->N=N;
+  t->M=M;
+  t->L=cztLength(N+M-1);
+
+  t->pre=(fftw_complex *)fftw_malloc(sizeof(fftw_complex)*N);
+  t->post=(fftw_complex *)fftw_malloc(sizeof(fftw_complex)*M);
+  t->kernel=(fftw_complex *)fftw_malloc(sizeof(fftw_complex)*t->L);
+  if (t->pre==NULL || t->post==NULL || t->kernel==NULL)
+    {
+      printErrorCzt("malloc failed!\n");
+      return 1;
+    }
+
+  // the input is multiplied by exp(-2 pi i f0 n) exp(-i pi df n^2)
+  for (n=0;n<N;n++)
+    cztPhase(f0*n-floor(f0*n)+0.5*df*n*(double)n,t->pre[n]);
+
+  // and the output by exp(-i pi df k^2)
+  for (n=0;n<M;n++)
+    cztPhase(0.5*df*n*(double)n,t->post[n]);
+
+  // the kernel exp(i pi df m^2), for m=-(N-1),...,M-1, with the negative m wrapped around
+  memset(t->kernel,0,sizeof(fftw_complex)*t->L);
+  for (n=0;n<M;n++)
+    cztPhase(-0.5*df*n*(double)n,t->kernel[n]);
+  for (n=1;n<N;n++)
+    cztPhase(-0.5*df*n*(double)n,t->kernel[t->L-n]);
+
+  // its FFT, divided by L to normalize the backward FFT of the convolution
+  p=fftw_plan_dft_1d(t->L,t->kernel,t->kernel,FFTW_FORWARD,FFTW_ESTIMATE);
+  if (p==NULL)
+    {
+      printErrorCzt("FFTW planning failed!\n");
+      return 1;
+    }
+  fftw_execute(p);
+  fftw_destroy_plan(p);
+  for (n=0;n<t->L;n++)
+    {
+      t->kernel[n][0]/=t->L;
+      t->kernel[n][1]/=t->L;
+    }
+
+  return 0;
+}
+
+/*!
+  \brief
+  Makes a plan for the zoomed Fourier transform of Ny by Nx images
+
+  \details
+  Sets up the chirp-z transforms along the two directions, allocates the
+  buffers, and makes the FFTW plans for the FFTs of all the rows and of all
+  the output columns at once. The same plan can be used for any number of
+  images of the same size.
+
+  @param Ny an int with the number of rows of the image
+  @param Nx an int with the number of columns of the image
+  @param Nv an int with the number of rows of the output window
+  @param Nu an int with the number of columns of the output window
+  @param eta0 a double with the first point of the window along y (in cycles per pixel)
+  @param deta a double with the spacing of the window along y (in cycles per pixel)
+  @param xi0 a double with the first point of the window along x (in cycles per pixel)
+  @param dxi a double with the spacing of the window along x (in cycles per pixel)
+  @param planFlags an unsigned int with the FFTW planning flags
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning Planning with FFTW_MEASURE or FFTW_PATIENT overwrites the buffers, which are filled by zoomExecute()
+
+  \todo nothing left
+
+  \return Returns a pointer to the plan, or NULL if it could not be made
+
+*/
+zoomPlan *zoomPlanCreate(int Ny, int Nx, int Nv, int Nu, double eta0, double deta,
+			 double xi0, double dxi, unsigned planFlags)
+{
+  zoomPlan *plan;                                   // the new plan
+  int Lx,Ly;                                        // lengths of the FFTs along the two directions
+
+  plan=(zoomPlan *)malloc(sizeof(zoomPlan));
+  if (plan==NULL)
+    {
+      printErrorCzt("malloc failed!\n");
+      return NULL;
+    }
+
+  plan->Nx=Nx;
+  plan->Ny=Ny;
+  plan->Nu=Nu;
+  plan->Nv=Nv;
+  plan->xi0=xi0;
+  plan->dxi=dxi;
+  plan->eta0=eta0;
+  plan->deta=deta;
+
+  // nothing is allocated yet, so that a partial plan can be destroyed
+  plan->x.pre=plan->x.post=plan->x.kernel=NULL;
+  plan->y.pre=plan->y.post=plan->y.kernel=NULL;
+  plan->bufx=plan->bufy=NULL;
+  plan->pxf=plan->pxb=plan->pyf=plan->pyb=NULL;
+
+  if (czt1dInit(&plan->x,Nx,Nu,xi0,dxi)!=0 || czt1dInit(&plan->y,Ny,Nv,eta0,deta)!=0)
+    {
+      zoomPlanDestroy(plan);
+      return NULL;
+    }
+  Lx=plan->x.L;
+  Ly=plan->y.L;
+
+  plan->bufx=(fftw_complex *)fftw_malloc(sizeof(fftw_complex)*Ny*Lx);
+  plan->bufy=(fftw_complex *)fftw_malloc(sizeof(fftw_complex)*Nu*Ly);
+  if (plan->bufx==NULL || plan->bufy==NULL)
+    {
+      printErrorCzt("malloc failed!\n");
+      zoomPlanDestroy(plan);
+      return NULL;
+    }
+
+  // all the rows of the image, and then all the columns of the window, at once
+  plan->pxf=fftw_plan_many_dft(1,&Lx,Ny,plan->bufx,NULL,1,Lx,plan->bufx,NULL,1,Lx,FFTW_FORWARD,planFlags);
+  plan->pxb=fftw_plan_many_dft(1,&Lx,Ny,plan->bufx,NULL,1,Lx,plan->bufx,NULL,1,Lx,FFTW_BACKWARD,planFlags);
+  plan->pyf=fftw_plan_many_dft(1,&Ly,Nu,plan->bufy,NULL,1,Ly,plan->bufy,NULL,1,Ly,FFTW_FORWARD,planFlags);
+  plan->pyb=fftw_plan_many_dft(1,&Ly,Nu,plan->bufy,NULL,1,Ly,plan->bufy,NULL,1,Ly,FFTW_BACKWARD,planFlags);
+  if (plan->pxf==NULL || plan->pxb==NULL || plan->pyf==NULL || plan->pyb==NULL)
+    {
+      printErrorCzt("FFTW planning failed!\n");
+      zoomPlanDestroy(plan);
+      return NULL;
+    }
+
+  return plan;
+}
+
+/*!
+  \brief
+  Calculates the zoomed Fourier transform of an image
+
+  \details
+  Calculates the Fourier transform of the Ny by Nx image with respect to
+  the point (x0,y0) of the image (in pixels, starting from 0), on the Nv by
+  Nu window of the plan. The output V has Nv rows of Nu points, with the
+  first point of the window first.
+
+  The loops over the rows and over the columns are shared among the
+  OpenMP threads.
+
+  It returns zero if everything was OK, 1 if it wasn't.
+
+  @param *plan a pointer to the plan made by zoomPlanCreate()
+  @param *Image a pointer to the Ny by Nx image
+  @param x0 a double with the x-coordinate of the phase center (in pixels, starting from 0)
+  @param y0 a double with the y-coordinate of the phase center (in pixels, starting from 0)
+  @param *V on return, a pointer to the Nv by Nu transform
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int zoomExecute(zoomPlan *plan, double *Image, double x0, double y0, fftw_complex *V)
+{
+  int Nx=plan->Nx, Ny=plan->Ny;                     // size of the image
+  int Nu=plan->Nu, Nv=plan->Nv;                     // size of the window
+  int Lx=plan->x.L, Ly=plan->y.L;                   // lengths of the FFTs
+  int indexR,indexC;                                // dummy indices for counting rows and columns
+  long index,indexTo;                               // indices of elements of the arrays
+  double re,im;                                     // components of complex products
+  fftw_complex *shiftX,*shiftY;                     // phase shifts to the point (x0,y0)
+  fftw_complex *c;                                  // pointer to an element of a buffer
+
+  shiftX=(fftw_complex *)malloc(sizeof(fftw_complex)*Nu);
+  shiftY=(fftw_complex *)malloc(sizeof(fftw_complex)*Nv);
+  if (shiftX==NULL || shiftY==NULL)
+    {
+      printErrorCzt("malloc failed!\n");
+      return 1;
+    }
+
+  // the phase shifts exp(2 pi i xi x0) and exp(2 pi i eta y0)
+  for (indexC=0;indexC<Nu;indexC++)
+    cztPhase(-(plan->xi0+indexC*plan->dxi)*x0,shiftX[indexC]);
+  for (indexR=0;indexR<Nv;indexR++)
+    cztPhase(-(plan->eta0+indexR*plan->deta)*y0,shiftY[indexR]);
+
+  // multiply each row with the input chirp and zero-pad it
+#pragma omp parallel for private(indexC,index) schedule(static)
+  for (indexR=0;indexR<Ny;indexR++)
+    {
+      for (indexC=0;indexC<Nx;indexC++)
+	{
+	  index=(long)indexR*Lx+indexC;
+	  plan->bufx[index][0]=Image[(long)indexR*Nx+indexC]*plan->x.pre[indexC][0];
+	  plan->bufx[index][1]=Image[(long)indexR*Nx+indexC]*plan->x.pre[indexC][1];
+	}
+      memset(plan->bufx+(long)indexR*Lx+Nx,0,sizeof(fftw_complex)*(Lx-Nx));
+    }
+
+  // convolve the rows with the kernel
+  fftw_execute(plan->pxf);
+#pragma omp parallel for private(indexC,c,re,im) schedule(static)
+  for (indexR=0;indexR<Ny;indexR++)
+    for (indexC=0;indexC<Lx;indexC++)
+      {
+	c=plan->bufx+(long)indexR*Lx+indexC;
+	re=(*c)[0]*plan->x.kernel[indexC][0]-(*c)[1]*plan->x.kernel[indexC][1];
+	im=(*c)[0]*plan->x.kernel[indexC][1]+(*c)[1]*plan->x.kernel[indexC][0];
+	(*c)[0]=re;
+	(*c)[1]=im;
+      }
+  fftw_execute(plan->pxb);
+
+  // multiply with the output chirp along x and the input chirp along y,
+  // and transpose, so that each column of the window is contiguous
+#pragma omp parallel for private(indexR,index,indexTo,re,im) schedule(static)
+  for (indexC=0;indexC<Nu;indexC++)
+    {
+      for (indexR=0;indexR<Ny;indexR++)
+	{
+	  index=(long)indexR*Lx+indexC;
+	  indexTo=(long)indexC*Ly+indexR;
+	  re=plan->bufx[index][0]*plan->x.post[indexC][0]-plan->bufx[index][1]*plan->x.post[indexC][1];
+	  im=plan->bufx[index][0]*plan->x.post[indexC][1]+plan->bufx[index][1]*plan->x.post[indexC][0];
+	  plan->bufy[indexTo][0]=re*plan->y.pre[indexR][0]-im*plan->y.pre[indexR][1];
+	  plan->bufy[indexTo][1]=re*plan->y.pre[indexR][1]+im*plan->y.pre[indexR][0];
+	}
+      memset(plan->bufy+(long)indexC*Ly+Ny,0,sizeof(fftw_complex)*(Ly-Ny));
+    }
+
+  // convolve the columns with the kernel
+  fftw_execute(plan->pyf);
+#pragma omp parallel for private(indexR,c,re,im) schedule(static)
+  for (indexC=0;indexC<Nu;indexC++)
+    for (indexR=0;indexR<Ly;indexR++)
+      {
+	c=plan->bufy+(long)indexC*Ly+indexR;
+	re=(*c)[0]*plan->y.kernel[indexR][0]-(*c)[1]*plan->y.kernel[indexR][1];
+	im=(*c)[0]*plan->y.kernel[indexR][1]+(*c)[1]*plan->y.kernel[indexR][0];
+	(*c)[0]=re;
+	(*c)[1]=im;
+      }
+  fftw_execute(plan->pyb);
+
+  // multiply with the output chirp along y and the phase shifts, and transpose back
+#pragma omp parallel for private(indexC,index,indexTo,re,im) schedule(static)
+  for (indexR=0;indexR<Nv;indexR++)
+    for (indexC=0;indexC<Nu;indexC++)
+      {
+	index=(long)indexC*Ly+indexR;
+	indexTo=(long)indexR*Nu+indexC;
+	re=plan->bufy[index][0]*plan->y.post[indexR][0]-plan->bufy[index][1]*plan->y.post[indexR][1];
+	im=plan->bufy[index][0]*plan->y.post[indexR][1]+plan->bufy[index][1]*plan->y.post[indexR][0];
+	V[indexTo][0]=re*shiftY[indexR][0]-im*shiftY[indexR][1];
+	V[indexTo][1]=re*shiftY[indexR][1]+im*shiftY[indexR][0];
+	re=V[indexTo][0];
+	im=V[indexTo][1];
+	V[indexTo][0]=re*shiftX[indexC][0]-im*shiftX[indexC][1];
+	V[indexTo][1]=re*shiftX[indexC][1]+im*shiftX[indexC][0];
+      }
+
+  free(shiftX);
+  free(shiftY);
+
+  return 0;
+}
+
+/*!
+  \brief
+  Destroys a plan for the zoomed Fourier transform and frees its memory
+
+  \details
+  The plan may be one that zoomPlanCreate() could not complete, with 
+  some of its arrays or its FFTW plans missing (NULL).
+
+  @param *plan a pointer to the plan made by zoomPlanCreate()
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+void zoomPlanDestroy(zoomPlan *plan)
+{
+  if (plan==NULL)
+    return;
+
+  if (plan->pxf!=NULL)
+    fftw_destroy_plan(plan->pxf);
+  if (plan->pxb!=NULL)
+    fftw_destroy_plan(plan->pxb);
+  if (plan->pyf!=NULL)
+    fftw_destroy_plan(plan->pyf);
+  if (plan->pyb!=NULL)
+    fftw_destroy_plan(plan->pyb);
+  fftw_free(plan->bufx);
+  fftw_free(plan->bufy);
+  fftw_free(plan->x.pre);
+  fftw_free(plan->x.post);
+  fftw_free(plan->x.kernel);
+  fftw_free(plan->y.pre);
+  fftw_free(plan->y.post);
+  fftw_free(plan->y.kernel);
+  free(plan);
+
+  return;
+}
@@ -0,0 +1,48 @@
+/*! \file
+  \brief
+  Declarations for the chirp-z (zoom) Fourier transform of images in czt.c
+
+  \version 1.0
+
+*/
+#ifndef CZT_H
+#define CZT_H
+
+#include<fftw3.h>
+
+/*!
+  \brief Chirp-z transform along one direction of an image
+*/
+typedef struct
+{
+  int N;                        //!< number of points of the input
+  int M;                        //!< number of points of the output
+  int L;                        //!< length of the FFTs of the convolution (>=N+M-1)
+  fftw_complex *pre;            //!< chirp that multiplies the input (N points)
+  fftw_complex *post;           //!< chirp that multiplies the output (M points)
+  fftw_complex *kernel;         //!< FFT of the convolution kernel, divided by L (L points)
+} czt1d;
+
+/*!
+  \brief Plan for the zoomed 2D Fourier transform of Ny by Nx images
+*/
+typedef struct
+{
+  int Nx,Ny;                    //!< size of the image
+  int Nu,Nv;                    //!< size of the output window
+  double xi0,dxi;               //!< first point and spacing of the window along x (cycles per pixel)
+  double eta0,deta;             //!< first point and spacing of the window along y (cycles per pixel)
+  czt1d x,y;                    //!< chirp-z transforms along the two directions
+  fftw_complex *bufx;           //!< buffer for the transforms of the rows (Ny by Lx)
+  fftw_complex *bufy;           //!< buffer for the transforms of the columns (Nu by Ly)
+  fftw_plan pxf,pxb;            //!< forward and backward FFTW plans for the rows
+  fftw_plan pyf,pyb;            //!< forward and backward FFTW plans for the columns
+} zoomPlan;
+
+int cztLength(int Nmin);
+zoomPlan *zoomPlanCreate(int Ny, int Nx, int Nv, int Nu, double eta0, double deta,
+			 double xi0, double dxi, unsigned planFlags);
+int zoomExecute(zoomPlan *plan, double *Image, double x0, double y0, fftw_complex *V);
+void zoomPlanDestroy(zoomPlan *plan);
+
+#endif
@@ -3,9 +3,22 @@
 #include<stdlib.h>
 #include<unistd.h>
 #include<string.h>
+#include<inttypes.h>
+#include<limits.h>
 #include<fftw3.h>
+#ifdef USE_MPI
+#include<mpi.h>
+#include<fftw3-mpi.h>
+#endif
+#include<sys/stat.h>
+#include<errno.h>
+#ifdef _OPENMP
+#include<omp.h>
+#endif
 
-#include "fitsio.h"
+#include "io.h"
+#include "nufft.h"
+#include "czt.h"
 /*! \file
   \brief 
   Converts an image to u-v maps (complex amplitude and phase)
@@ -30,18 +43,65 @@
   a predefined fraction (MINAMP) of the zero baseline amplitude, the phase
   is set to zero.
 
-  Use: image2uv [-sv] [-p Npoints] [-c] [-o filename2] filename1
+  Use: image2uv [-sv] [-p Npoints] [-c] [-t r2c|c2c] [-f 32|64] [-e 32|64] [-C algorithm[,q[,qPhase]]] [-O re,im|amp,phase|amp|power] [-S] [-M] [-r Nrows] [-m low|disk|normal] [-B budget] [-H] [-w umax] [-b baselines] [-z umin,umax,vmin,vmax,Nu,Nv] [-P estimate|measure|patient] [-W directory] [-j Nthreads] [-n Nbatch] [-l manifest] [-I catalog] [-d directory] [-q Nwrites] [-F] [-o filename2] filename1 [filename ...]
 
   The required options are:
-  - "filename1": sets the input image filename (FITS)
+  - "filename1": sets the input image filename (FITS). More than one input
+    filename may be given, in which case image2uv runs in batch mode (see below).
+    With "-", a single 2D image is read from the standard input (not with -S or -M).
   
   The optional options are:
-  - "-o filename2": sets the output visibility filename (UVFITS).
+  - "-o filename2": sets the output visibility filename (UVFITS). With "-o -", the output file is written to the standard output, and nothing else is printed there (as with -s), so that it can be piped into another tool. Any CFITSIO filename, e.g., "mem://", may be given.
+  - "-F": overwrites existing output files, by prefixing their names with the '!' of CFITSIO (see overwriteFITSName() in io.c); without it, image2uv does not write over an existing file.
   - "-s": silent mode. It does not print anything and uses defaults 
   - "-v": verbose mode. It prints a lot more information 
   - "-p Npoints": pads the image to a square grid with Npoints on each side, if 
 the current image size is smaller than Npoints, before taking the Fourier Transform
   - "-c": calculates the complex phases by first centering the image to its center of brightness. If this options is not given, it calculates the complex phase with respect to the geometric center of the image.
+  - "-t r2c|c2c": sets the type of Fourier transform. With "r2c" (the default) it uses the FFTW routines for real data, which compute only the non-redundant half of the transform and need about half the memory and time; the other half is reconstructed from the Hermitian symmetry of the transform. With "c2c" it uses the complex-to-complex routines with a zero imaginary part.
+  - "-f 32|64": sets the precision of the calculation. With "64" (the default) the image, the FFT and the visibilities are in double precision. With "32" the image is read into a float array, the FFT is calculated with the single-precision FFTW routines (fftwf), and the visibility amplitudes and phases are converted and written as float (FLOAT_IMG) images; this halves the memory and the size of the output files, and doubles the number of points per SIMD instruction of the FFT. The total flux and the brightness center are still added up in double precision, with compensated sums. The -b and -z modes do not need a padded image, so they are always calculated in double precision; with "-f 32" the window of -z is still written as float images.
+  - "-e 32|64": sets the precision of the output images, FLOAT_IMG with "32" or DOUBLE_IMG with "64", independently of the precision of the calculation (by default, that set by -f). With "-e 32" a calculation in double precision writes float images, which halves the size of the output files.
+  - "-C algorithm[,q[,qPhase]]": writes the output images tile-compressed (see createFITSImageHDU() in io.c), with the algorithm "rice", "gzip", or "hcompress" of CFITSIO ("none" turns it off). The tiles are whole rows of the u-v grid (16 rows for hcompress), so that the visibilities can still be read one row at a time. The floating-point visibilities are quantized to 1/q of the noise of each tile, and the phases (and the EVPA of -S) to 1/qPhase; q=0 means lossless compression, which is possible only with gzip and is its default, while the default q of rice and hcompress is 16, and qPhase is q by default. E.g., "-C rice,16,4" keeps the amplitudes well above the quantization and coarsens the phases. Compressed images follow an empty primary HDU, and CFITSIO reads them back as usual. It cannot be used with -M, -b, -m low, or -m disk.
+  - "-O re,im|amp,phase|amp|power": sets the quantities that are calculated and written. With "amp,phase" (the default) the output file has the two HDU images of the visibility amplitudes and phases described above. With "re,im" it has a single Nx by Ny by 2 image with the real (first plane) and imaginary (second plane) parts of the visibilities, with respect to the same phase center, and the keyword CTYPE3='COMPLEX'; these can be interpolated directly. With "amp" or "power" it has a single image with the visibility amplitudes or their squares, and the phases are not calculated at all. With -b, the columns RE and IM are always written and the columns AMP and PHASE, AMP, or POWER follow this option.
+  - "-S": reads each input as a full-Stokes cube (NAXIS=3 or 4, with the Stokes parameters along the axis with CTYPEn='STOKES', or along the third axis) and transforms its I, Q, U, and V images together, as consecutive images of one batched FFT. The phases of all the Stokes parameters are calculated with respect to the same center, that of Stokes I. The output file has one HDU (or two, for amp,phase) per Stokes parameter, as set by the -O option and named by the keyword EXTNAME (e.g., I_AMP, I_PHASE, Q_AMP, ...), followed, if Q and U are present, by the HDUs MBREVE (the complex fractional polarization (Q+iU)/I, for re,im), MBREVE_AMP (its amplitude), or MBREVE_POWER (its squared amplitude, for power), and EVPA (half of its phase, in rad). It cannot be used with -b or -z.
+  - "-M": movie mode. The input files are the frames of a movie, in time order: each 3D or 4D cube gives one frame per plane along its time axis (the axis with CTYPEn='TIME', or the third axis) and each 2D image gives one frame. All the frames need to have the same size. They are read, transformed, and written one at a time, in a pipeline that reads frame k+1 and converts and writes frame k-1 while frame k is transformed, so that only a few frames are in memory at any time. The output file (set by -o) has the visibilities of all the frames along the last (TIME) axis of its cubes: the HDUs AMP and PHASE, VIS (with a COMPLEX third axis), AMP, or POWER, as set by the -O option. It cannot be used with -S, -b, or -z.
+  - "-r Nrows": reads each image in blocks of Nrows rows and transforms the rows of each block while the next block is being read, on a separate thread; the columns are transformed once all the rows are in. This hides most of the time spent reading a large image, e.g., from a network filesystem, behind the transforms of the rows. By default, the reading is pipelined in blocks of ROWBLOCKDEFAULT rows for images with at least PIPELINEMINPIXELS pixels (e.g., 4096x4096), and "-r 0" turns it off. It applies only when the images are transformed one at a time (e.g., with -n 1), and not with -S or -M.
+  - "-m low|disk|normal": sets the memory mode. With "normal" (the default) the image, the input and the output of the FFT, and the visibility amplitudes and phases are separate arrays, i.e., about five arrays of the size of the padded image (10 GB for a 16384x16384 grid in double precision). With "low" the image is read straight into the FFT buffer, transformed in place, and converted to visibilities in blocks of rows that are written to the output file as soon as they are converted, so that the memory needed is about one complex grid of NyPad by (NxPad/2+1) points (NxPad for c2c). The output file has the same visibilities and layout. The images are then transformed one at a time, and the reading is not pipelined (the -n and -r options are ignored). With "disk" the grid does not need to fit in memory at all: the image is read and its rows are transformed in blocks of rows, each block is written to a scratch file in tiles of columns (a blocked transpose on disk), and each tile is then read back, its columns are transformed, and its visibilities are centered, converted, and written to the output file, in one pass. The scratch file, of the size of the complex grid, is created in the directory in the environment variable TMPDIR (or /tmp) and is removed when image2uv exits. Neither "low" nor "disk" can be used with -S, -M, -b, or -z.
+  - "-B budget": sets the memory (in MB) of the blocks of rows and the tiles of columns of the out-of-core mode (default: DISKBUDGETDEFAULT). The larger the budget, the fewer and larger the reads and writes of the scratch file.
+  - "-H": writes only the Hermitian half plane of the visibilities (u>=0), with Npoints/2+1 columns and the rows centered as usual. The keywords HERMHALF and FULLNX in the output file flag this layout and give the number of columns of the full grid.
+  - "-w umax": calculates and writes only the central window of the u-v grid with |u|<=umax and |v|<=umax (in wavelengths), i.e., the 2 Ku+1 columns and 2 Kv+1 rows around the zero baseline, where Ku and Kv are umax divided by the size of the u-v pixels along each direction. The zero baseline is still at the center of the output (at grid point Nx/2+1 and Ny/2+1 of the window), and with -H only the Ku+1 columns with u>=0 are written. Only the columns of the transform in the window are calculated.
+  - "-b baselines": calculates the visibilities only at the baselines listed in the text file "baselines", one "u v" pair (in wavelengths) per line, instead of on a regular u-v grid. Empty lines and lines starting with '#' are ignored. The visibilities are calculated with a non-uniform FFT (see nufft.c), which needs no padding of the image (the -p option is ignored, and -H and -t cannot be used with it) and is as accurate as a direct Fourier transform to about 1e-12. The output file has a binary table with one row per baseline and the columns U, V, RE, IM, AMP, and PHASE (or as set by the -O option).
+  - "-z umin,umax,vmin,vmax,Nu,Nv": calculates the visibilities on a zoomed window of the u-v plane, with Nu points from umin to umax and Nv points from vmin to vmax (in wavelengths), instead of on the regular u-v grid of the FFT. The window can have any spacing and does not need to include the zero baseline. It uses a chirp-z transform along each direction (see czt.c), at a cost close to that of FFTs of the size of the image plus the window, rather than that of the FFT of an image padded until its u-v grid has the same spacing (the -p and -H options are ignored). The output file has the same format as for a regular grid, with the spacing in CDELT1 and CDELT2 and the u and v of the first pixel in CRVAL1 and CRVAL2.
+  - "-P estimate|measure|patient": sets the rigor with which FFTW plans the transform. With "estimate" (the default) the plan is chosen with a heuristic; with "measure" or "patient" FFTW times a number of candidate plans, which can take much longer than the transform itself, but the result is stored as FFTW "wisdom" and reused by every later run with the same padded size, type and precision of transform and number of threads.
+  - "-W directory": sets the directory of the FFTW wisdom store. The default is the directory in the environment variable IMAGE2UV_WISDOM or, if this is not set, $HOME/.image2uv. The wisdom for each padded size, type of transform and number of threads is kept in a separate file, which is imported before planning and exported when the run is completed.
+  - "-j Nthreads": uses Nthreads threads for the Fourier transform (with the FFTW threads library) and for filling the input of the transform and converting its output to amplitudes and phases (with OpenMP). The sums for the total flux and the brightness center are accumulated row by row and the row sums are then added up in order, so that the results do not depend on the number of threads. The default is one thread.
+  - "-l manifest": reads the list of input image filenames from the file "manifest", one per line, in addition to any filenames given on the command line. Empty lines and lines starting with '#' are ignored. If manifest is "-", the list is read from the standard input.
+  - "-I catalog": takes the sizes of the input images from the catalog of their metadata made by achieve-index, instead of opening each file twice, once to read its sizes and once to read its image. The input filenames need to be given as in the catalog (e.g., as listed by achieve-index -l), and the files that are not in the catalog, or that changed since it was made, are read as usual.
+  - "-d directory": sets the directory of the output files in batch mode (default: the current directory)
+  - "-n Nbatch": sets the maximum number of images of the same padded size that are transformed together in batch mode. The default is as many as fit in BATCHMEMDEFAULT bytes of FFT buffers.
+  - "-q Nwrites": sets the maximum number of outputs that are queued for writing in the background, on a separate thread, while the next images are transformed (default: WRITEQUEUEDEFAULT, or as many as fit in BATCHMEMDEFAULT bytes, but at least one). With "-q 0" each output is written before the next image is transformed. The outputs are written in the background only if CFITSIO is reentrant (built with --enable-reentrant), and only for the regular u-v grids of the default memory mode.
+
+  In batch mode, i.e., when more than one input image is given, the output
+  for each input file "name.fits" is written to "directory/name_uv.fits". The
+  images are grouped by their padded size; the images in each group share one 
+  FFTW plan and one set of buffers, and are transformed Nbatch at a time with 
+  a single call to FFTW. If an image cannot be read or written, image2uv 
+  reports it and continues with the rest of the images. While the images 
+  are read, a separate thread prefetches the next PREFETCHDEPTH input 
+  files into the page cache (see startFITSPrefetch() in io.c), and the 
+  outputs are written on another thread (see -q), so that, for a large 
+  library of small images, the transforms do not wait on the filesystem.
+
+  When image2uv is built with MPI (make image2uv_mpi, which needs the MPI
+  library of FFTW) and started on more than one process, e.g., with
+  "mpirun -np 16 image2uv_mpi -p 65536 -o uv.fits image.fits", the FFT grid
+  of each image is distributed over the processes in slabs of rows, so that
+  it only needs to fit in the memory of all the nodes together. Each process
+  reads only the rows of the image in its slab and writes the visibilities
+  that come from its slab into the output file, which is the same as that
+  of a run on one process. The -j option sets the number of threads of each
+  process. The -S, -M, -b, -z, and -m low options cannot be used with more
+  than one process.
 
   If no options are given, it prints a help message
 
@@ -51,6 +111,21 @@ the current image size is smaller than Npoints, before taking the Fourier Transf
 
   Reads the file form inimage.fits and outputs the visibility amplitudes and phases
   into uvresults.out
+
+  - ls frames/img*.fits | image2uv -p 512 -d uvframes -l -
+
+  Reads all the images in the directory frames, pads them to 512x512 points, and 
+  writes their visibility amplitudes and phases into the directory uvframes
+
+  - achieve-index -l -g 'lib/MAD/image_*.fits' -I lib.idx | image2uv -I lib.idx -p 512 -d uvframes -l -
+
+  The same, for the images of a library that are listed in its catalog (see
+  achieve-index), whose sizes are taken from the catalog
+
+  - synthimage -p 256 - | image2uv -p 1024 -o - - | imstat -
+
+  Creates a synthetic image, transforms it, and prints the statistics of the 
+  visibility amplitudes, without writing any file to disk
   
   \author Dimitrios Psaltis
   
@@ -62,8 +137,7 @@ the current image size is smaller than Npoints, before taking the Fourier Transf
   
   \warning No known warnings
   
-  \todo Change call to FFTW to use only routines for Real data. 
-  Add error capture if-statements for all the read and the write commands
+  \todo Add error capture if-statements for all the read and the write commands
 
 */
 // Definitions
@@ -74,6 +148,165 @@ the current image size is smaller than Npoints, before taking the Fourier Transf
 #define RED "\x1B[31m"                   //!< color RED for error output
 #define RESETCOLOR "\x1B[0m"             //!< color to reset to normal
 #define MINAMP 1.e-12                    //!< minimum fraction of zero baseline amplitude, below which the phase is set to zero
+#define TMODEDEFAULT 0                   //!< default transform type (0: r2c, 1: c2c)
+#define MAXPATH 1024                     //!< maximum number of characters for paths
+#define WISDOMENV "IMAGE2UV_WISDOM"      //!< environment variable with the directory of the wisdom store
+#define WISDOMDIRDEFAULT ".image2uv"     //!< default directory of the wisdom store, relative to $HOME
+#define BATCHSUFFIX "_uv.fits"           //!< suffix of the output filenames in batch mode
+#define BATCHMEMDEFAULT 268435456        //!< default maximum size (in bytes) of the FFT buffers of a batch
+#define NTHREADSDEFAULT 1                //!< default number of threads
+#define MAXSTOKES 4                      //!< maximum number of Stokes parameters (I, Q, U, V)
+#define ROWBLOCKDEFAULT 256              //!< default number of rows per block of the pipelined reading and transforms
+#define PIPELINEMINPIXELS 16777216       //!< minimum number of pixels of an image for which the reading is pipelined by default
+#define LOWMEMBLOCKPIXELS 1048576        //!< number of pixels per block of rows of the output in low-memory mode
+#define DISKBUDGETDEFAULT 1024           //!< default memory budget (in MB) of the out-of-core mode
+#define SCRATCHENV "TMPDIR"              //!< environment variable with the directory of the scratch files
+#define SCRATCHDIRDEFAULT "/tmp"         //!< default directory of the scratch files
+#define MAXOPENINPUTS 64                 //!< maximum number of input files kept open from reading their sizes to reading their images
+#define WRITEQUEUEDEFAULT 4              //!< default maximum number of outputs queued for writing in the background
+#define PREFETCHDEPTH 16                 //!< number of input files that are prefetched ahead of the one that is read
+#define SLOTALIGN 64                     //!< alignment (in bytes) of the arrays in the slots of the background writer
+
+/*!
+  \brief Options of image2uv, as set on the command line
+*/
+typedef struct
+{
+  char **inFileNames;           //!< input image filenames
+  int Nin;                      //!< number of input image filenames
+  char outFileName[MAXPATH];    //!< output filename, for a single input image
+  char outDir[MAXPATH];         //!< directory of the output files in batch mode
+  int vmode;                    //!< flag for verbose mode (0:silent, 1: normal, 2: verbose)
+  int cmode;                    //!< flag for image centering
+  int Npad;                     //!< number of points per dimension for image padding
+  int tmode;                    //!< flag for the type of transform (0: r2c, 1: c2c)
+  int hmode;                    //!< flag for Hermitian half plane output
+  unsigned planFlags;           //!< flags for the rigor of FFTW planning
+  char wisdomDir[MAXPATH];      //!< directory of the FFTW wisdom store
+  int Nbatch;                   //!< maximum number of images per FFT batch (0: set by BATCHMEMDEFAULT)
+  int nthreads;                 //!< number of threads
+  double wmax;                  //!< half-width of the central u-v window that is calculated and written (0: whole grid)
+  char baselineFile[MAXPATH];   //!< file with the list of baselines (empty for a regular u-v grid)
+  int zmode;                    //!< flag for a zoomed u-v window
+  double zoomWindow[4];         //!< limits umin, umax, vmin, vmax of the zoomed window (in wavelengths)
+  int zoomNu,zoomNv;            //!< number of points of the zoomed window along u and v
+  int single;                   //!< flag for single precision (-f 32)
+  int bitpix;                   //!< type of the output images (FLOAT_IMG or DOUBLE_IMG; -e, or as set by -f)
+  fitsCompression compression;  //!< tiled compression of the output images (-C)
+  int omode;                    //!< flag for the output quantities (0: amp,phase, 1: re,im, 2: amp, 3: power)
+  int smode;                    //!< flag for full-Stokes cube input (-S)
+  int mmode;                    //!< flag for movie mode (-M)
+  int rowBlock;                 //!< number of rows per block of the pipelined reading (0: off, -1: set by the size of the image)
+  int lowmem;                   //!< flag for the memory mode (0: normal, 1: in place (-m low), 2: out of core (-m disk))
+  long memBudget;               //!< memory budget (in bytes) of the out-of-core mode
+  int mpiRank,mpiSize;          //!< rank of this process and number of MPI processes (0 and 1 without MPI)
+  int overwrite;                //!< flag for overwriting existing output files (-F)
+  int writeQueue;               //!< maximum number of outputs queued for writing in the background (-q; 0: in the foreground)
+  fitsPrefetch *prefetch;       //!< prefetcher of the input files, or NULL
+  char indexFile[MAXPATH];      //!< catalog of the metadata of the input files (-I; empty if none)
+  fitsIndex *index;             //!< the catalog, once it is read in main(), or NULL
+} image2uvOptions;
+
+/*!
+  \brief A window of the u-v grid that is written to the output
+*/
+typedef struct
+{
+  int ku0,kv0;                  //!< u- and v- index of the first column and row of the window
+  int NxOut,NyOut;              //!< number of columns and rows of the window
+  int NxFull;                   //!< number of columns of the window including the half plane with u<0
+  int rowOffset;                //!< first row of the FFT array that is held in memory (e.g., by an MPI rank)
+  int colOffset;                //!< first column of the FFT array that is held in memory (e.g., in the out-of-core mode)
+  int NxHeld;                   //!< number of columns of the FFT array that are held in memory (0: all)
+  double zeroBaselineAmp;       //!< zero baseline amplitude, if the point with the zero baseline is not held
+} image2uvWindow;
+
+/*!
+  \brief The FFTW plans for a batch of padded images
+*/
+typedef struct
+{
+  int pruned;                   //!< flag for the pruned transform
+  int single;                   //!< flag for single precision; only the fftwf plans are used
+  fftw_plan full;               //!< plan for the 2D transforms, if not pruned
+  fftw_plan rows;               //!< plan for the transforms of the rows of the images, if pruned
+  fftw_plan cols[2];            //!< plans for the transforms of the columns that are needed, if pruned
+  fftwf_plan fullf,rowsf;       //!< the same plans in single precision
+  fftwf_plan colsf[2];          //!< the same plans in single precision
+  fftw_plan block[2];           //!< plans for the rows of a full block and of the last block, if pipelined
+  fftwf_plan blockf[2];         //!< the same plans in single precision
+  int blockRows;                //!< number of rows per block of the pipelined transforms of the rows (0: not pipelined)
+  int rowStart,Nrows;           //!< first row (starting from 0) and number of rows of the images
+} image2uvFFTPlan;
+
+/*!
+  \brief An input image of a batch, with its sizes
+*/
+typedef struct
+{
+  char *fileName;               //!< input image filename
+  int order;                    //!< position of the image in the list of inputs
+  int Nx,Ny;                    //!< size of the image
+  double xScale,yScale;         //!< physical sizes of the image pixels along the two directions
+  int NxPad,NyPad;              //!< size of the padded image
+  int Nstokes;                  //!< number of Stokes parameters of the image (1 for a total intensity image)
+  int plane;                    //!< plane of the image along the time axis of a movie cube (starting from 0)
+  fitsfile *fptr;               //!< input file, if it is open (see openFrame()), or NULL
+} image2uvFrame;
+
+/*!
+  \brief An output of transformGroup(), in a slot of the background writer (see writeOutputSlot())
+*/
+typedef struct
+{
+  image2uvOptions *opt;         //!< the options
+  char outFileName[MAXPATH];    //!< output filename
+  char hist[MAXPATH];           //!< history of the output file
+  int Ny,Nx;                    //!< size of the u-v grid that is written (Nx of the full grid)
+  int Nplanes;                  //!< number of Stokes parameters (1 for a total intensity image)
+  long planeSize;               //!< number of elements of the arrays of each Stokes parameter
+  double vScale,uScale;         //!< physical sizes of the u-v pixels along v and u
+  int datatype,bitpix;          //!< CFITSIO types of the arrays and of the output images
+  void *Va,*Vp;                 //!< visibility amplitudes and phases (or as set by -O), in the slot
+  void *Mre,*Mim,*Evpa;         //!< m-breve and the EVPA (for Nplanes>=3), in the slot
+} image2uvOutput;
+
+/*!
+  \brief The state of the pipeline of readTransformRows(), shared with its reading stage (see readRowsThread())
+*/
+typedef struct
+{
+  image2uvOptions *opt;         //!< the options
+  image2uvFrame *frame;         //!< the image that is read
+  int blockRows;                //!< number of rows per block
+  int iBlock;                   //!< the block that is read
+  void *inReal,*in;             //!< the input array of the FFT (real for r2c, complex for c2c)
+  int readflag;                 //!< result of the reading of the blocks so far
+} image2uvRowBlocks;
+
+/*!
+  \brief The state of the pipeline of movieGroup(), shared by its stages (see readMovieThread() and writeMovieThread())
+*/
+typedef struct
+{
+  image2uvOptions *opt;         //!< the options
+  image2uvFrame *frames;        //!< the frames of the movie
+  int NyPad,NxPad;              //!< size of the padded frames
+  int iStep;                    //!< the step of the pipeline (frame iStep is read, frame iStep-2 is written)
+  void *ImageIn;                //!< the padded image of the frame that is read
+  void *inReal[2],*in[2];       //!< the inputs of the two sets of FFT buffers (real for r2c, complex for c2c)
+  void *out[2];                 //!< the outputs of the two sets of FFT buffers
+  int frameOK[3];               //!< flags for the last three frames that were read
+  double fluxXCent[3];          //!< x-coordinate of the phase center of the last three frames
+  double fluxYCent[3];          //!< y-coordinate of the phase center of the last three frames
+  image2uvWindow win;           //!< window of the u-v grid that is written
+  void *Va,*Vp;                 //!< visibility amplitudes and phases (or as set by -O) of the frame that is written
+  int Nhdu;                     //!< number of HDUs of the output file
+  void *Vre[2],*Vim[2];         //!< arrays of the HDUs
+  fitsfile *fptr;               //!< output FITS file
+  pthread_mutex_t fitsLock;     //!< lock of the calls to CFITSIO, which is not reentrant unless built to be
+  int readStatus,writeStatus;   //!< results of the reading and the writing stages
+} image2uvMovie;
 
 /*!
 \brief Prints an error message
@@ -97,6 +330,53 @@ void printErrorImage2uv(char errmsg[])
 
   return;
 }
+
+/*!
+\brief Prints an error message for an input file that could not be read
+
+\details
+The message names the file, so that it can be found among the inputs of 
+a batch.
+
+\version 1.0
+
+@param *fileName a string with the input filename
+
+\return nothing
+
+*/
+void printReadErrorImage2uv(char *fileName)
+{
+  char errmsg[MAXPATH+40];                         // error message
+
+  snprintf(errmsg,sizeof errmsg,"reading file %s failed!\n",fileName);
+  printErrorImage2uv(errmsg);
+
+  return;
+}
+
+/*!
+\brief Prints an error message in the command line
+
+\details
+The command line is the same for all the MPI processes, so only the first
+one prints its errors.
+
+\version 1.0
+
+@param *opt a pointer to the options, with the rank of the process
+@param errmsg[] a string with the error message to be printed
+
+\return nothing
+
+*/
+void printOptionErrorImage2uv(image2uvOptions *opt, char errmsg[])
+{
+  if (opt->mpiRank==0)
+    printErrorImage2uv(errmsg);
+
+  return;
+}
   
 /*!
 \brief Prints a help message when no other arguments are given
@@ -123,12 +403,16 @@ void printhelp(void)
   printf("its complex Fourier transform, and stores the resulting\n");
   printf("visibility amplitudes and phases in an output FITS file.\n");
   printf("\n");
-  printf("Use: image2uv [-sv] [-p Npoints] [-c] [-o <fname>] <fname> \n");
+  printf("Use: image2uv [-sv] [-p Npoints] [-c] [-t r2c|c2c] [-f 32|64] [-e 32|64] [-C algorithm[,q[,qPhase]]]\n");
+  printf("              [-O re,im|amp,phase|amp|power] [-S] [-M] [-r Nrows]\n");
+  printf("              [-m low|disk|normal] [-B budget] [-H] [-w umax] [-b <fname>] [-z umin,umax,vmin,vmax,Nu,Nv] [-P estimate|measure|patient]\n");
+  printf("              [-W <dir>] [-j Nthreads] [-n Nbatch] [-l <manifest>] [-I <catalog>] [-d <dir>] [-q Nwrites] [-F] [-o <fname>] <fname> [<fname> ...]\n");
   printf("\n");
   printf("Options:\n");
   printf("\n");
-  printf("-o <fname>: sets the output visibility filename.\n");
+  printf("-o <fname>: sets the output visibility filename (- for the standard output).\n");
   printf("            The default is <uvout.fits>\n");
+  printf("-F: overwrites existing output files.\n");
   printf("-s: silent mode. It does not print anything.\n");
   printf("-v: verbose mode. It prints a lot more information .\n");
   printf("-p Npoints: pads the image to a square grid with Npoints on each side, \n"); 
@@ -137,6 +421,60 @@ void printhelp(void)
   printf("-c: calculates the complex phases by first centering the image to its center of\n");
   printf("    brightness. If this options is not given, it calculates the complex phase with\n");
   printf("    respect to the geometric center of the image.\n");
+  printf("-t r2c|c2c: sets the type of Fourier transform; r2c (default) uses the FFTW routines\n");
+  printf("    for real data, c2c uses the complex-to-complex routines.\n");
+  printf("-f 32|64: sets the precision of the image, the FFT and the output (default: 64).\n");
+  printf("    With 32, it uses float arrays and the single-precision FFTW routines.\n");
+  printf("-e 32|64: sets the precision of the output images (default: that of -f).\n");
+  printf("-C algorithm[,q[,qPhase]]: writes the output images tile-compressed, one tile per row,\n");
+  printf("    with the algorithm rice, gzip, or hcompress; q and qPhase are the quantization levels of\n");
+  printf("    the amplitudes and the phases (0: lossless, only with gzip; default: 0 for gzip, %g otherwise).\n",
+	 QUANTLEVEL);
+  printf("-O re,im|amp,phase|amp|power: sets the quantities that are calculated and written\n");
+  printf("    (default: amp,phase). re,im is written as one image with a complex third axis.\n");
+  printf("-S: reads full-Stokes cubes and transforms I, Q, U, and V together; writes one HDU per\n");
+  printf("    Stokes parameter (or two, for amp,phase), followed by m-breve=(Q+iU)/I and the EVPA.\n");
+  printf("-M: movie mode; the inputs (time cubes or 2D images) are the frames of a movie, which\n");
+  printf("    are streamed one at a time into a single time-indexed visibility cube.\n");
+  printf("-r Nrows: reads each image in blocks of Nrows rows, transforming each block while the\n");
+  printf("    next one is read (default: blocks of %d rows for images of at least %d pixels; 0: off).\n",
+	 ROWBLOCKDEFAULT,PIPELINEMINPIXELS);
+  printf("-m low|disk|normal: with low, transforms each image in place in the FFT buffer and writes the\n");
+  printf("    visibilities in blocks of rows, using about one complex grid of memory (default: normal).\n");
+  printf("    With disk, transforms grids larger than the memory out of core, with a scratch file in $%s.\n",SCRATCHENV);
+  printf("-B budget: sets the memory (in MB) of the blocks of the out-of-core mode (default: %d).\n",DISKBUDGETDEFAULT);
+  printf("-H: writes only the Hermitian half plane (u>=0) of the visibilities.\n");
+  printf("-w umax: calculates and writes only the central window of the u-v grid with |u|<=umax\n");
+  printf("    and |v|<=umax (in wavelengths).\n");
+  printf("-b <fname>: calculates the visibilities only at the baselines listed in <fname>, one\n");
+  printf("    'u v' pair (in wavelengths) per line, with a non-uniform FFT, and writes them to a\n");
+  printf("    table with one row per baseline. The -p option is ignored, and -H and -t cannot be\n");
+  printf("    used with it.\n");
+  printf("-z umin,umax,vmin,vmax,Nu,Nv: calculates the visibilities on a window of Nu by Nv points\n");
+  printf("    from (umin,vmin) to (umax,vmax) (in wavelengths), with a chirp-z transform, instead of\n");
+  printf("    on the grid of the FFT. The -p and -H options are ignored.\n");
+  printf("-P estimate|measure|patient: sets the rigor of the FFTW planning (default: estimate).\n");
+  printf("    Plans made with measure or patient are stored in the wisdom directory and\n");
+  printf("    reused by all later runs with the same padded size.\n");
+  printf("-W <dir>: sets the directory of the FFTW wisdom store. The default is $%s\n",WISDOMENV);
+  printf("    or, if this is not set, $HOME/%s\n",WISDOMDIRDEFAULT);
+  printf("-j Nthreads: uses Nthreads threads for the FFT and for the loops over the image and\n");
+  printf("    the visibilities (default: %d).\n",NTHREADSDEFAULT);
+#ifdef USE_MPI
+  printf("\n");
+  printf("With more than one MPI process (mpirun -np Nprocs image2uv_mpi ...), the FFT grid of each\n");
+  printf("image is distributed over the processes in slabs of rows (not with -S, -M, -b, -z, or -m low).\n");
+#endif
+  printf("\n");
+  printf("More than one input image may be given (batch mode). Each output is then written to\n");
+  printf("<dir>/<name>%s, where <name> is the input filename without its extension.\n",BATCHSUFFIX);
+  printf("-l <manifest>: reads more input filenames from <manifest>, one per line (- for stdin).\n");
+  printf("-I <catalog>: takes the sizes of the input images from a catalog made by achieve-index.\n");
+  printf("-d <dir>: sets the directory of the output files in batch mode (default: .).\n");
+  printf("-n Nbatch: sets the maximum number of images of the same padded size that are\n");
+  printf("    transformed together (default: as many as fit in %d MB).\n",BATCHMEMDEFAULT/1048576);
+  printf("-q Nwrites: sets the maximum number of outputs queued for writing in the background,\n");
+  printf("    while the next images are transformed (default: %d; 0: in the foreground).\n",WRITEQUEUEDEFAULT);
   printf("\n");
 }
 
@@ -160,7 +498,7 @@ provides a valid answer, it replaces the value for that option.
 
 \pre It is called from main()
 
-@param *outFileName a string which provides and returns the output filename
+@param *outFileName a string which provides and returns the output filename; if it is NULL (batch mode), the output filename is not asked for
 
 @param *vmode an int with a flag for the chosen verbose mode (0:silent, 1: normal, 2: verbose)
 
@@ -202,6 +540,10 @@ void verboseinput(char *outFileName, int *vmode, int *cmode, int *Npad)
       *cmode=0;
     }
 
+  // in batch mode, the output filenames follow the input filenames
+  if (outFileName==NULL)
+    return;
+
   // ask for output file
   printf("Output file name [%s]: ",outFileName);
   fgets(line, sizeof line, stdin);
@@ -216,6 +558,195 @@ void verboseinput(char *outFileName, int *vmode, int *cmode, int *Npad)
   return;
 }
 
+/*!
+\brief Adds an input filename to the list of input images
+
+\version 1.0
+
+\pre It is called from parse() and readManifest()
+
+@param *opt a pointer to the options, with the list of input filenames
+
+@param *fname a string with the input filename
+
+\return Returns zero if successful, 1 if not
+
+*/
+int addInputFile(image2uvOptions *opt, char *fname)
+{
+  char **newList;                                   // enlarged list of filenames
+
+  newList=(char **)realloc(opt->inFileNames,sizeof(char *)*(opt->Nin+1));
+  if (newList==NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");
+      return 1;
+    }
+  opt->inFileNames=newList;
+
+  opt->inFileNames[opt->Nin]=strdup(fname);
+  if (opt->inFileNames[opt->Nin]==NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");
+      return 1;
+    }
+  opt->Nin++;
+
+  return 0;
+}
+
+/*!
+\brief Reads a list of input filenames from a manifest file
+
+\details
+The manifest has one input filename per line. Leading and trailing 
+whitespace is removed, and empty lines and lines starting with '#'
+are ignored. If the name of the manifest is "-", the list is read 
+from the standard input.
+
+\version 1.0
+
+\pre It is called from parse()
+
+@param *manifest a string with the filename of the manifest
+
+@param *opt a pointer to the options, with the list of input filenames
+
+\return Returns zero if successful, 1 if not
+
+*/
+int readManifest(char *manifest, image2uvOptions *opt)
+{
+  FILE *fp;                      // pointer to the manifest file
+  char line[MAXPATH];            // line of characters
+  char *start;                   // first non-blank character of the line
+  int length;                    // length of the line
+  
+  if (strcmp(manifest,"-")==0)
+    fp=stdin;
+  else
+    fp=fopen(manifest,"r");
+
+  if (fp==NULL)
+    {
+      printErrorImage2uv("could not open the manifest file\n");
+      return 1;
+    }
+
+  while (fgets(line, sizeof line, fp)!=NULL)
+    {
+      // remove leading and trailing whitespace
+      start=line;
+      while (*start==' ' || *start=='\t')
+	start++;
+      length=strlen(start);
+      while (length>0 && (start[length-1]=='\n' || start[length-1]=='\r' ||
+			  start[length-1]==' ' || start[length-1]=='\t'))
+	start[--length]='\0';
+
+      // skip empty lines and comments
+      if (length==0 || start[0]=='#')
+	continue;
+
+      if (addInputFile(opt,start)!=0)
+	return 1;
+    }
+
+  if (fp!=stdin)
+    fclose(fp);
+
+  return 0;
+}
+
+/*!
+\brief Reads a list of baselines from a text file
+
+\details
+The file has one baseline per line, given by its u and v coordinates (in
+wavelengths) separated by whitespace. Empty lines and lines starting with
+'#' are ignored.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param *fname a string with the filename of the list of baselines
+@param *Nb on return, an int with the number of baselines
+@param **u on return, a pointer to an array with the u-coordinates of the baselines
+@param **v on return, a pointer to an array with the v-coordinates of the baselines
+
+\return Returns zero if successful, 1 if not
+
+*/
+int readBaselines(char *fname, int *Nb, double **u, double **v)
+{
+  FILE *fp;                      // pointer to the file with the baselines
+  char line[MAXPATH];            // line of characters
+  char *start;                   // first non-blank character of the line
+  int Nalloc=0;                  // number of baselines that fit in the arrays
+  double uLine,vLine;            // baseline in the current line
+  double *newArr;                // enlarged array
+
+  *Nb=0;
+  *u=NULL;
+  *v=NULL;
+
+  fp=fopen(fname,"r");
+  if (fp==NULL)
+    {
+      printErrorImage2uv("could not open the file with the baselines\n");
+      return 1;
+    }
+
+  while (fgets(line, sizeof line, fp)!=NULL)
+    {
+      // skip empty lines and comments
+      start=line+strspn(line," \t\r\n");
+      if (*start=='\0' || *start=='#')
+	continue;
+
+      if (sscanf(start,"%lf %lf",&uLine,&vLine)!=2)
+	{
+	  printErrorImage2uv("invalid line in the file with the baselines\n");
+	  fclose(fp);
+	  return 1;
+	}
+
+      // enlarge the arrays, if needed
+      if (*Nb==Nalloc)
+	{
+	  Nalloc=(Nalloc==0 ? 1024 : 2*Nalloc);
+	  newArr=(double *)realloc(*u,sizeof(double)*Nalloc);
+	  if (newArr!=NULL)
+	    {
+	      *u=newArr;
+	      newArr=(double *)realloc(*v,sizeof(double)*Nalloc);
+	    }
+	  if (newArr==NULL)
+	    {
+	      printErrorImage2uv("malloc failed!\n");
+	      fclose(fp);
+	      return 1;
+	    }
+	  *v=newArr;
+	}
+
+      (*u)[*Nb]=uLine;
+      (*v)[*Nb]=vLine;
+      (*Nb)++;
+    }
+
+  fclose(fp);
+
+  if (*Nb==0)
+    {
+      printErrorImage2uv("no baselines found in the file with the baselines\n");
+      return 1;
+    }
+
+  return 0;
+}
+
 /*!
 \brief Parses the command line for options
 
@@ -224,14 +755,31 @@ Parses the command line for options. If no options are given,
 it prints a help message
 
 The required options are:
-- <filename>: sets the input image filename (FITS)
+- <filename>: sets the input image filename (FITS); more than one may be given, or - for the standard input
 
 The optional options are:
-- "-o <filename>": sets the output visibility filename (UVFITS).
+- "-o <filename>": sets the output visibility filename (UVFITS); - for the standard output
 - "-s": silent mode. It does not print anything 
 - "-v": verbose mode. It prints a lot more information
 - "-p Npoints": pading. It pads the image to a square grid with Npoints on each side
 - "-c": calculates the complex phase by first centering the image to its center of brightness.
+- "-t r2c|c2c": sets the type of Fourier transform (real-to-complex or complex-to-complex)
+- "-f 32|64": sets the precision of the calculation
+- "-e 32|64": sets the precision of the output images
+- "-C algorithm[,q[,qPhase]]": sets the tiled compression of the output images
+- "-O re,im|amp,phase|amp|power": sets the quantities that are calculated and written
+- "-H": writes only the Hermitian half plane of the visibilities
+- "-w umax": calculates and writes only the central window |u|,|v|<=umax of the u-v grid
+- "-b baselines": calculates the visibilities only at the baselines listed in a file
+- "-z umin,umax,vmin,vmax,Nu,Nv": calculates the visibilities on a zoomed window of the u-v plane
+- "-P estimate|measure|patient": sets the rigor of the FFTW planning
+- "-W directory": sets the directory of the FFTW wisdom store
+- "-j Nthreads": sets the number of threads
+- "-l manifest": reads more input filenames from a manifest file ("-" for stdin)
+- "-d directory": sets the directory of the output files in batch mode
+- "-n Nbatch": sets the maximum number of images per FFT batch
+- "-q Nwrites": sets the maximum number of outputs queued for writing in the background
+- "-F": overwrites existing output files
 
 \author Dimitrios Psaltis
 
@@ -245,317 +793,4825 @@ The optional options are:
 
 @param argv[] an array of strings (as is piped from the unix prompt)
 
-@param *inFileName a string which returns the input filename
-
-@param *outFileName a string which returns the output filename
-
-@param *vmode an int with a flag for the chosen verbose mode (0:silent, 1: normal, 2: verbose)
-
-@param *cmode an int with a flat for whether the FFT will be centered on the center of brightness
-
-@param *Npad an int with the number of points per dimension to which the image will be padded. It it is smaller than the number of points in the image, then the total number of points in the image will be used.
+@param *opt a pointer to the options, which returns the values set on the command line
 
 \return Returns zero if successful, 1 if not
 
 */
-int parse(int argc, char *argv[], char *inFileName, char *outFileName, int *vmode, int *cmode, int *Npad)
+int parse(int argc, char *argv[], image2uvOptions *opt)
 {
-  int opt = 0;
+  int option = 0;
   int index;
+  int outGiven=0;      // flag for whether the -o option was given
+  int typeGiven=0;     // flag for whether the -t option was given
+  char *ptr;           // pointer used for converting strings to numbers
+  long NpadInput;      // number of padded points, before it is checked
   
   opterr=0;            // do not print any other errors
   
-  if (argc==1)         // if no options are given
+  opt->inFileNames=NULL;                    // no input files yet
+  opt->Nin=0;
+  opt->vmode=VMODEDEFAULT;                  // default verbose mode "medium"
+  opt->cmode=0;                             // phases with respect to the geometric center
+  opt->Npad=0;                              // no padding
+  opt->tmode=TMODEDEFAULT;                  // default transform type
+  opt->hmode=0;                             // write the full u-v grid by default
+  opt->planFlags=FFTW_ESTIMATE;             // plan the FFT with a heuristic by default
+  opt->Nbatch=0;                            // batch size set by the memory of the buffers
+  opt->nthreads=NTHREADSDEFAULT;            // default number of threads
+  opt->wmax=0.0;                            // the whole u-v grid by default
+  opt->baselineFile[0]='\0';                // regular u-v grid by default
+  opt->zmode=0;
+  opt->single=0;                            // double precision by default
+  opt->bitpix=0;                            // output images in the precision of the calculation by default
+  opt->compression.type=0;                  // uncompressed output images by default
+  opt->omode=0;                             // amplitudes and phases by default
+  opt->smode=0;                             // total intensity images by default
+  opt->mmode=0;                             // one output per image by default
+  opt->rowBlock=-1;                         // pipelined reading for large images by default
+  opt->lowmem=0;                            // separate image, FFT, and visibility arrays by default
+  opt->memBudget=(long)DISKBUDGETDEFAULT*1048576; // default memory budget of the out-of-core mode
+  opt->overwrite=0;                         // existing output files are not overwritten by default
+  opt->writeQueue=WRITEQUEUEDEFAULT;        // outputs written in the background by default
+  opt->prefetch=NULL;                       // started in main(), with more than one input
+  opt->indexFile[0]='\0';                   // the sizes are read from the input files by default
+  opt->index=NULL;                          // read in main()
+#ifdef USE_MPI
+  MPI_Comm_rank(MPI_COMM_WORLD,&opt->mpiRank); // MPI is started in main(), before the command line is parsed
+  MPI_Comm_size(MPI_COMM_WORLD,&opt->mpiSize);
+#else
+  opt->mpiRank=0;                           // a single process
+  opt->mpiSize=1;
+#endif
+  strcpy(opt->outFileName,DEFAULTOUTFILENAME); // default filename for output file
+  strcpy(opt->outDir,".");                  // default directory for output files in batch mode
+
+  if (argc==1)                              // if no options are given
     {
-      printhelp();     // print help message and return with a code to do nothing
+      if (opt->mpiRank==0)
+	printhelp();                        // print help message and return with a code to do nothing
       return 1;
     }
 
-  *vmode=VMODEDEFAULT;                      // default verbose mode "medium"
-  strcpy(outFileName,DEFAULTOUTFILENAME);   // default filename for output file
+  // default directory of the wisdom store
+  opt->wisdomDir[0]='\0';
+  if (getenv(WISDOMENV)!=NULL)
+    snprintf(opt->wisdomDir,MAXPATH,"%s",getenv(WISDOMENV));
+  else if (getenv("HOME")!=NULL)
+    snprintf(opt->wisdomDir,MAXPATH,"%s/%s",getenv("HOME"),WISDOMDIRDEFAULT);
   
   // parse through arguments with options
-  while ((opt = getopt(argc, argv, "o:svcp:")) != -1)
+  while ((option = getopt(argc, argv, "o:svcp:t:f:e:C:O:SMr:m:B:Hw:b:z:P:W:l:d:n:j:q:FI:")) != -1)
     {
-      switch(opt)
+      switch(option)
 	{
 	case 'o':
-	  strcpy(outFileName,optarg);
+	  snprintf(opt->outFileName,MAXPATH,"%s",optarg);
+	  outGiven=1;
 	  break;
 	case 's':
-	  *vmode=0;                         // verbose mode "silent"
+	  opt->vmode=0;                     // verbose mode "silent"
+	  break;
+	case 'F':
+	  opt->overwrite=1;                 // overwrite existing output files
 	  break;
 	case 'v':
-	  *vmode=2;                         // verbose mode "verbose"
+	  opt->vmode=2;                     // verbose mode "verbose"
 	  break;
 	case 'c':
-	  *cmode=1;                         // centering mode is on
+	  opt->cmode=1;                     // centering mode is on
 	  break;
 	case 'p':                           // if padding is introduced
-	  *Npad=strtoumax(optarg, NULL, 10);// return number of padded points
-	  if (*Npad==0)
+	  NpadInput=strtol(optarg, &ptr, 10);// return number of padded points
+	  if (*ptr!='\0' || NpadInput<=0 || NpadInput>INT_MAX)
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid number of padding points\n");
+	      return 1;
+	    }
+	  opt->Npad=NpadInput;
+	  break;
+	case 't':                           // type of Fourier transform
+	  typeGiven=1;
+	  if (strcmp(optarg,"r2c")==0)
+	    opt->tmode=0;
+	  else if (strcmp(optarg,"c2c")==0)
+	    opt->tmode=1;
+	  else
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid type of transform; use r2c or c2c\n");
+	      return 1;
+	    }
+	  break;
+	case 'f':                           // precision of the calculation
+	  if (strcmp(optarg,"32")==0)
+	    opt->single=1;
+	  else if (strcmp(optarg,"64")==0)
+	    opt->single=0;
+	  else
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid precision; use 32 or 64\n");
+	      return 1;
+	    }
+	  break;
+	case 'e':                           // precision of the output images
+	  if (strcmp(optarg,"32")==0)
+	    opt->bitpix=FLOAT_IMG;
+	  else if (strcmp(optarg,"64")==0)
+	    opt->bitpix=DOUBLE_IMG;
+	  else
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid precision of the output; use 32 or 64\n");
+	      return 1;
+	    }
+	  break;
+	case 'C':                           // tiled compression of the output images
+	  if (parseFITSCompression(optarg,&opt->compression)!=0)
+	    return 1;
+	  break;
+	case 'O':                           // output quantities
+	  if (strcmp(optarg,"amp,phase")==0)
+	    opt->omode=0;
+	  else if (strcmp(optarg,"re,im")==0)
+	    opt->omode=1;
+	  else if (strcmp(optarg,"amp")==0)
+	    opt->omode=2;
+	  else if (strcmp(optarg,"power")==0)
+	    opt->omode=3;
+	  else
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid output; use re,im, amp,phase, amp, or power\n");
+	      return 1;
+	    }
+	  break;
+	case 'S':
+	  opt->smode=1;                     // full-Stokes cube input
+	  break;
+	case 'M':
+	  opt->mmode=1;                     // movie mode
+	  break;
+	case 'r':                           // rows per block of the pipelined reading
+	  opt->rowBlock=strtol(optarg, NULL, 10);
+	  if (opt->rowBlock<0)
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid number of rows per block\n");
+	      return 1;
+	    }
+	  break;
+	case 'm':                           // memory mode
+	  if (strcmp(optarg,"low")==0)
+	    opt->lowmem=1;
+	  else if (strcmp(optarg,"disk")==0)
+	    opt->lowmem=2;
+	  else if (strcmp(optarg,"normal")==0)
+	    opt->lowmem=0;
+	  else
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid memory mode; use low, disk, or normal\n");
+	      return 1;
+	    }
+	  break;
+	case 'H':
+	  opt->hmode=1;                     // Hermitian half plane output
+	  break;
+	case 'w':                           // central u-v window
+	  opt->wmax=strtod(optarg, NULL);
+	  if (opt->wmax<=0.0)
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid half-width of the u-v window\n");
+	      return 1;
+	    }
+	  break;
+	case 'b':                           // file with the list of baselines
+	  snprintf(opt->baselineFile,MAXPATH,"%s",optarg);
+	  break;
+	case 'z':                           // zoomed u-v window
+	  if (sscanf(optarg,"%lf,%lf,%lf,%lf,%d,%d",opt->zoomWindow,opt->zoomWindow+1,
+		     opt->zoomWindow+2,opt->zoomWindow+3,&opt->zoomNu,&opt->zoomNv)!=6 ||
+	      opt->zoomNu<1 || opt->zoomNv<1)
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid zoomed window; use umin,umax,vmin,vmax,Nu,Nv\n");
+	      return 1;
+	    }
+	  opt->zmode=1;
+	  break;
+	case 'P':                           // rigor of the FFTW planning
+	  if (strcmp(optarg,"estimate")==0)
+	    opt->planFlags=FFTW_ESTIMATE;
+	  else if (strcmp(optarg,"measure")==0)
+	    opt->planFlags=FFTW_MEASURE;
+	  else if (strcmp(optarg,"patient")==0)
+	    opt->planFlags=FFTW_PATIENT;
+	  else
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid planning rigor; use estimate, measure, or patient\n");
+	      return 1;
+	    }
+	  break;
+	case 'W':                           // directory of the wisdom store
+	  snprintf(opt->wisdomDir,MAXPATH,"%s",optarg);
+	  break;
+	case 'l':                           // manifest with more input files
+	  if (readManifest(optarg,opt)!=0)
+	    return 1;
+	  break;
+	case 'I':                           // catalog of the metadata of the input files
+	  snprintf(opt->indexFile,MAXPATH,"%s",optarg);
+	  break;
+	case 'd':                           // directory of the output files in batch mode
+	  snprintf(opt->outDir,MAXPATH,"%s",optarg);
+	  break;
+	case 'n':                           // maximum number of images per FFT batch
+	  opt->Nbatch=strtol(optarg, NULL, 10);
+	  if (opt->Nbatch<=0)
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid number of images per batch\n");
+	      return 1;
+	    }
+	  break;
+	case 'B':                           // memory budget of the out-of-core mode (in MB)
+	  opt->memBudget=strtol(optarg, NULL, 10)*1048576L;
+	  if (opt->memBudget<=0)
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid memory budget\n");
+	      return 1;
+	    }
+	  break;
+	case 'q':                           // maximum number of outputs queued for writing
+	  opt->writeQueue=strtol(optarg, &ptr, 10);
+	  if (*ptr!='\0' || opt->writeQueue<0)
+	    {
+	      printOptionErrorImage2uv(opt,"Invalid number of outputs queued for writing\n");
+	      return 1;
+	    }
+	  break;
+	case 'j':                           // number of threads
+	  opt->nthreads=strtol(optarg, NULL, 10);
+	  if (opt->nthreads<=0)
 	    {
-	      printErrorImage2uv("Invalid number of padding points\n");
+	      printOptionErrorImage2uv(opt,"Invalid number of threads\n");
 	      return 1;
 	    }
 	  break;
 	case '?':
 	    {
-	      printErrorImage2uv("Invalid option received\n");
+	      printOptionErrorImage2uv(opt,"Invalid option received\n");
 	    }
 	  break;
 	}
     }
 
-  // The variable argc counts the total number of elements in the input,
-  //    while the variable optind counts the number of arguments
-  //    that have been parsed. If the latter is larger than the
-  //    former, then there is no argument after the options
-
-      if (optind >= argc) {
-	printErrorImage2uv("Expected argument after options\n");
-        return 1;
-  }
+  // all the non-option arguments are input file names
+  for (index=optind;index<argc;index++)
+    if (addInputFile(opt,argv[index])!=0)
+      return 1;
 
-  if (argc-optind!=1)  // it requires at least one argument with no options
+  if (opt->Nin==0)
     {
-      printErrorImage2uv("Too many arguments\n");
+      printOptionErrorImage2uv(opt,"Expected argument after options\n");
       return 1;
     }
-  
-  // input file name is the single non-option argument
-  strcpy(inFileName,argv[optind]);
-  
-  return 0; 
-}
 
-/*!
- \brief Main program
+  if (opt->zmode && opt->baselineFile[0]!='\0')
+    {
+      printOptionErrorImage2uv(opt,"-z and -b cannot be used together\n");
+      return 1;
+    }
 
- \author Dimitrios Psaltis
+  // the baselines are sampled with the non-uniform FFT, and only listed in a table
+  if (opt->baselineFile[0]!='\0' && (opt->hmode || typeGiven))
+    {
+      printOptionErrorImage2uv(opt,"-H and -t cannot be used with -b\n");
+      return 1;
+    }
 
- \version 1.0
+  if (opt->smode && (opt->zmode || opt->baselineFile[0]!='\0'))
+    {
+      printOptionErrorImage2uv(opt,"-S cannot be used with -z or -b\n");
+      return 1;
+    }
 
- \date September 30, 2017
+  if (opt->mmode && (opt->smode || opt->zmode || opt->baselineFile[0]!='\0'))
+    {
+      printOptionErrorImage2uv(opt,"-M cannot be used with -S, -z, or -b\n");
+      return 1;
+    }
 
- \pre Nothing
+  if (opt->lowmem && (opt->smode || opt->mmode || opt->zmode || opt->baselineFile[0]!='\0'))
+    {
+      printOptionErrorImage2uv(opt,"-m low and -m disk cannot be used with -S, -M, -z, or -b\n");
+      return 1;
+    }
 
- */
-int main(int argc, char *argv[])
-{
-  int index;                                        // generic integer variable
-  char inFileName[MAXCHAR], outFileName[MAXCHAR];   // string for input and output filenames
-  char hist[MAXCHAR];                               // string for history in output FITS file
-  int vmode;                                        // flag for verbose mode
-  int cmode;                                        // flag for image centering
-  int Npad=0;                                       // Number of points per dimension for image padding;
-  int iColStart,iRowStart;                          // Startng row and column of padded image
-  int NxPad, NyPad;                                 // Size of padded image in 2D
-  
-  int Nx,Ny;                                        // size of image in 2D (to be read from file)
-  double xScale,yScale;                             // physical sizes of image pixels along the two directions
-  double *ImageIn;                                  // pointer to image array
+  if (opt->compression.type!=0 && (opt->mmode || opt->lowmem || opt->baselineFile[0]!='\0'))
+    {
+      printOptionErrorImage2uv(opt,"-C cannot be used with -M, -m low, -m disk, or -b\n");
+      return 1;
+    }
 
-  double *Va, *Vp;                                  // pointers to arrays with amplitude and phase
-                                                    // of complex visibilities
-  double vScale,uScale;                             // physical sizes of u-v pixels along the two directions
+  // the output images are in the precision of the calculation, unless set by -e
+  if (opt->bitpix==0)
+    opt->bitpix=(opt->single ? FLOAT_IMG : DOUBLE_IMG);
 
-  double fluxXCent=0.0, fluxYCent=0.0;              // variables for finding the brightness center
-  double fluxTotal=0.0;                             // total flux in the image (arb units)
+  // in batch mode the output filenames follow the input filenames; a movie has one output file
+  if (opt->Nin>1 && outGiven && !opt->mmode)
+    {
+      printOptionErrorImage2uv(opt,"-o cannot be used with more than one input; use -d instead\n");
+      return 1;
+    }
+
+  // the standard input is read only once, as a single 2D image
+  for (index=0;index<opt->Nin;index++)
+    if (isFITSPipe(opt->inFileNames[index]) && (opt->Nin>1 || opt->smode || opt->mmode))
+      {
+	printOptionErrorImage2uv(opt,"the standard input can only be a single input image, and not with -S or -M\n");
+	return 1;
+      }
+
+  // the output file on the standard output cannot be mixed with messages
+  if (isFITSPipe(opt->outFileName))
+    opt->vmode=0;
+
+  if (opt->overwrite && overwriteFITSName(opt->outFileName,MAXPATH)!=0)
+    return 1;
   
-  fftw_complex *in, *out;                           // pointers to arrays for 2D FFTs
-  fftw_plan p;                                      // 2D fft plan used in FFTW
+  return 0; 
+}
 
-  int indexR,indexC;                                // dummy indices for counting rows and columns
+/*!
+\brief Constructs the name of the file with the FFTW wisdom for a given transform
 
-  int dummyResult;                                  // dummy variable for integer results of functions
-	  
-  // parse the command line
-  int parseflag=parse(argc, argv,&inFileName,&outFileName,&vmode,&cmode,&Npad);
+\details
+The wisdom store is a directory with one file per padded size, type of 
+transform and number of threads, named e.g. image2uv_r2c_4096x4096_t1.wisdom,
+so that the plans for different problems are kept and updated independently.
+Plans for batches of more than one image have the number of images in the
+batch appended, e.g. image2uv_r2c_512x512_t1_b64.wisdom. FFTW keeps separate
+wisdom for each precision, so single-precision plans are stored in their
+own files, e.g. image2uv_r2c_f32_4096x4096_t1.wisdom. The plans of the
+distributed transforms depend on the number of MPI processes, which is
+appended instead, e.g. image2uv_r2c_mpi_65536x65536_t8_p16.wisdom. The 
+chirp-z transforms the rows of the image along x and the columns of the
+window along y, so both numbers are appended, columns first, e.g.
+image2uv_zoom_1024x1024_t1_b256x512.wisdom.
 
-  // if there was an error in parsing, return with an error code
-  if (parseflag!=0) return 1;
+\version 1.0
 
-  // read the size (in 2D) of the input file
-  int readflag=readFITSImagedim(inFileName, &Ny, &Nx,&yScale,&xScale);
+\pre It is called from importWisdom() and exportWisdom()
 
-  // if there was no physical scale in the image, just set it to unity
-  if (xScale==0 || yScale==0)
-    {
-      xScale=1.0;
-      yScale=1.0;
-    }
-    
-  // if there is a problem
-  if (readflag!=0)
+@param *wisdomDir a string with the directory of the wisdom store
+@param tmode an int with the type of transform (0: r2c, 1: c2c, 2: chirp-z, 3: pruned r2c, 4: pruned c2c, 5: MPI r2c, 6: MPI c2c, 7: out-of-core r2c, 8: out-of-core c2c)
+@param single an int with a flag for single precision
+@param NyPad an int with the number of rows of the padded image (the length of the FFTs along y for chirp-z)
+@param NxPad an int with the number of columns of the padded image (the length of the FFTs along x for chirp-z)
+@param nthreads an int with the number of threads used by the transform
+@param howmany an int with the number of images transformed with the plan (the number of MPI processes for the MPI transforms, the number of rows of the image for chirp-z)
+@param howmanyY an int with the number of columns of the window for chirp-z, which are transformed along y (0 for the other transforms)
+@param *fname a string which returns the name of the wisdom file
+
+\return Returns zero if successful, 1 if there is no wisdom store
+
+*/
+int wisdomFileName(char *wisdomDir, int tmode, int single, int NyPad, int NxPad, int nthreads, int howmany, int howmanyY,
+		   char *fname)
+{
+  char *tname[9]={"r2c","c2c","zoom","r2c_pruned","c2c_pruned","r2c_mpi","c2c_mpi",
+		  "r2c_disk","c2c_disk"};                       // names of the types of transform
+  char *pname=(single ? "_f32" : "");                            // precision of the transform
+
+  // if there is no wisdom store, there is nothing to do
+  if (wisdomDir==NULL || wisdomDir[0]=='\0')
+    return 1;
+
+  if (tmode==5 || tmode==6)
+    snprintf(fname,MAXPATH,"%s/image2uv_%s%s_%dx%d_t%d_p%d.wisdom",wisdomDir,
+	     tname[tmode],pname,NyPad,NxPad,nthreads,howmany);
+  else if (tmode==2)
+    snprintf(fname,MAXPATH,"%s/image2uv_%s%s_%dx%d_t%d_b%dx%d.wisdom",wisdomDir,
+	     tname[tmode],pname,NyPad,NxPad,nthreads,howmanyY,howmany);
+  else if (howmany==1)
+    snprintf(fname,MAXPATH,"%s/image2uv_%s%s_%dx%d_t%d.wisdom",wisdomDir,
+	     tname[tmode],pname,NyPad,NxPad,nthreads);
+  else
+    snprintf(fname,MAXPATH,"%s/image2uv_%s%s_%dx%d_t%d_b%d.wisdom",wisdomDir,
+	     tname[tmode],pname,NyPad,NxPad,nthreads,howmany);
+
+  return 0;
+}
+
+/*!
+\brief Imports the FFTW wisdom for a given transform from the wisdom store
+
+\details
+Any wisdom accumulated so far is forgotten first, so that each file of the
+wisdom store only ever holds the plans for its own transform. It is not an
+error if there is no wisdom stored yet for this transform.
+
+\version 1.0
+
+\pre It is called from planFFT() before the FFTW plan is made
+
+@param *wisdomDir a string with the directory of the wisdom store
+@param tmode an int with the type of transform (0: r2c, 1: c2c, 2: chirp-z, 3: pruned r2c, 4: pruned c2c, 5: MPI r2c, 6: MPI c2c, 7: out-of-core r2c, 8: out-of-core c2c)
+@param single an int with a flag for single precision
+@param NyPad an int with the number of rows of the padded image
+@param NxPad an int with the number of columns of the padded image
+@param nthreads an int with the number of threads used by the transform
+@param howmany an int with the number of images transformed with the plan (the number of MPI processes for the MPI transforms, the number of rows of the image for chirp-z)
+@param howmanyY an int with the number of columns of the window for chirp-z, which are transformed along y (0 for the other transforms)
+@param vmode an int with a flag for the chosen verbose mode (0:silent, 1: normal, 2: verbose)
+
+\return Returns 1 if wisdom was imported, zero if not
+
+*/
+int importWisdom(char *wisdomDir, int tmode, int single, int NyPad, int NxPad, int nthreads, int howmany, int howmanyY,
+		 int vmode)
+{
+  char fname[MAXPATH];                              // name of the wisdom file
+  int imported;                                     // flag for the result of the import
+
+  if (single)
+    fftwf_forget_wisdom();
+  else
+    fftw_forget_wisdom();
+
+  if (wisdomFileName(wisdomDir,tmode,single,NyPad,NxPad,nthreads,howmany,howmanyY,fname)!=0)
+    return 0;
+
+  // the file does not exist until the first run that measures a plan
+  if (access(fname,R_OK)!=0)
+    return 0;
+
+  if (single)
+    imported=fftwf_import_wisdom_from_filename(fname);
+  else
+    imported=fftw_import_wisdom_from_filename(fname);
+  if (imported==0)
     {
-      printErrorImage2uv("reading file failed!\n");   // print error message
-      return 1;                                     // return with error code
+      printErrorImage2uv("could not import FFTW wisdom; planning from scratch\n");
+      return 0;
     }
 
-  // if in verbose mode, ask for all the inputs again
-  if (vmode==2)
-    verboseinput(outFileName, &vmode, &cmode, &Npad);
+  if (vmode!=0)
+    printf("image2uv: Imported FFTW wisdom from %s\n",fname);
 
-  // figure out padding
-  dummyResult=ArrayPad(Ny, Nx, Npad, &iRowStart, &iColStart, &NyPad, &NxPad);  
+  return 1;
+}
 
-  // allocate memory for the image and visibility arrays
-  ImageIn = (int *)malloc(sizeof(double)*NxPad*NyPad);  // allocate memory to store image
-  Va = (int *)malloc(sizeof(double)*NxPad*NyPad);  // allocate memory to store Vis Amplitude
-  Vp = (int *)malloc(sizeof(double)*NxPad*NyPad);  // allocate memory to store Vis Phase
-  
-  // if memory allocation failed
-  if(ImageIn == NULL)
+/*!
+\brief Exports the FFTW wisdom for a given transform to the wisdom store
+
+\details
+It creates the directory of the wisdom store, if it does not exist. A 
+failure to store the wisdom only results in a warning, since it does
+not affect the results of the transform.
+
+\version 1.0
+
+\pre It is called from planFFT() after the FFTW plan is made
+
+@param *wisdomDir a string with the directory of the wisdom store
+@param tmode an int with the type of transform (0: r2c, 1: c2c, 2: chirp-z, 3: pruned r2c, 4: pruned c2c, 5: MPI r2c, 6: MPI c2c, 7: out-of-core r2c, 8: out-of-core c2c)
+@param single an int with a flag for single precision
+@param NyPad an int with the number of rows of the padded image
+@param NxPad an int with the number of columns of the padded image
+@param nthreads an int with the number of threads used by the transform
+@param howmany an int with the number of images transformed with the plan (the number of MPI processes for the MPI transforms, the number of rows of the image for chirp-z)
+@param howmanyY an int with the number of columns of the window for chirp-z, which are transformed along y (0 for the other transforms)
+@param vmode an int with a flag for the chosen verbose mode (0:silent, 1: normal, 2: verbose)
+
+\return Returns zero if successful, 1 if not
+
+*/
+int exportWisdom(char *wisdomDir, int tmode, int single, int NyPad, int NxPad, int nthreads, int howmany, int howmanyY,
+		 int vmode)
+{
+  char fname[MAXPATH];                              // name of the wisdom file
+  int exported;                                     // flag for the result of the export
+
+  if (wisdomFileName(wisdomDir,tmode,single,NyPad,NxPad,nthreads,howmany,howmanyY,fname)!=0)
+    return 1;
+
+  // create the directory of the wisdom store, if needed
+  if (mkdir(wisdomDir,0755)!=0 && errno!=EEXIST)
     {
-      printErrorImage2uv("malloc failed!\n");   // print error message
-      return 1;                               // return with error code
+      printErrorImage2uv("could not create the FFTW wisdom directory\n");
+      return 1;
     }
   
-  // now read the whole file
-  readflag=readFITSImage(inFileName, Ny, Nx, Npad,ImageIn);
-  
-  // if there was a problem
-  if (readflag!=0)
+  if (single)
+    exported=fftwf_export_wisdom_to_filename(fname);
+  else
+    exported=fftw_export_wisdom_to_filename(fname);
+  if (exported==0)
     {
-      printErrorImage2uv("reading file failed!\n");   // print error message
-      return 1;                                     // return with error code
+      printErrorImage2uv("could not export FFTW wisdom\n");
+      return 1;
     }
 
   if (vmode!=0)
-    printf("image2uv: Read %dx%d image from file %s\n",Nx,Ny,inFileName);
-  
-  // allocate memory for the image to FFT
-  in = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * NxPad* NyPad);
-  // allocate memory for the output of the FFT
-  out = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * NxPad* NyPad);
-  
-  // make a 2D FFTW plan, as required by the FFTW library
-  // HERE!!!!
-  p = fftw_plan_dft_2d(NyPad,NxPad, in, out, FFTW_FORWARD, FFTW_ESTIMATE);
-  
-  // fill the input array using the image that was just read
-  // and, in the meantime, find the brightness center of the image
-  for (indexR=1;indexR<=NyPad;indexR++)
-    {
-      for (indexC=1;indexC<=NxPad;indexC++)
-	{
-	  index=indexArr(indexR,indexC,NyPad,NxPad);
-	  in[index][0]=*(ImageIn+index);
-	  in[index][1]=0.0;                  // no imaginary part
-	  fluxXCent+=indexC*in[index][0];    // add to calculate center of brightness
-	  fluxYCent+=indexR*in[index][0];    // add to calculate center of brightness
-	  fluxTotal+=in[index][0];           // add for total flux in the image
-	}
-    }
+    printf("image2uv: Exported FFTW wisdom to %s\n",fname);
+
+  return 0;
+}
+
+/*!
+\brief Makes the tables for transposing the output of the FFT to a centered u-v window
+
+\details
+For each column of the window win of the u-v grid, it finds the column of
+the FFT array that is transposed to it, so that the array is centered
+(unless only u>=0 is kept). If the column is in the half plane that the
+r2c transform does not store (r2cmode set), its index is stored as
+-(column of V(-u,-v))-1, and the visibility is the complex conjugate of
+the one at row rowFromConj and column -colFrom-1.
+
+For each row of the window, it finds the row of the FFT array that is
+transposed to it and the row of V(-u,-v). If the array holds only the rows
+of the FFT from row win->rowOffset on (e.g., the slab of an MPI rank), the
+rows are counted from that row, and if it holds only the columns from 
+column win->colOffset on (e.g., a tile of the out-of-core mode), the 
+columns are counted from that column; the window then needs to have only
+rows and columns that are held.
+
+\version 1.0
+
+\pre It is called from fftToVis() and fftToPol()
+
+@param NyPad an int with the number of rows of the padded image
+@param NxPad an int with the number of columns of the padded image
+@param r2cmode an int with a flag for whether the FFT array holds the output of a real-to-complex FFT
+@param *win a pointer to the window of the u-v grid to be stored
+@param *colFrom on return, the NxOut columns of the FFT array for the columns of the window
+@param *rowFrom on return, the NyOut rows of the FFT array for the rows of the window
+@param *rowFromConj on return, the NyOut rows of the FFT array for V(-u,-v)
+
+\return nothing
+
+*/
+void transposeTables(int NyPad, int NxPad, int r2cmode, image2uvWindow *win,
+		     int *colFrom, int *rowFrom, int *rowFromConj)
+{
+  int indexR,indexC;                                // dummy indices for counting rows and columns
+  int NxFFT=(r2cmode ? NxPad/2+1 : NxPad);          // number of columns of the FFT array
 
-  // calculate the flux center
-  // if there is some flux in the image and the centering option is on
-  if (fluxTotal!=0.0 && cmode==1)
+  for (indexC=0;indexC<win->NxOut;indexC++)
     {
-      // normalize the x- and y- coordinates
-      fluxXCent/=fluxTotal;
-      fluxYCent/=fluxTotal;
-      if (vmode!=0)
-	printf("image2uv: brightness center at the (%7.1f,%7.1f) grid point\n",fluxXCent,fluxYCent);
+      colFrom[indexC]=(win->ku0+indexC+NxPad)%NxPad;
+      if (colFrom[indexC]>=NxFFT)
+	colFrom[indexC]=-((NxPad-colFrom[indexC])%NxPad)-1+win->colOffset;
+      else
+	colFrom[indexC]-=win->colOffset;
     }
-  else
+
+  for (indexR=0;indexR<win->NyOut;indexR++)
     {
-      // otherwise just center it
-      fluxXCent=NxPad/2.0;
-      fluxYCent=NyPad/2.0;
+      rowFrom[indexR]=(win->kv0+indexR+NyPad)%NyPad;
+      rowFromConj[indexR]=(NyPad-rowFrom[indexR])%NyPad-win->rowOffset;
+      rowFrom[indexR]-=win->rowOffset;
     }
 
-  // calculate the FFT of the image based on the FFTW plan
-  fftw_execute(p);
-  // destroy the FFTW plan
-  fftw_destroy_plan(p);
+  return;
+}
 
-  if (vmode!=0)
-    printf("image2uv: FFT of the padded %dx%d image completed\n",NxPad,NyPad);
+/*!
+\brief Converts the output of the FFT to centered visibility amplitudes and phases
 
-  // Convert the complex FFT to visibility amplitudes and phases
-  // Also transpose the FFT array so that it is centered.
+\details
+Takes the complex Fourier transform of the padded NyPad by NxPad image, as
+returned by FFTW, and stores the visibility amplitudes and phases in the
+arrays Va and Vp, transposing the array so that the zero baseline is at 
+the center of the grid. The phases are calculated with respect to the 
+point (fluxXCent,fluxYCent) of the image.
 
-  // first keep the zero baseline amplitude
-  double zeroBaselineAmp=sqrt(out[0][0]*out[0][0]+out[0][1]*out[0][1]);
+If r2cmode is set, the array out holds only the NyPad by (NxPad/2+1)
+non-redundant half of the transform, as returned by the FFTW routines
+for real data, and the other half is reconstructed from the Hermitian
+symmetry V(-u,-v)=V*(u,v). If the window has win->NxHeld set, out holds 
+only that many columns of the transform (see transposeTables()).
 
-  if (vmode!=0)
-    printf("image2uv: zero baseline amplitude is %e\n",zeroBaselineAmp);
+The output window win sets which part of the u-v grid is stored in the 
+arrays Va and Vp: its first column and row are at the u- and v- indices
+ku0 and kv0 (e.g., -NxPad/2 and -NyPad/2 for the whole centered grid, or 0
+for the first column if only the half plane with u>=0 is stored), and it has
+NxOut columns and NyOut rows.
+
+The transposition is done with tables of the source row and column of each
+output row and column (see transposeTables()). The shift of the phase center is separable, i.e., 
+exp(2 pi i [(xc-1)ku/NxPad+(yc-1)kv/NyPad]) is the product of a rotation
+along u and a rotation along v, so it is applied as a complex multiplication
+with two tables of rotations that are calculated once, and only one atan2()
+is needed per visibility.
+
+In order to avoid numerical issues, when the amplitude is smaller than 
+a predefined fraction (MINAMP) of the zero baseline amplitude, the phase
+is set to zero.
+
+The quantities that are stored in Va and Vp are set by omode (the -O 
+option): the amplitudes and phases (0), the real and imaginary parts (1),
+only the amplitudes (2), or only the squared amplitudes (3). In the last
+two cases Vp is not used, and neither the rotations nor atan2() are
+calculated.
+
+If single is set, out is an fftwf_complex array and Va and Vp are float
+arrays; the rotations and the phases are still calculated in double
+precision.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param *out a pointer to the complex FFT of the image
+@param NyPad an int with the number of rows of the padded image
+@param NxPad an int with the number of columns of the padded image
+@param r2cmode an int with a flag for whether out holds the output of a real-to-complex FFT
+@param single an int with a flag for single precision arrays
+@param *win a pointer to the window of the u-v grid to be stored
+@param fluxXCent a double with the x-coordinate (in grid points) of the center for the phases
+@param fluxYCent a double with the y-coordinate (in grid points) of the center for the phases
+@param omode an int with the quantities to be stored (0: amp,phase, 1: re,im, 2: amp, 3: power)
+@param *Va on return, a pointer to the array with the visibility amplitudes (or real parts, or power)
+@param *Vp on return, a pointer to the array with the visibility phases (in rad; or imaginary parts)
+@param *zeroBaselineAmp on return, a double with the zero baseline amplitude
+
+\return Returns zero if successful, 1 if not
+
+*/
+int fftToVis(void *out, int NyPad, int NxPad, int r2cmode, int single, image2uvWindow *win,
+	     double fluxXCent, double fluxYCent, int omode, void *Va, void *Vp, double *zeroBaselineAmp)
+{
+  int indexR,indexC;                                // dummy indices for counting rows and columns
+  long index;                                       // index of the element of the FFT array
+  long indexTo;                                     // index of the element of the output arrays
+  int NxOut=win->NxOut, NyOut=win->NyOut;           // number of columns and rows of the output arrays
+  int NxFFT=(win->NxHeld>0 ? win->NxHeld : r2cmode ? NxPad/2+1 : NxPad); // number of columns of the FFT array
+  int ku,kv;                                        // u- and v- index of a visibility
+  int *colFrom,*rowFrom,*rowFromConj;               // tables of the columns and rows to transpose from
+  double *rotU,*rotV;                               // tables of the phase rotations along each axis
+  double re,im;                                     // real and imaginary part of a visibility
+  double rotRe,rotIm;                               // real and imaginary part of the phase rotation
+  double amp,phase;                                 // quantities stored in Va and Vp
+  double *outD=(double *)out;                       // the FFT array, in double precision
+  float *outF=(float *)out;                         // the FFT array, in single precision
+
+  // first keep the zero baseline amplitude, which is given with the window if the
+  // array does not start with the point of the zero baseline
+  double zeroAmp=(win->rowOffset>0 || win->colOffset>0 ? win->zeroBaselineAmp :
+		  single ? sqrt((double)outF[0]*outF[0]+(double)outF[1]*outF[1]) :
+		  sqrt(outD[0]*outD[0]+outD[1]*outD[1]));
+  *zeroBaselineAmp=zeroAmp;
+
+  colFrom=(int *)malloc(sizeof(int)*NxOut);
+  rowFrom=(int *)malloc(sizeof(int)*NyOut);
+  rowFromConj=(int *)malloc(sizeof(int)*NyOut);
+  rotU=(double *)malloc(sizeof(double)*2*NxOut);
+  rotV=(double *)malloc(sizeof(double)*2*NyOut);
+  if (colFrom==NULL || rowFrom==NULL || rowFromConj==NULL || rotU==NULL || rotV==NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");
+      free(colFrom);
+      free(rowFrom);
+      free(rowFromConj);
+      free(rotU);
+      free(rotV);
+      return 1;
+    }
   
-  // go through all rows
-  for (indexR=1;indexR<=NyPad;indexR++)
+  transposeTables(NyPad,NxPad,r2cmode,win,colFrom,rowFrom,rowFromConj);
+  
+  // the phase rotations exp(2 pi i (xc-1) ku/NxPad) and exp(2 pi i (yc-1) kv/NyPad)
+  // that move the phase center to the point (fluxXCent,fluxYCent); the amplitudes
+  // do not depend on the phase center
+  if (omode<=1)
+    {
+      for (indexC=0;indexC<NxOut;indexC++)
+	{
+	  ku=win->ku0+indexC;
+	  rotU[2*indexC]=cos(2.*M_PI*(fluxXCent-1)*ku/NxPad);
+	  rotU[2*indexC+1]=sin(2.*M_PI*(fluxXCent-1)*ku/NxPad);
+	}
+      for (indexR=0;indexR<NyOut;indexR++)
+	{
+	  kv=win->kv0+indexR;
+	  rotV[2*indexR]=cos(2.*M_PI*(fluxYCent-1)*kv/NyPad);
+	  rotV[2*indexR+1]=sin(2.*M_PI*(fluxYCent-1)*kv/NyPad);
+	}
+    }
+  
+  // go through all rows; each row is independent of the others, so the rows
+  // are shared among the threads
+#pragma omp parallel for private(indexC,index,indexTo,re,im,rotRe,rotIm,amp,phase) schedule(static)
+  for (indexR=0;indexR<NyOut;indexR++)
     {
       // and all columns
-      for (indexC=1;indexC<=NxPad;indexC++)
+      for (indexC=0;indexC<NxOut;indexC++)
 	{
-	  // transpose the array to have it centered
-	  if (indexR<=NyPad/2 && indexC<=NxPad/2)
-	    {
-	      index=indexArr(indexR+NyPad/2,indexC+NxPad/2,NyPad,NxPad);
-	    }
-	  if (indexR<=NyPad/2 && indexC>NxPad/2)
+	  if (colFrom[indexC]>=0)
+	    index=(long)rowFrom[indexR]*NxFFT+colFrom[indexC];
+	  else    // the r2c transform has only u>=0; use V(-u,-v)=V*(u,v)
+	    index=(long)rowFromConj[indexR]*NxFFT-colFrom[indexC]-1;
+	  re=(single ? outF[2*index] : outD[2*index]);
+	  im=(single ? outF[2*index+1] : outD[2*index+1]);
+	  if (colFrom[indexC]<0)
+	    im=-im;
+	  
+	  // the index of the folded array
+	  indexTo=(long)indexR*NxOut+indexC;
+
+	  if (omode==3)          // only the power
 	    {
-	      index=indexArr(indexR+NyPad/2,indexC-NxPad/2,NyPad,NxPad);
+	      amp=re*re+im*im;
+	      phase=0.0;
 	    }
-	  if (indexR>NyPad/2 && indexC<=NxPad/2)
+	  else if (omode==2)     // only the amplitude
 	    {
-	      index=indexArr(indexR-NyPad/2,indexC+NxPad/2,NyPad,NxPad);
+	      amp=sqrt(re*re+im*im);
+	      phase=0.0;
 	    }
-	  if (indexR>NyPad/2 && indexC>NxPad/2)
+	  else
 	    {
-	      index=indexArr(indexR-NyPad/2,indexC-NxPad/2,NyPad,NxPad);
+	      // the product of the rotations along u and v, which adds to the phase the 
+	      // displacement to the appropriate center
+	      rotRe=rotU[2*indexC]*rotV[2*indexR]-rotU[2*indexC+1]*rotV[2*indexR+1];
+	      rotIm=rotU[2*indexC]*rotV[2*indexR+1]+rotU[2*indexC+1]*rotV[2*indexR];
+	      
+	      if (omode==1)      // the real and imaginary parts of the rotated visibility
+		{
+		  amp=re*rotRe-im*rotIm;
+		  phase=re*rotIm+im*rotRe;
+		}
+	      else
+		{
+		  amp=sqrt(re*re+im*im);
+
+		  // if the amplitude is too small, set the phase to zero
+		  if (zeroAmp!=0 && fabs(amp/zeroAmp)<MINAMP)
+		    phase=0.0;
+		  else     // otherwise calculate it
+		    phase=atan2(re*rotIm+im*rotRe,re*rotRe-im*rotIm);
+		}
 	    }
-	  // now calculate the index of the folded array
-	  int indexTo=indexArr(indexR,indexC,NyPad,NxPad);
 
 	  // and store it in the appropriate place in the Amplitude and Phase arrays
-	  Va[indexTo]=sqrt(out[index][0]*out[index][0]+out[index][1]*out[index][1]);
-
-	  // if the amplitude is too small, set the phase to zero
-	  if (zeroBaselineAmp!=0 && fabs(Va[indexTo]/zeroBaselineAmp)<MINAMP)
+	  if (single)
 	    {
-	      Vp[indexTo]=0.0;
-	    }   
-	  else     // otherwise calculate it
+	      ((float *)Va)[indexTo]=amp;
+	      if (omode<=1)
+		((float *)Vp)[indexTo]=phase;
+	    }
+	  else
 	    {
-	      Vp[indexTo]=atan2(out[index][1],out[index][0]);
-	      
-	      // make sure you add to the phase the displacement to the appropriate center
-	      double addPhase=Vp[indexTo]+2.*M_PI*(fluxXCent-1)*(indexC-1-NxPad/2)/NxPad
-		+2.*M_PI*(fluxYCent-1)*(indexR-1-NyPad/2)/NyPad;
-	      Vp[indexTo]=atan2(sin(addPhase),cos(addPhase));
+	      ((double *)Va)[indexTo]=amp;
+	      if (omode<=1)
+		((double *)Vp)[indexTo]=phase;
 	    }
 	  // *** Debugging only
-	  //	  printf ("%d %d %e %e\n",indexR,indexC,Va[indexTo],Vp[indexTo]);
+	  //	  printf ("%d %d %e %e\n",indexR,indexC,amp,phase);
 	}      
     }
 
-  // calculate scale of pixels in u-v plane (the scales in the image are in degrees, so they need also
-  // to be converted to rad.
-  uScale=180.0/(NxPad*xScale*M_PI);
-  vScale=180.0/(NyPad*yScale*M_PI);
-  
-  // create a history string to include in the FITS output
-  strcpy(hist,"Created from Image in File: ");
-  strcat(hist,inFileName);
+  free(colFrom);
+  free(rowFrom);
+  free(rowFromConj);
+  free(rotU);
+  free(rotV);
   
-  int writeflag=writeFITSVis(outFileName,NyPad,NxPad, Vp, Va, vScale,uScale,hist);
+  return 0;
+}
 
-  // free the allocated memory
-  fftw_free(in);
-  fftw_free(out);
-  free(ImageIn);
-  free(Va);
-  free(Vp);
+/*!
+\brief Converts the FFTs of the Stokes I, Q, and U images to the fractional polarization m-breve and the EVPA
+
+\details
+Takes the complex Fourier transforms of the padded NyPad by NxPad Stokes
+I, Q, and U images, as returned by FFTW, and calculates on the window win
+of the u-v grid the fractional polarization in the visibility domain
+\f[
+\breve{m}(u,v)=\frac{\tilde{Q}(u,v)+i\tilde{U}(u,v)}{\tilde{I}(u,v)}
+\f]
+and the electric vector position angle EVPA=arg(m-breve)/2 (in rad). The
+transposition and the Hermitian symmetry of the r2c transforms are as in
+fftToVis(). The shift of the phase center multiplies the three
+visibilities by the same rotation, which cancels in the ratio, so it is
+not applied.
+
+In order to avoid numerical issues, when the amplitude of the Stokes I 
+visibility is smaller than a predefined fraction (MINAMP) of its zero
+baseline amplitude, m-breve and the EVPA are set to zero.
+
+If omode is 1 (re,im), the real and imaginary parts of m-breve are stored
+in Mre and Mim; otherwise its amplitude (or, if omode is 3, its square) 
+is stored in Mre and Mim is not used.
+
+If single is set, the FFT arrays are fftwf_complex arrays and Mre, Mim, and
+Evpa are float arrays; the ratio is still calculated in double precision.
+
+\version 1.0
+
+\pre It is called from transformGroup()
+
+@param *outI a pointer to the complex FFT of the Stokes I image
+@param *outQ a pointer to the complex FFT of the Stokes Q image
+@param *outU a pointer to the complex FFT of the Stokes U image
+@param NyPad an int with the number of rows of the padded image
+@param NxPad an int with the number of columns of the padded image
+@param r2cmode an int with a flag for whether the arrays hold the output of real-to-complex FFTs
+@param single an int with a flag for single precision arrays
+@param *win a pointer to the window of the u-v grid to be stored
+@param omode an int with the quantities to be stored (1: re,im; otherwise amplitude)
+@param *Mre on return, a pointer to the array with the amplitudes (or real parts) of m-breve
+@param *Mim on return, a pointer to the array with the imaginary parts of m-breve (not used unless omode is 1)
+@param *Evpa on return, a pointer to the array with the EVPA (in rad)
+
+\return Returns zero if successful, 1 if not
+
+*/
+int fftToPol(void *outI, void *outQ, void *outU, int NyPad, int NxPad, int r2cmode, int single,
+	     image2uvWindow *win, int omode, void *Mre, void *Mim, void *Evpa)
+{
+  int indexR,indexC;                                // dummy indices for counting rows and columns
+  long index;                                       // index of the element of the FFT arrays
+  long indexTo;                                     // index of the element of the output arrays
+  int NxOut=win->NxOut, NyOut=win->NyOut;           // number of columns and rows of the output arrays
+  int NxFFT=(r2cmode ? NxPad/2+1 : NxPad);          // number of columns of the FFT arrays
+  int *colFrom,*rowFrom,*rowFromConj;               // tables of the columns and rows to transpose from
+  double conj;                                      // sign of the imaginary parts (-1 for V(-u,-v))
+  double iRe,iIm,qRe,qIm,uRe,uIm;                   // the Stokes I, Q, and U visibilities
+  double pRe,pIm;                                   // the polarized visibility Q+iU
+  double norm;                                      // squared amplitude of the Stokes I visibility
+  double mRe,mIm,evpa;                              // m-breve and the EVPA
+  double *iD=(double *)outI, *qD=(double *)outQ, *uD=(double *)outU; // the FFT arrays, in double precision
+  float *iF=(float *)outI, *qF=(float *)outQ, *uF=(float *)outU;     // the FFT arrays, in single precision
+
+  // the zero baseline amplitude of Stokes I
+  double zeroBaselineAmp=(single ? sqrt((double)iF[0]*iF[0]+(double)iF[1]*iF[1]) :
+			  sqrt(iD[0]*iD[0]+iD[1]*iD[1]));
 
-  if (writeflag==1)
+  colFrom=(int *)malloc(sizeof(int)*NxOut);
+  rowFrom=(int *)malloc(sizeof(int)*NyOut);
+  rowFromConj=(int *)malloc(sizeof(int)*NyOut);
+  if (colFrom==NULL || rowFrom==NULL || rowFromConj==NULL)
     {
+      printErrorImage2uv("malloc failed!\n");
+      free(colFrom);
+      free(rowFrom);
+      free(rowFromConj);
       return 1;
     }
-  
-  if (vmode!=0)
-    printf("image2uv: Wrote visibility amplitudes and phases to file %s\n",outFileName);
 
-  return 0;                                          // normal return
+  transposeTables(NyPad,NxPad,r2cmode,win,colFrom,rowFrom,rowFromConj);
+
+  // each row is independent of the others, so the rows are shared among the threads
+#pragma omp parallel for private(indexC,index,indexTo,conj,iRe,iIm,qRe,qIm,uRe,uIm,pRe,pIm,norm,mRe,mIm,evpa) schedule(static)
+  for (indexR=0;indexR<NyOut;indexR++)
+    {
+      for (indexC=0;indexC<NxOut;indexC++)
+	{
+	  if (colFrom[indexC]>=0)
+	    {
+	      index=(long)rowFrom[indexR]*NxFFT+colFrom[indexC];
+	      conj=1.0;
+	    }
+	  else    // the r2c transform has only u>=0; use V(-u,-v)=V*(u,v)
+	    {
+	      index=(long)rowFromConj[indexR]*NxFFT-colFrom[indexC]-1;
+	      conj=-1.0;
+	    }
+	  iRe=(single ? iF[2*index] : iD[2*index]);
+	  iIm=conj*(single ? iF[2*index+1] : iD[2*index+1]);
+	  qRe=(single ? qF[2*index] : qD[2*index]);
+	  qIm=conj*(single ? qF[2*index+1] : qD[2*index+1]);
+	  uRe=(single ? uF[2*index] : uD[2*index]);
+	  uIm=conj*(single ? uF[2*index+1] : uD[2*index+1]);
+
+	  indexTo=(long)indexR*NxOut+indexC;
+
+	  // if the Stokes I visibility is too small, set m-breve to zero
+	  norm=iRe*iRe+iIm*iIm;
+	  if (norm==0.0 || sqrt(norm)<MINAMP*zeroBaselineAmp)
+	    {
+	      mRe=0.0;
+	      mIm=0.0;
+	      evpa=0.0;
+	    }
+	  else
+	    {
+	      // Q+iU, with Q and U complex
+	      pRe=qRe-uIm;
+	      pIm=qIm+uRe;
+	      // (Q+iU)/I
+	      mRe=(pRe*iRe+pIm*iIm)/norm;
+	      mIm=(pIm*iRe-pRe*iIm)/norm;
+	      evpa=0.5*atan2(mIm,mRe);
+	    }
+
+	  if (omode==3)
+	    mRe=mRe*mRe+mIm*mIm;
+	  else if (omode!=1)
+	    mRe=sqrt(mRe*mRe+mIm*mIm);
+
+	  if (single)
+	    {
+	      ((float *)Mre)[indexTo]=mRe;
+	      if (omode==1)
+		((float *)Mim)[indexTo]=mIm;
+	      ((float *)Evpa)[indexTo]=evpa;
+	    }
+	  else
+	    {
+	      ((double *)Mre)[indexTo]=mRe;
+	      if (omode==1)
+		((double *)Mim)[indexTo]=mIm;
+	      ((double *)Evpa)[indexTo]=evpa;
+	    }
+	}
+    }
+
+  free(colFrom);
+  free(rowFrom);
+  free(rowFromConj);
+
+  return 0;
+}
+
+/*!
+\brief Makes the FFTW plan for the transforms of some rows of a batch of padded images
+
+\details
+Makes a plan for the 1D transforms of the Nrows rows, starting from row 
+rowStart, of each of howmany padded images of size NyPad by NxPad, stored 
+one after the other in the input array, into the same rows of the output
+array. It is used for the pruned transforms of planFFT().
+
+If the real-to-complex transform is in place (inReal is out), each row of
+the input is padded to 2*(NxPad/2+1) elements, as FFTW requires, so that
+the output of each row overwrites its input.
+
+\version 1.0
+
+\pre It is called from planFFT()
+
+@param *opt a pointer to the options
+@param NyPad an int with the number of rows of the padded image
+@param NxPad an int with the number of columns of the padded image
+@param howmany an int with the number of images
+@param rowStart an int with the first row (starting from 0) to be transformed
+@param Nrows an int with the number of rows to be transformed
+@param *inReal a pointer to the real input array (r2c; double or float)
+@param *in a pointer to the complex input array (c2c; fftw_complex or fftwf_complex)
+@param *out a pointer to the output array (fftw_complex or fftwf_complex)
+@param *plan on return, a pointer to the plan in double precision (NULL with -f 32)
+@param *planf on return, a pointer to the plan in single precision (NULL with -f 64)
+
+\return nothing
+
+*/
+void planRowFFT(image2uvOptions *opt, int NyPad, int NxPad, int howmany, int rowStart, int Nrows,
+		void *inReal, void *in, void *out, fftw_plan *plan, fftwf_plan *planf)
+{
+  int NxFFT=(opt->tmode==0 ? NxPad/2+1 : NxPad);    // number of columns of each transform
+  long inRow=(opt->tmode==0 && inReal==out ? 2*NxFFT : NxPad); // number of elements between the rows of the input
+  fftw_iodim64 dim, howmanyDims[2];                 // dimensions of the 1D transforms
+
+  dim.n=NxPad;
+  dim.is=1;
+  dim.os=1;
+  howmanyDims[0].n=howmany;
+  howmanyDims[0].is=NyPad*inRow;
+  howmanyDims[0].os=(long)NyPad*NxFFT;
+  howmanyDims[1].n=Nrows;
+  howmanyDims[1].is=inRow;
+  howmanyDims[1].os=NxFFT;
+
+  *plan=NULL;
+  *planf=NULL;
+  if (opt->single && opt->tmode==0)
+    *planf=fftwf_plan_guru64_dft_r2c(1, &dim, 2, howmanyDims, (float *)inReal+rowStart*inRow,
+				     (fftwf_complex *)out+(long)rowStart*NxFFT, opt->planFlags);
+  else if (opt->single)
+    *planf=fftwf_plan_guru64_dft(1, &dim, 2, howmanyDims, (fftwf_complex *)in+(long)rowStart*NxPad,
+				 (fftwf_complex *)out+(long)rowStart*NxFFT, FFTW_FORWARD, opt->planFlags);
+  else if (opt->tmode==0)
+    *plan=fftw_plan_guru64_dft_r2c(1, &dim, 2, howmanyDims, (double *)inReal+rowStart*inRow,
+				   (fftw_complex *)out+(long)rowStart*NxFFT, opt->planFlags);
+  else
+    *plan=fftw_plan_guru64_dft(1, &dim, 2, howmanyDims, (fftw_complex *)in+(long)rowStart*NxPad,
+			       (fftw_complex *)out+(long)rowStart*NxFFT, FFTW_FORWARD, opt->planFlags);
+
+  return;
+}
+
+/*!
+\brief Makes the FFTW plans for a batch of padded images
+
+\details
+Makes a plan for the 2D Fourier transform of howmany padded images of size
+NyPad by NxPad, stored one after the other in the input array. For a
+real-to-complex transform (tmode=0) the input is the real array inReal and
+each transform in out has NyPad by (NxPad/2+1) points; for a complex-to-complex
+transform (tmode=1) the input is the complex array in and each transform 
+in out has NyPad by NxPad points.
+
+If the images only fill the Nrows rows of the padded images starting at row
+rowStart, or if only the central columns of the output with |u-index|<=Ku are 
+needed (Ku<0 if all the columns are needed), the 2D transform is pruned: it is
+split into the 1D transforms of the Nrows rows that are not zero, followed by
+the 1D transforms of only the columns of the output that are needed. The rows
+that are all zeros are never transformed, and neither are the columns outside
+the window. For a 160x160 image padded to 4096x4096, this skips more than 95%
+of the transforms of the rows.
+
+If blockRows is positive, the transform is always split in this way, and the
+transforms of the rows are planned for blocks of blockRows rows (and for the
+last block, if it has fewer rows), so that each block can be transformed as 
+soon as it is read (see executeFFTBlock()). The blocks start a multiple of 
+blockRows rows apart, which is a multiple of 4, so all the full blocks have 
+the alignment of the first one and share its plan.
+
+The transform is in place if the output array is also the input array (in
+the low-memory mode). An in-place real-to-complex transform, with the rows 
+of the input padded to 2*(NxPad/2+1) elements (see planRowFFT()), is 
+always split in this way too.
+
+The wisdom for this transform is imported from the wisdom store before 
+planning and, if the plan was not made with a heuristic, exported back to 
+it, so that it is reused by later runs.
+
+Planning with FFTW_MEASURE or FFTW_PATIENT overwrites the arrays, so the
+plan needs to be made before the input array is filled.
+
+With the -f 32 option, the arrays are in single precision and the plans are
+made with the fftwf routines instead.
+
+\version 1.0
+
+\pre It is called from transformGroup(), lowMemoryGroup(), and movieGroup()
+
+@param *opt a pointer to the options
+@param NyPad an int with the number of rows of the padded image
+@param NxPad an int with the number of columns of the padded image
+@param howmany an int with the number of images transformed with the plan
+@param rowStart an int with the first row (starting from 0) of the image in the padded image
+@param Nrows an int with the number of rows of the image
+@param Ku an int with the largest |u-index| of the columns of the output that are needed (<0 for all)
+@param blockRows an int with the number of rows per block of the pipelined transforms of the rows (0: not pipelined; howmany needs to be 1 otherwise)
+@param *inReal a pointer to the real input array (r2c; double or float)
+@param *in a pointer to the complex input array (c2c; fftw_complex or fftwf_complex)
+@param *out a pointer to the output array (fftw_complex or fftwf_complex)
+@param *plan on return, a pointer to the FFTW plans
+
+\return Returns zero if successful, 1 if planning failed
+
+*/
+int planFFT(image2uvOptions *opt, int NyPad, int NxPad, int howmany, int rowStart, int Nrows, int Ku,
+	    int blockRows, void *inReal, void *in, void *out, image2uvFFTPlan *plan)
+{
+  int NxFFT=(opt->tmode==0 ? NxPad/2+1 : NxPad);    // number of columns of each transform
+  int Ncols[2]={0,0};                               // number of columns in each block of needed columns
+  int colStart[2]={0,0};                            // first column of each block of needed columns
+  int iBlock;                                       // dummy index for counting blocks of columns
+  int Nblock;                                       // number of rows of a full block of rows, if pipelined
+  int wisdomKey;                                    // type of transform for the wisdom store
+  fftw_iodim64 dims[2];                             // dimensions of the 2D transforms of the full plan
+  fftw_iodim64 dim, howmanyDims[2];                 // dimensions of the 1D transforms of the pruned plan
+
+  plan->rowStart=rowStart;
+  plan->Nrows=Nrows;
+  plan->single=opt->single;
+  plan->full=NULL;
+  plan->rows=NULL;
+  plan->cols[0]=NULL;
+  plan->cols[1]=NULL;
+  plan->fullf=NULL;
+  plan->rowsf=NULL;
+  plan->colsf[0]=NULL;
+  plan->colsf[1]=NULL;
+  plan->block[0]=NULL;
+  plan->block[1]=NULL;
+  plan->blockf[0]=NULL;
+  plan->blockf[1]=NULL;
+  plan->blockRows=(blockRows>0 ? blockRows : 0);
+
+  // the blocks of columns of the output that are needed; with a real-to-complex
+  // transform, the columns with u<0 are obtained from those with u>0
+  if (Ku<0 || (opt->tmode==0 && Ku>=NxFFT-1) || (opt->tmode==1 && 2*Ku+1>=NxPad))
+    Ncols[0]=NxFFT;
+  else
+    {
+      Ncols[0]=Ku+1;
+      if (opt->tmode==1 && !opt->hmode)
+	{
+	  colStart[1]=NxPad-Ku;
+	  Ncols[1]=Ku;
+	}
+    }
+  plan->pruned=(Nrows<NyPad || Ncols[0]<NxFFT || blockRows>0 || (opt->tmode==0 && inReal==out));
+
+  // use any plans for this transform that were stored by earlier runs
+  wisdomKey=opt->tmode+(plan->pruned ? 3 : 0);
+  importWisdom(opt->wisdomDir,wisdomKey,opt->single,NyPad,NxPad,opt->nthreads,howmany,0,opt->vmode);
+
+  if (!plan->pruned)
+    {
+      // the same transforms as fftw_plan_many_dft(), but with 64-bit strides
+      // between the images, which may have more than 2^31 points each
+      dims[0].n=NyPad;
+      dims[0].is=NxPad;
+      dims[0].os=NxFFT;
+      dims[1].n=NxPad;
+      dims[1].is=1;
+      dims[1].os=1;
+      howmanyDims[0].n=howmany;
+      howmanyDims[0].is=(long)NyPad*NxPad;
+      howmanyDims[0].os=(long)NyPad*NxFFT;
+      if (opt->single && opt->tmode==0)  // real-to-complex transform in single precision
+	plan->fullf = fftwf_plan_guru64_dft_r2c(2, dims, 1, howmanyDims, (float *)inReal,
+						(fftwf_complex *)out, opt->planFlags);
+      else if (opt->single)              // complex-to-complex transform in single precision
+	plan->fullf = fftwf_plan_guru64_dft(2, dims, 1, howmanyDims, (fftwf_complex *)in,
+					    (fftwf_complex *)out, FFTW_FORWARD, opt->planFlags);
+      else if (opt->tmode==0)           // real-to-complex transform
+	plan->full = fftw_plan_guru64_dft_r2c(2, dims, 1, howmanyDims, (double *)inReal,
+					      (fftw_complex *)out, opt->planFlags);
+      else                         // complex-to-complex transform
+	plan->full = fftw_plan_guru64_dft(2, dims, 1, howmanyDims, (fftw_complex *)in,
+					  (fftw_complex *)out, FFTW_FORWARD, opt->planFlags);
+      if (plan->full==NULL && plan->fullf==NULL)
+	{
+	  printErrorImage2uv("FFTW planning failed!\n");
+	  return 1;
+	}
+    }
+  else
+    {
+      // the rows of the images that are not zero, in all the images of the batch or,
+      // if pipelined, in a full block and in the last block of rows
+      if (blockRows<=0)
+	planRowFFT(opt,NyPad,NxPad,howmany,rowStart,Nrows,inReal,in,out,&plan->rows,&plan->rowsf);
+      else
+	{
+	  Nblock=(blockRows<Nrows ? blockRows : Nrows);
+	  planRowFFT(opt,NyPad,NxPad,1,rowStart,Nblock,inReal,in,out,plan->block,plan->blockf);
+	  if (Nrows%Nblock!=0)
+	    planRowFFT(opt,NyPad,NxPad,1,rowStart+Nrows-Nrows%Nblock,Nrows%Nblock,inReal,in,out,
+		       plan->block+1,plan->blockf+1);
+	}
+
+      // the columns that are needed, in place, in all the images of the batch
+      dim.n=NyPad;
+      dim.is=NxFFT;
+      dim.os=NxFFT;
+      howmanyDims[0].n=howmany;
+      howmanyDims[0].is=(long)NyPad*NxFFT;
+      howmanyDims[0].os=(long)NyPad*NxFFT;
+      howmanyDims[1].is=1;
+      howmanyDims[1].os=1;
+      for (iBlock=0;iBlock<2;iBlock++)
+	if (Ncols[iBlock]>0)
+	  {
+	    howmanyDims[1].n=Ncols[iBlock];
+	    if (opt->single)
+	      plan->colsf[iBlock]=fftwf_plan_guru64_dft(1, &dim, 2, howmanyDims, (fftwf_complex *)out+colStart[iBlock],
+							(fftwf_complex *)out+colStart[iBlock], FFTW_FORWARD, opt->planFlags);
+	    else
+	      plan->cols[iBlock]=fftw_plan_guru64_dft(1, &dim, 2, howmanyDims, (fftw_complex *)out+colStart[iBlock],
+						      (fftw_complex *)out+colStart[iBlock], FFTW_FORWARD, opt->planFlags);
+	  }
+      
+      if (opt->single && ((plan->rowsf==NULL && plan->blockf[0]==NULL) || plan->colsf[0]==NULL ||
+			  (Ncols[1]>0 && plan->colsf[1]==NULL)))
+	{
+	  printErrorImage2uv("FFTW planning failed!\n");
+	  return 1;
+	}
+      if (!opt->single && ((plan->rows==NULL && plan->block[0]==NULL) || plan->cols[0]==NULL ||
+			   (Ncols[1]>0 && plan->cols[1]==NULL)))
+	{
+	  printErrorImage2uv("FFTW planning failed!\n");
+	  return 1;
+	}
+    }
+  
+  // store the plan for later runs; plans made with a heuristic are not worth storing
+  if (!(opt->planFlags & FFTW_ESTIMATE))
+    exportWisdom(opt->wisdomDir,wisdomKey,opt->single,NyPad,NxPad,opt->nthreads,howmany,0,opt->vmode);
+
+  return 0;
+}
+
+/*!
+\brief Executes the FFTW plans for the columns of a pruned transform
+
+\details
+The rows of the output that are outside the image are set to zero first,
+since the transforms of the columns of the previous batch were done in
+place. The transforms of the rows need to have been executed, with
+executeFFT() or, if pipelined, with executeFFTBlock() for all the blocks.
+
+\version 1.0
+
+\pre It is called from executeFFT() and transformGroup()
+
+@param *plan a pointer to the FFTW plans made by planFFT()
+@param howmany an int with the number of images transformed with the plan
+@param NyPad an int with the number of rows of the padded image
+@param NxFFT an int with the number of columns of each transform
+@param *out a pointer to the output array (fftw_complex or fftwf_complex)
+
+\return nothing
+
+*/
+void executeFFTCols(image2uvFFTPlan *plan, int howmany, int NyPad, int NxFFT, void *out)
+{
+  int k;                                            // dummy index for counting images
+  int rowEnd=plan->rowStart+plan->Nrows;            // first row after the image
+  size_t complexSize=(plan->single ? sizeof(fftwf_complex) : sizeof(fftw_complex)); // size of the output elements
+  char *image;                                      // first byte of the output of an image
+
+  for (k=0;k<howmany;k++)
+    {
+      image=(char *)out+complexSize*k*NyPad*NxFFT;
+      memset(image,0,complexSize*plan->rowStart*NxFFT);
+      memset(image+complexSize*rowEnd*NxFFT,0,complexSize*(NyPad-rowEnd)*NxFFT);
+    }
+
+  if (plan->single)
+    {
+      if (plan->colsf[0]!=NULL)
+	fftwf_execute(plan->colsf[0]);
+      if (plan->colsf[1]!=NULL)
+	fftwf_execute(plan->colsf[1]);
+      return;
+    }
+
+  if (plan->cols[0]!=NULL)
+    fftw_execute(plan->cols[0]);
+  if (plan->cols[1]!=NULL)
+    fftw_execute(plan->cols[1]);
+
+  return;
+}
+
+/*!
+\brief Executes the FFTW plans for a batch of padded images
+
+\details
+For a pruned transform, the rows of the image are transformed first and 
+then the columns that are needed (see executeFFTCols()).
+
+\version 1.0
+
+\pre It is called from transformGroup()
+
+@param *plan a pointer to the FFTW plans made by planFFT()
+@param howmany an int with the number of images transformed with the plan
+@param NyPad an int with the number of rows of the padded image
+@param NxFFT an int with the number of columns of each transform
+@param *out a pointer to the output array (fftw_complex or fftwf_complex)
+
+\return nothing
+
+*/
+void executeFFT(image2uvFFTPlan *plan, int howmany, int NyPad, int NxFFT, void *out)
+{
+  if (!plan->pruned)
+    {
+      if (plan->single)
+	fftwf_execute(plan->fullf);
+      else
+	fftw_execute(plan->full);
+      return;
+    }
+
+  if (plan->single)
+    fftwf_execute(plan->rowsf);
+  else
+    fftw_execute(plan->rows);
+
+  executeFFTCols(plan,howmany,NyPad,NxFFT,out);
+
+  return;
+}
+
+/*!
+\brief Executes the FFTW plan for a block of rows of a pipelined transform
+
+\details
+Transforms the rows of the block iBlock (starting from 0) of the image, i.e.,
+the rows from rowStart+iBlock*blockRows of the padded image, with the plans
+made by planFFT() with blockRows>0. The full blocks share the plan of the
+first block, which is executed on the rows of each block with the new-array
+execute functions of FFTW; the last block, if it has fewer rows, has its own
+plan.
+
+\version 1.0
+
+\pre It is called from transformGroup()
+
+@param *plan a pointer to the FFTW plans made by planFFT()
+@param iBlock an int with the block of rows
+@param NxPad an int with the number of columns of the padded image
+@param NxFFT an int with the number of columns of each transform
+@param *inReal a pointer to the real input array (r2c; NULL for c2c)
+@param *in a pointer to the complex input array (c2c; NULL for r2c)
+@param *out a pointer to the output array (fftw_complex or fftwf_complex)
+
+\return nothing
+
+*/
+void executeFFTBlock(image2uvFFTPlan *plan, int iBlock, int NxPad, int NxFFT, void *inReal, void *in, void *out)
+{
+  long row=plan->rowStart+(long)iBlock*plan->blockRows; // first row of the block
+
+  // the last block, with fewer rows
+  if (row+plan->blockRows>plan->rowStart+plan->Nrows && (plan->block[1]!=NULL || plan->blockf[1]!=NULL))
+    {
+      if (plan->single)
+	fftwf_execute(plan->blockf[1]);
+      else
+	fftw_execute(plan->block[1]);
+      return;
+    }
+
+  if (plan->single && inReal!=NULL)
+    fftwf_execute_dft_r2c(plan->blockf[0],(float *)inReal+row*NxPad,(fftwf_complex *)out+row*NxFFT);
+  else if (plan->single)
+    fftwf_execute_dft(plan->blockf[0],(fftwf_complex *)in+row*NxPad,(fftwf_complex *)out+row*NxFFT);
+  else if (inReal!=NULL)
+    fftw_execute_dft_r2c(plan->block[0],(double *)inReal+row*NxPad,(fftw_complex *)out+row*NxFFT);
+  else
+    fftw_execute_dft(plan->block[0],(fftw_complex *)in+row*NxPad,(fftw_complex *)out+row*NxFFT);
+
+  return;
+}
+
+/*!
+\brief Destroys the FFTW plans for a batch of padded images
+
+\version 1.0
+
+\pre It is called from transformGroup()
+
+@param *plan a pointer to the FFTW plans made by planFFT()
+
+\return nothing
+
+*/
+void destroyFFT(image2uvFFTPlan *plan)
+{
+  int k;                                            // dummy index for counting plans
+
+  if (plan->full!=NULL)
+    fftw_destroy_plan(plan->full);
+  if (plan->rows!=NULL)
+    fftw_destroy_plan(plan->rows);
+  if (plan->cols[0]!=NULL)
+    fftw_destroy_plan(plan->cols[0]);
+  if (plan->cols[1]!=NULL)
+    fftw_destroy_plan(plan->cols[1]);
+  if (plan->fullf!=NULL)
+    fftwf_destroy_plan(plan->fullf);
+  if (plan->rowsf!=NULL)
+    fftwf_destroy_plan(plan->rowsf);
+  if (plan->colsf[0]!=NULL)
+    fftwf_destroy_plan(plan->colsf[0]);
+  if (plan->colsf[1]!=NULL)
+    fftwf_destroy_plan(plan->colsf[1]);
+  for (k=0;k<2;k++)
+    {
+      if (plan->block[k]!=NULL)
+	fftw_destroy_plan(plan->block[k]);
+      if (plan->blockf[k]!=NULL)
+	fftwf_destroy_plan(plan->blockf[k]);
+    }
+
+  return;
+}
+
+/*!
+\brief Adds a number to a compensated sum
+
+\details
+Adds value to the sum with the compensated (Kahan-Babuska-Neumaier)
+summation algorithm: the low-order bits that are lost when adding value
+to *sum are accumulated in *comp, and the result of the summation is
+*sum+*comp. The error of the result does not grow with the number of
+terms, which matters when the flux of millions of pixels is added up.
+
+\version 1.0
+
+\pre It is called from fillFFTInput()
+
+@param value a double with the number to be added
+@param *sum a pointer to the sum
+@param *comp a pointer to the compensation of the sum
+
+\return nothing
+
+*/
+void compensatedAdd(double value, double *sum, double *comp)
+{
+  double newSum=*sum+value;                         // new value of the sum
+
+  if (fabs(*sum)>=fabs(value))
+    *comp+=(*sum-newSum)+value;
+  else
+    *comp+=(value-newSum)+*sum;
+  *sum=newSum;
+
+  return;
+}
+
+/*!
+\brief Fills the input array of the FFT and finds the brightness center of the image
+
+\details
+Copies the padded image to the input array of the FFT, which is the real 
+array inReal for a real-to-complex transform or the complex array in (with
+no imaginary part) for a complex-to-complex transform. In the meantime, it
+adds up the total flux and the first moments of the brightness of the image.
+If the image was read straight into the input array (ImageIn is inReal or
+in, see readFFTInput()), nothing is copied and only the sums are found.
+
+The rows are shared among the threads. Each row is added up on its own and
+the row sums are then added up in order of row, so that the results are 
+the same for any number of threads. All the sums are in double precision
+and compensated (see compensatedAdd()), also when the image and the input
+array are in single precision.
+
+\version 1.0
+
+\pre It is called from transformGroup() and sampleGroup()
+
+@param *ImageIn a pointer to the padded image (or to inReal or in, if the image is already in the input array)
+@param NyPad an int with the number of rows of the padded image
+@param NxPad an int with the number of columns of the padded image
+@param single an int with a flag for whether ImageIn, inReal and in are in single precision (float and fftwf_complex)
+@param *inReal a pointer to the real input array (NULL if not used)
+@param *in a pointer to the complex input array (NULL if not used; if both are NULL, only the brightness center is found)
+@param *fluxXCent on return, a double with the flux-weighted sum of the x-coordinates
+@param *fluxYCent on return, a double with the flux-weighted sum of the y-coordinates
+
+\return Returns the total flux in the image, or NaN if the row sums could not be allocated
+
+*/
+double fillFFTInput(void *ImageIn, int NyPad, int NxPad, int single, void *inReal, void *in,
+		    double *fluxXCent, double *fluxYCent)
+{
+  int indexR,indexC;                                // dummy indices for counting rows and columns
+  long index;                                       // index of the element of the arrays
+  double pixel;                                     // brightness of a pixel
+  double fluxTotal=0.0;                             // total flux in the image (arb units)
+  double compTotal=0.0,compX=0.0,compY=0.0;         // compensations of the sums over the rows
+  double rowFlux,rowXCent;                          // sums along a row
+  double compFlux,compXCent;                        // compensations of the sums along a row
+  double *rowSums;                                  // flux and moments of each row
+
+  *fluxXCent=0.0;
+  *fluxYCent=0.0;
+
+  rowSums=(double *)malloc(sizeof(double)*2*NyPad);
+  if (rowSums==NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");
+      return NAN;
+    }
+  
+#pragma omp parallel for private(indexC,index,pixel,rowFlux,rowXCent,compFlux,compXCent) schedule(static)
+  for (indexR=1;indexR<=NyPad;indexR++)
+    {
+      rowFlux=0.0;
+      rowXCent=0.0;
+      compFlux=0.0;
+      compXCent=0.0;
+      for (indexC=1;indexC<=NxPad;indexC++)
+	{
+	  index=indexArr(indexR,indexC,NxPad);
+	  if (single)
+	    {
+	      pixel=(ImageIn==in ? ((fftwf_complex *)in)[index][0] : ((float *)ImageIn)[index]);
+	      if (inReal!=NULL && inReal!=ImageIn)
+		((float *)inReal)[index]=pixel;
+	      else if (in!=NULL && in!=ImageIn)
+		{
+		  ((fftwf_complex *)in)[index][0]=pixel;
+		  ((fftwf_complex *)in)[index][1]=0.0;  // no imaginary part
+		}
+	    }
+	  else
+	    {
+	      pixel=(ImageIn==in ? ((fftw_complex *)in)[index][0] : ((double *)ImageIn)[index]);
+	      if (inReal!=NULL && inReal!=ImageIn)
+		((double *)inReal)[index]=pixel;
+	      else if (in!=NULL && in!=ImageIn)
+		{
+		  ((fftw_complex *)in)[index][0]=pixel;
+		  ((fftw_complex *)in)[index][1]=0.0;   // no imaginary part
+		}
+	    }
+	  compensatedAdd(indexC*pixel,&rowXCent,&compXCent);   // add to calculate center of brightness
+	  compensatedAdd(pixel,&rowFlux,&compFlux);            // add for total flux in the row
+	}
+      rowSums[2*(indexR-1)]=rowFlux+compFlux;
+      rowSums[2*(indexR-1)+1]=rowXCent+compXCent;
+    }
+
+  // add up the rows in order
+  for (indexR=1;indexR<=NyPad;indexR++)
+    {
+      compensatedAdd(rowSums[2*(indexR-1)],&fluxTotal,&compTotal);          // add for total flux in the image
+      compensatedAdd(rowSums[2*(indexR-1)+1],fluxXCent,&compX);             // add to calculate center of brightness
+      compensatedAdd(indexR*rowSums[2*(indexR-1)],fluxYCent,&compY);        // add to calculate center of brightness
+    }
+  *fluxXCent+=compX;
+  *fluxYCent+=compY;
+
+  free(rowSums);
+  
+  return fluxTotal+compTotal;
+}
+
+/*!
+\brief Spreads a padded image in the FFT buffer to the layout of the input of an in-place transform
+
+\details
+The padded image is read into the FFT buffer grid with the NyPad by NxPad 
+layout of a separate image array. For an in-place real-to-complex transform
+(tmode=0) each row of the input needs to be padded to 2*(NxPad/2+1) elements,
+and for a complex-to-complex transform (tmode=1) each pixel is a complex
+number with no imaginary part, so the Nrows rows of the image, starting
+from row rowStart, are moved in place to their positions in that layout, 
+from the last to the first, so that no pixel is overwritten before it is 
+moved. The rows before the image are then set to zero; the rows after it
+are beyond the image in both layouts, so they are still zero.
+
+\version 1.0
+
+\pre It is called from lowMemoryGroup()
+
+@param *grid a pointer to the FFT buffer, with the padded image (double or float)
+@param NxPad an int with the number of columns of the padded image
+@param rowStart an int with the first row (starting from 0) of the image in the padded image
+@param Nrows an int with the number of rows of the image
+@param tmode an int with the type of transform (0: r2c, 1: c2c)
+@param single an int with a flag for single precision
+
+\return nothing
+
+*/
+void spreadFFTInput(void *grid, int NxPad, int rowStart, int Nrows, int tmode, int single)
+{
+  size_t realSize=(single ? sizeof(float) : sizeof(double)); // size of the real elements of the buffer
+  long inRow=(tmode==0 ? 2*(NxPad/2+1) : 2*NxPad); // number of real elements between the rows of the input
+  long index;                                       // index of a pixel of the padded image
+  int indexR;                                       // dummy index for counting rows
+
+  if (tmode==0)
+    for (indexR=rowStart+Nrows-1;indexR>=rowStart;indexR--)
+      memmove((char *)grid+realSize*indexR*inRow,(char *)grid+realSize*indexR*NxPad,realSize*NxPad);
+  else if (single)
+    for (index=(long)(rowStart+Nrows)*NxPad-1;index>=(long)rowStart*NxPad;index--)
+      {
+	((float *)grid)[2*index]=((float *)grid)[index];
+	((float *)grid)[2*index+1]=0.0;           // no imaginary part
+      }
+  else
+    for (index=(long)(rowStart+Nrows)*NxPad-1;index>=(long)rowStart*NxPad;index--)
+      {
+	((double *)grid)[2*index]=((double *)grid)[index];
+	((double *)grid)[2*index+1]=0.0;          // no imaginary part
+      }
+
+  // the rows before the image
+  memset(grid,0,realSize*rowStart*inRow);
+
+  return;
+}
+
+/*!
+\brief Constructs the output filename for an input image in batch mode
+
+\details
+The output filename is the input filename, without its directory and its
+extension, with the suffix BATCHSUFFIX, in the directory outDir. For example,
+frames/img0001.fits becomes outDir/img0001_uv.fits, or !outDir/img0001_uv.fits
+if an existing output file is to be overwritten (see overwriteFITSName() in io.c)
+
+\version 1.0
+
+\pre It is called from frameOutput()
+
+@param *inFileName a string with the input filename
+@param *outDir a string with the directory of the output files
+@param overwrite an int with a flag for overwriting an existing output file (-F)
+@param *outFileName a string which returns the output filename
+
+\return nothing
+
+*/
+void batchOutFileName(char *inFileName, char *outDir, int overwrite, char *outFileName)
+{
+  char base[MAXPATH];            // input filename without its directory and extension
+  char *ptr;                     // pointer used for finding the directory and the extension
+
+  // remove the directory
+  ptr=strrchr(inFileName,'/');
+  snprintf(base,MAXPATH,"%s",(ptr==NULL ? inFileName : ptr+1));
+
+  // remove any CFITSIO filter and the extension
+  ptr=strchr(base,'[');
+  if (ptr!=NULL)
+    *ptr='\0';
+  ptr=strrchr(base,'.');
+  if (ptr!=NULL && ptr!=base)
+    *ptr='\0';
+
+  snprintf(outFileName,MAXPATH,"%s%s/%s%s",(overwrite ? "!" : ""),outDir,base,BATCHSUFFIX);
+
+  return;
+}
+
+/*!
+\brief Sets the output filename and the history of the output of an image
+
+\details
+The output filename is the one given with -o for a single input image, and
+follows the input filename in batch mode (see batchOutFileName()).
+
+\version 1.0
+
+\pre It is called from the group drivers, e.g., transformGroup(), before each output is written
+
+@param *opt a pointer to the options
+@param *frame a pointer to the input image
+@param *outFileName a string of MAXPATH characters which returns the output filename
+@param *hist a string of MAXPATH characters which returns the history of the output file
+
+\return nothing
+
+*/
+void frameOutput(image2uvOptions *opt, image2uvFrame *frame, char *outFileName, char *hist)
+{
+  // create a history string to include in the FITS output
+  snprintf(hist,MAXPATH,"Created from Image in File: %s",frame->fileName);
+
+  // the output filename follows the input filename in batch mode
+  if (opt->Nin==1)
+    strcpy(outFileName,opt->outFileName);
+  else
+    batchOutFileName(frame->fileName,opt->outDir,opt->overwrite,outFileName);
+
+  return;
+}
+
+/*!
+\brief Sets the HDUs of an output file that is written one block of rows at a time
+
+\details
+The HDUs of the output of createFITSVisMovie(), as set by the -O option:
+the amplitudes and the phases (AMP and PHASE), the real and imaginary 
+parts (VIS, as one complex HDU), the amplitudes (AMP), or the power 
+(POWER). The arrays Va and Vp are those filled by fftToVis().
+
+\version 1.0
+
+\pre It is called from lowMemoryGroup(), outOfCoreGroup(), mpiGroup(), and movieGroup()
+
+@param omode an int with the quantities to be stored (0: amp,phase, 1: re,im, 2: amp, 3: power)
+@param *Va a pointer to the array with the amplitudes (or real parts, or power)
+@param *Vp a pointer to the array with the phases (or imaginary parts; not used for amp or power)
+@param **Vre an array of 2 pointers which returns the arrays of the HDUs
+@param **Vim an array of 2 pointers which returns the arrays of the imaginary parts of the HDUs (or NULL)
+@param *isComplex an array of 2 ints which returns the flags for the complex HDUs
+@param **extname an array of 2 strings which returns the names of the HDUs (or NULL, if they are not named)
+@param **comment an array of 2 strings which returns the descriptions of the HDUs
+
+\return Returns the number of HDUs
+
+*/
+int setOutputHDUs(int omode, void *Va, void *Vp, void **Vre, void **Vim, int *isComplex, char **extname,
+		  char **comment)
+{
+  char *names[2];                                   // names of the HDUs
+  int Nhdu=1;                                       // number of HDUs
+
+  Vre[0]=Va;
+  Vim[0]=NULL;
+  isComplex[0]=0;
+  switch (omode)
+    {
+    case 1:
+      Vim[0]=Vp;
+      isComplex[0]=1;
+      names[0]="VIS";
+      comment[0]="Complex Visibilities";
+      break;
+    case 2:
+      names[0]="AMP";
+      comment[0]="Visibility Amplitudes";
+      break;
+    case 3:
+      names[0]="POWER";
+      comment[0]="Visibility Power";
+      break;
+    default:
+      names[0]="AMP";
+      comment[0]="Visibility Amplitudes";
+      Vre[1]=Vp;
+      Vim[1]=NULL;
+      isComplex[1]=0;
+      names[1]="PHASE";
+      comment[1]="Visibility Phases";
+      Nhdu=2;
+      break;
+    }
+
+  if (extname!=NULL)
+    {
+      extname[0]=names[0];
+      if (Nhdu>1)
+	extname[1]=names[1];
+    }
+
+  return Nhdu;
+}
+
+/*!
+\brief Compares two input images by their padded size
+
+\details
+Used by qsort() to group the input images by padded size, then by size and
+by number of Stokes parameters, keeping the order of the inputs within each group.
+
+\version 1.0
+
+@param *a a pointer to the first image
+@param *b a pointer to the second image
+
+\return Returns a negative, zero, or positive int if the first image comes before, with, or after the second
+
+*/
+int compareFrames(const void *a, const void *b)
+{
+  const image2uvFrame *fa=(const image2uvFrame *)a;
+  const image2uvFrame *fb=(const image2uvFrame *)b;
+
+  if (fa->NyPad!=fb->NyPad)
+    return (fa->NyPad<fb->NyPad ? -1 : 1);
+  if (fa->NxPad!=fb->NxPad)
+    return (fa->NxPad<fb->NxPad ? -1 : 1);
+  if (fa->Ny!=fb->Ny)
+    return (fa->Ny<fb->Ny ? -1 : 1);
+  if (fa->Nx!=fb->Nx)
+    return (fa->Nx<fb->Nx ? -1 : 1);
+  if (fa->Nstokes!=fb->Nstokes)
+    return (fa->Nstokes<fb->Nstokes ? -1 : 1);
+  return fa->order-fb->order;
+}
+
+/*!
+\brief Sets the window of the u-v grid that is written to the output
+
+\details
+The window is the whole u-v grid of the padded image (only the half plane
+with u>=0 with the -H option) or, with the -w option, only its central part
+with |u|<=wmax and |v|<=wmax. It is the whole grid along a direction if
+the grid is not larger than the window along that direction.
+
+\version 1.0
+
+\pre It is called from transformGroup()
+
+@param *opt a pointer to the options
+@param NyPad an int with the number of rows of the padded image
+@param NxPad an int with the number of columns of the padded image
+@param uScale a double with the physical size of the u-v pixels along u (in wavelengths)
+@param vScale a double with the physical size of the u-v pixels along v (in wavelengths)
+@param *win on return, a pointer to the window
+
+\return Returns the largest |u-index| in the window, or -1 if it has all the columns of the grid
+
+*/
+int setWindow(image2uvOptions *opt, int NyPad, int NxPad, double uScale, double vScale, image2uvWindow *win)
+{
+  int Ku=-1,Kv=-1;                                  // largest |u-index| and |v-index| in the window
+
+  // the whole grid
+  win->ku0=(opt->hmode ? 0 : -NxPad/2);
+  win->NxFull=NxPad;
+  win->NxOut=(opt->hmode ? NxPad/2+1 : NxPad);
+  win->kv0=-NyPad/2;
+  win->NyOut=NyPad;
+  win->rowOffset=0;                                 // the whole FFT array is in memory
+  win->colOffset=0;
+  win->NxHeld=0;
+  win->zeroBaselineAmp=0.0;
+
+  if (opt->wmax<=0.0)
+    return -1;
+
+  // only the central part of the grid
+  Ku=(int)floor(opt->wmax/uScale);
+  if (2*Ku+1<NxPad)
+    {
+      win->ku0=(opt->hmode ? 0 : -Ku);
+      win->NxFull=2*Ku+1;
+      win->NxOut=(opt->hmode ? Ku+1 : 2*Ku+1);
+    }
+  else
+    Ku=-1;
+  
+  Kv=(int)floor(opt->wmax/vScale);
+  if (2*Kv+1<NyPad)
+    {
+      win->kv0=-Kv;
+      win->NyOut=2*Kv+1;
+    }
+
+  return Ku;
+}
+
+/*!
+\brief Writes the visibilities of an image in the format set by the -O option
+
+\details
+Writes the visibility amplitudes and phases (with writeFITSVis()), the real
+and imaginary parts (with writeFITSVisComplex()), or only the amplitudes
+or their squares (with writeFITSVisAmp()) on a u-v grid or window, 
+compressed as set by the -C option.
+
+\version 1.0
+
+\pre It is called from transformGroup() and zoomGroup()
+
+@param *opt a pointer to the options
+@param *outFileName a string with the output filename
+@param Ny an int with the number of rows of the u-v grid
+@param Nx an int with the number of columns of the full u-v grid
+@param *Va a pointer to the array with the visibility amplitudes (or real parts, or power)
+@param *Vp a pointer to the array with the visibility phases (or imaginary parts; not used for amp or power)
+@param vScale a double with the physical size of the u-v pixels along v (in wavelengths)
+@param uScale a double with the physical size of the u-v pixels along u (in wavelengths)
+@param *hist a string with the history of the output file
+@param halfPlane an int with a flag for whether only the half plane with u>=0 is written
+@param *uvOrigin a pointer to the u and v of the first pixel, or NULL for a grid centered on the zero baseline
+@param datatype an int with the CFITSIO type of the arrays (TDOUBLE or TFLOAT)
+@param bitpix an int with the type of the images in the output file (DOUBLE_IMG or FLOAT_IMG)
+
+\return Returns zero if successful, 1 if not
+
+*/
+int writeVisOutput(image2uvOptions *opt, char *outFileName, int Ny, int Nx, void *Va, void *Vp,
+		   double vScale, double uScale, char *hist, int halfPlane, double *uvOrigin,
+		   int datatype, int bitpix)
+{
+  char *oname[4]={"amplitudes and phases","real and imaginary parts","amplitudes","power"}; // names of the outputs
+  int writeflag;                                    // flag for the result of writing
+
+  if (opt->omode==1)
+    writeflag=writeFITSVisComplex(outFileName,Ny,Nx,Va,Vp,vScale,uScale,hist,halfPlane,uvOrigin,
+				  datatype,bitpix,&opt->compression);
+  else if (opt->omode>=2)
+    writeflag=writeFITSVisAmp(outFileName,Ny,Nx,Va,vScale,uScale,hist,halfPlane,uvOrigin,
+			      (opt->omode==3),datatype,bitpix,&opt->compression);
+  else
+    writeflag=writeFITSVis(outFileName,Ny,Nx,Vp,Va,vScale,uScale,hist,halfPlane,uvOrigin,
+			   datatype,bitpix,&opt->compression);
+  if (writeflag!=0)
+    return 1;
+
+  if (opt->vmode!=0)
+    printf("image2uv: Wrote visibility %s to file %s\n",oname[opt->omode],outFileName);
+
+  return 0;
+}
+
+/*!
+\brief Writes the visibilities of the Stokes parameters of a cube in the format set by the -O option
+
+\details
+Writes all the visibilities of a full-Stokes cube into the HDUs of one
+output file (with writeFITSVisCube()). For each of the Nstokes Stokes
+parameters S (I, Q, U, and V, in this order) it writes, as set by the -O
+option, the two HDUs S_AMP and S_PHASE with the amplitudes and phases, 
+the HDU S with the real and imaginary parts along a COMPLEX third axis,
+or the HDU S_AMP or S_POWER with the amplitudes or their squares. If Q and
+U are present, these are followed by the HDU MBREVE with the real and
+imaginary parts of m-breve (for re,im) or the HDU MBREVE_AMP or 
+MBREVE_POWER with its amplitude or its square, and by the HDU EVPA (see
+fftToPol()).
+
+The arrays of consecutive Stokes parameters are planeSize elements apart
+in Va and Vp.
+
+\version 1.0
+
+\pre It is called from transformGroup()
+
+@param *opt a pointer to the options
+@param *outFileName a string with the output filename
+@param Ny an int with the number of rows of the u-v grid
+@param Nx an int with the number of columns of the full u-v grid
+@param Nstokes an int with the number of Stokes parameters
+@param planeSize a long with the number of elements between the arrays of consecutive Stokes parameters
+@param *Va a pointer to the arrays with the visibility amplitudes (or real parts, or power)
+@param *Vp a pointer to the arrays with the visibility phases (or imaginary parts; not used for amp or power)
+@param *Mre a pointer to the array with the amplitudes (or real parts) of m-breve (not used if Nstokes<3)
+@param *Mim a pointer to the array with the imaginary parts of m-breve (used only for re,im)
+@param *Evpa a pointer to the array with the EVPA (not used if Nstokes<3)
+@param vScale a double with the physical size of the u-v pixels along v (in wavelengths)
+@param uScale a double with the physical size of the u-v pixels along u (in wavelengths)
+@param *hist a string with the history of the output file
+@param halfPlane an int with a flag for whether only the half plane with u>=0 is written
+@param datatype an int with the CFITSIO type of the arrays (TDOUBLE or TFLOAT)
+@param bitpix an int with the type of the images in the output file (DOUBLE_IMG or FLOAT_IMG)
+
+\return Returns zero if successful, 1 if not
+
+*/
+int writeStokesOutput(image2uvOptions *opt, char *outFileName, int Ny, int Nx, int Nstokes, long planeSize,
+		      void *Va, void *Vp, void *Mre, void *Mim, void *Evpa, double vScale, double uScale,
+		      char *hist, int halfPlane, int datatype, int bitpix)
+{
+  char *oname[4]={"amplitudes and phases","real and imaginary parts","amplitudes","power"}; // names of the outputs
+  char *stokes[MAXSTOKES]={"I","Q","U","V"};       // names of the Stokes parameters
+  char names[2*MAXSTOKES+2][MAXCHAR];               // names of the HDUs
+  char comments[2*MAXSTOKES+2][MAXCHAR];            // descriptions of the HDUs
+  char *extname[2*MAXSTOKES+2], *comment[2*MAXSTOKES+2]; // pointers to the names and descriptions
+  void *Vre[2*MAXSTOKES+2], *Vim[2*MAXSTOKES+2];   // arrays of the HDUs
+  size_t realSize=(datatype==TFLOAT ? sizeof(float) : sizeof(double)); // size of the elements of the arrays
+  int Nhdu=0;                                       // number of HDUs
+  int iStokes;                                      // dummy index for counting Stokes parameters
+  int hdu;                                          // dummy index for counting HDUs
+
+  for (hdu=0;hdu<2*MAXSTOKES+2;hdu++)
+    {
+      extname[hdu]=names[hdu];
+      comment[hdu]=comments[hdu];
+      Vim[hdu]=NULL;
+    }
+
+  for (iStokes=0;iStokes<Nstokes;iStokes++)
+    {
+      Vre[Nhdu]=(char *)Va+realSize*iStokes*planeSize;
+      switch (opt->omode)
+	{
+	case 1:
+	  Vim[Nhdu]=(char *)Vp+realSize*iStokes*planeSize;
+	  snprintf(names[Nhdu],MAXCHAR,"%s",stokes[iStokes]);
+	  snprintf(comments[Nhdu],MAXCHAR,"Complex Visibilities of Stokes %s",stokes[iStokes]);
+	  break;
+	case 2:
+	  snprintf(names[Nhdu],MAXCHAR,"%s_AMP",stokes[iStokes]);
+	  snprintf(comments[Nhdu],MAXCHAR,"Visibility Amplitudes of Stokes %s",stokes[iStokes]);
+	  break;
+	case 3:
+	  snprintf(names[Nhdu],MAXCHAR,"%s_POWER",stokes[iStokes]);
+	  snprintf(comments[Nhdu],MAXCHAR,"Visibility Power of Stokes %s",stokes[iStokes]);
+	  break;
+	default:
+	  snprintf(names[Nhdu],MAXCHAR,"%s_AMP",stokes[iStokes]);
+	  snprintf(comments[Nhdu],MAXCHAR,"Visibility Amplitudes of Stokes %s",stokes[iStokes]);
+	  Nhdu++;
+	  Vre[Nhdu]=(char *)Vp+realSize*iStokes*planeSize;
+	  snprintf(names[Nhdu],MAXCHAR,"%s_PHASE",stokes[iStokes]);
+	  snprintf(comments[Nhdu],MAXCHAR,"Visibility Phases of Stokes %s",stokes[iStokes]);
+	  break;
+	}
+      Nhdu++;
+    }
+
+  // the fractional polarization and the EVPA, if Q and U are present
+  if (Nstokes>=3)
+    {
+      Vre[Nhdu]=Mre;
+      if (opt->omode==1)
+	{
+	  Vim[Nhdu]=Mim;
+	  snprintf(names[Nhdu],MAXCHAR,"MBREVE");
+	  snprintf(comments[Nhdu],MAXCHAR,"Complex m-breve (Q+iU)/I");
+	}
+      else
+	{
+	  snprintf(names[Nhdu],MAXCHAR,(opt->omode==3 ? "MBREVE_POWER" : "MBREVE_AMP"));
+	  snprintf(comments[Nhdu],MAXCHAR,(opt->omode==3 ? "Squared amplitude of m-breve (Q+iU)/I" :
+					   "Amplitude of m-breve (Q+iU)/I"));
+	}
+      Nhdu++;
+      Vre[Nhdu]=Evpa;
+      snprintf(names[Nhdu],MAXCHAR,"EVPA");
+      snprintf(comments[Nhdu],MAXCHAR,"EVPA arg(m-breve)/2 (in rad)");
+      Nhdu++;
+    }
+
+  if (writeFITSVisCube(outFileName,Ny,Nx,Nhdu,Vre,Vim,extname,comment,vScale,uScale,hist,halfPlane,NULL,
+		       datatype,bitpix,&opt->compression)!=0)
+    return 1;
+
+  if (opt->vmode!=0)
+    printf("image2uv: Wrote visibility %s of %d Stokes parameters%s to file %s\n",oname[opt->omode],Nstokes,
+	   (Nstokes>=3 ? ", m-breve and EVPA" : ""),outFileName);
+
+  return 0;
+}
+
+/*!
+\brief Writes an output of transformGroup() from a slot of the background writer
+
+\details
+The write function of the writer of transformGroup() (see startFITSWriter()
+in io.c): writes the visibilities in the slot, which starts with an 
+image2uvOutput, with writeStokesOutput() or writeVisOutput(). It runs on
+the thread of the writer, while the next images are transformed, unless
+the outputs are written in the foreground (-q 0).
+
+\version 1.0
+
+\pre It is called from writeFITSThread() or queueFITSWrite()
+
+@param *slot a pointer to the slot, which starts with an image2uvOutput
+
+\return Returns zero if successful, 1 if not
+
+*/
+int writeOutputSlot(void *slot)
+{
+  image2uvOutput *o=(image2uvOutput *)slot;         // the output in the slot
+
+  if (o->opt->smode)
+    return writeStokesOutput(o->opt,o->outFileName,o->Ny,o->Nx,o->Nplanes,o->planeSize,o->Va,o->Vp,
+			     o->Mre,o->Mim,o->Evpa,o->vScale,o->uScale,o->hist,o->opt->hmode,o->datatype,o->bitpix);
+  else
+    return writeVisOutput(o->opt,o->outFileName,o->Ny,o->Nx,o->Va,o->Vp,o->vScale,o->uScale,o->hist,o->opt->hmode,
+			  NULL,o->datatype,o->bitpix);
+}
+
+/*!
+\brief Opens the input file of a frame, if it is not open already
+
+\details
+The 2D images are opened once, when their sizes are read in main(), and 
+are kept open until they are read (for up to MAXOPENINPUTS images), so
+that the header of each file is not opened and parsed twice; this is 
+costly on a network filesystem with many input files. The rest of the
+images, and any image whose file was closed, are opened here. The file
+is closed with closeFrame().
+
+\version 1.0
+
+@param *frame a pointer to the image and its sizes
+
+\return Returns zero if successful, or the CFITSIO error code if not
+
+*/
+int openFrame(image2uvFrame *frame)
+{
+  if (frame->fptr!=NULL)
+    return 0;
+
+  return openFITSImage(frame->fileName,&frame->fptr);
+}
+
+/*!
+\brief Closes the input file of a frame, if it is open
+
+\version 1.0
+
+@param *frame a pointer to the image and its sizes
+
+\return nothing
+
+*/
+void closeFrame(image2uvFrame *frame)
+{
+  if (frame->fptr!=NULL)
+    closeFITSImage(frame->fptr);
+  frame->fptr=NULL;
+
+  return;
+}
+
+/*!
+\brief Takes the sizes of the image of a frame from the catalog of the input files
+
+\details
+If the input file is in the catalog given with -I (see achieve-index) 
+and has not changed since it was read into the catalog, the sizes of its
+image (and the number of planes along the time axis of a movie cube, or
+the number of Stokes parameters of a full-Stokes cube) are taken from 
+its entry, with a stat() of the file instead of opening it and parsing 
+its header. The file is then opened only when its image is read. 
+Otherwise, the sizes are read from the file as usual.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param *opt a pointer to the options, with the catalog
+@param *frame a pointer to the image, which returns its sizes
+@param *Nplanes an int pointer which returns the number of frames of a movie cube (-M)
+
+\return Returns one if the sizes were taken from the catalog, zero if not
+
+*/
+int indexedFrame(image2uvOptions *opt, image2uvFrame *frame, int *Nplanes)
+{
+  fitsIndexEntry *entry;                  // the file in the catalog
+  char *ctype=NULL;                       // type of the axis of the planes (NULL for a 2D image)
+  int Nz=1;                               // number of planes along that axis
+
+  entry=findFITSIndexEntry(opt->index,frame->fileName);
+  if (entry==NULL || !isFITSIndexCurrent(entry,frame->fileName))
+    return 0;
+
+  if (opt->mmode)
+    ctype="TIME";
+  else if (opt->smode)
+    ctype="STOKES";
+  if (readFITSIndexDims(entry,ctype,&frame->Ny,&frame->Nx,&Nz,&frame->yScale,&frame->xScale)!=0)
+    return 0;
+
+  if (opt->mmode)
+    *Nplanes=Nz;
+  else if (opt->smode)
+    frame->Nstokes=Nz;
+
+  return 1;
+}
+
+/*!
+\brief Reads rows of an image straight into the input array of its FFT
+
+\details
+Reads the Nrows rows of the image of a frame, starting from the row 
+firstRow (starting from 0), with readFITSImageStridedHandle(), straight into 
+their places in the padded input array of the FFT: the real array inReal
+of a real-to-complex transform, with NxPad elements per row, or the complex
+array in of a complex-to-complex transform, with a zero imaginary part.
+There is no separate image array and no copy of the image; the padding of
+the input array needs to be zero already. The file is opened with 
+openFrame(), if needed, and is left open for the rest of the rows.
+
+\version 1.0
+
+\pre It is called from transformGroup() and readTransformRows()
+
+@param *opt a pointer to the options
+@param *frame a pointer to the image and its sizes
+@param firstRow an int with the first row of the image to be read (starting from 0)
+@param Nrows an int with the number of rows to be read
+@param *inReal a pointer to the input array of a real-to-complex FFT (NULL for c2c)
+@param *in a pointer to the input array of a complex-to-complex FFT (NULL for r2c)
+
+\return Returns zero if successful, or the CFITSIO error code if not
+
+*/
+int readFFTInput(image2uvOptions *opt, image2uvFrame *frame, int firstRow, int Nrows, void *inReal, void *in)
+{
+  int iRowStart,iColStart;                          // Startng row and column of image in the padded image
+  int NyDummy,NxDummy;                              // dummy variables for the size of the padded image
+  long offset;                                      // element of the padded image for the first pixel that is read
+  int datatype=(opt->single ? TFLOAT : TDOUBLE);    // CFITSIO type of the input array
+
+  int readflag;                                     // flag for the result of reading
+
+  ArrayPad(frame->Ny, frame->Nx, opt->Npad, &iRowStart, &iColStart, &NyDummy, &NxDummy);
+  offset=indexArr(iRowStart+firstRow,iColStart,frame->NxPad);
+
+  readflag=openFrame(frame);
+  if (readflag!=0)
+    return readflag;
+
+  if (inReal!=NULL)
+    return readFITSImageStridedHandle(frame->fptr,frame->Ny,frame->Nx,firstRow,Nrows,datatype,inReal,
+				      offset,frame->NxPad,1);
+  else
+    return readFITSImageStridedHandle(frame->fptr,frame->Ny,frame->Nx,firstRow,Nrows,datatype,in,
+				      2*offset,2L*frame->NxPad,2);
+}
+
+/*!
+\brief Reads a block of rows of an image, as the reading stage of the pipeline of readTransformRows()
+
+\details
+Reads the rows of the block b->iBlock (with readFFTInput()), unless an
+earlier block could not be read, and keeps the result in b->readflag.
+
+\version 1.0
+
+\pre It is called from readTransformRows(), on a thread of its own
+
+@param *arg a pointer to the state of the pipeline (image2uvRowBlocks)
+
+\return Returns NULL
+
+*/
+void *readRowsThread(void *arg)
+{
+  image2uvRowBlocks *b=(image2uvRowBlocks *)arg;    // the state of the pipeline
+  int firstRow=b->iBlock*b->blockRows;              // first row of the block
+  int Nrows=(b->frame->Ny-firstRow<b->blockRows ? b->frame->Ny-firstRow : b->blockRows); // number of rows of the block
+
+  if (b->readflag==0)
+    b->readflag=readFFTInput(b->opt,b->frame,firstRow,Nrows,b->inReal,b->in);
+
+  return NULL;
+}
+
+/*!
+\brief Reads an image in blocks of rows and transforms each block while the next one is read
+
+\details
+Reads the image of a frame in blocks of plan->blockRows rows straight into
+the input array of the FFT (with readFFTInput()).
+The rows of each block are transformed (with executeFFTBlock()) while the
+next block is being read on a thread of its own (see readRowsThread()),
+so that most of the time spent reading a large image, e.g., from a network
+filesystem, is hidden behind the transforms of the rows, with or without
+OpenMP. Once all the rows are in, the columns are transformed (with 
+executeFFTCols()). If the thread cannot be started, the block is read 
+before the previous one is transformed.
+
+The brightness center is then found from the whole image in the input 
+array, which the out-of-place transforms do not change, as for an image
+that is not pipelined (see fillFFTInput()), so that the results do not
+depend on the size of the blocks.
+
+\version 1.0
+
+\pre It is called from transformGroup()
+
+@param *opt a pointer to the options
+@param *frame a pointer to the image and its sizes
+@param *plan a pointer to the FFTW plans made by planFFT() with blockRows>0
+@param *inReal a pointer to the input array of a real-to-complex FFT (NULL for c2c)
+@param *in a pointer to the input array of a complex-to-complex FFT (NULL for r2c)
+@param *out a pointer to the output array of the FFT
+@param *fluxXCent on return, a double with the x-coordinate of the phase center
+@param *fluxYCent on return, a double with the y-coordinate of the phase center
+
+\return Returns zero if successful, 1 if the image could not be read
+
+*/
+int readTransformRows(image2uvOptions *opt, image2uvFrame *frame, image2uvFFTPlan *plan,
+		      void *inReal, void *in, void *out, double *fluxXCent, double *fluxYCent)
+{
+  int NyPad=frame->NyPad, NxPad=frame->NxPad;       // Size of padded image in 2D
+  int NxFFT=(opt->tmode==0 ? NxPad/2+1 : NxPad);    // number of columns of the FFT output
+  int blockRows=plan->blockRows;                    // number of rows per block
+  int Nblocks=(frame->Ny+blockRows-1)/blockRows;    // number of blocks of rows
+  int iStep;                                        // step of the pipeline
+  image2uvRowBlocks b;                              // the state of the pipeline, shared with the reading thread
+  pthread_t reader;                                 // the thread of the reading stage
+  int reading;                                      // flag for the block that is read on its thread
+  double fluxTotal;                                 // total flux in the image (arb units)
+
+  b.opt=opt;
+  b.frame=frame;
+  b.blockRows=blockRows;
+  b.inReal=inReal;
+  b.in=in;
+  b.readflag=0;
+
+  // at step iStep, block iStep is read while block iStep-1 is transformed;
+  // the padding of the input array is zero already
+  for (iStep=0;iStep<=Nblocks;iStep++)
+    {
+      b.iBlock=iStep;
+      reading=(iStep<Nblocks && pthread_create(&reader,NULL,readRowsThread,&b)==0);
+      if (iStep<Nblocks && !reading)
+	readRowsThread(&b);
+
+      if (iStep>=1)
+	executeFFTBlock(plan,iStep-1,NxPad,NxFFT,inReal,in,out);
+
+      if (reading)
+	pthread_join(reader,NULL);
+    }
+
+  if (b.readflag!=0)
+    {
+      printReadErrorImage2uv(frame->fileName);   // print error message
+      return 1;
+    }
+  if (opt->vmode!=0)
+    printf("image2uv: Read %dx%d image from file %s in %d blocks of rows\n",frame->Nx,frame->Ny,frame->fileName,Nblocks);
+
+  // the transforms of the columns
+  executeFFTCols(plan,1,NyPad,NxFFT,out);
+
+  // the brightness center, from the whole image
+  if (opt->cmode==1)
+    fluxTotal=fillFFTInput((inReal!=NULL ? inReal : in),NyPad,NxPad,opt->single,inReal,in,fluxXCent,fluxYCent);
+  else
+    fluxTotal=0.0;
+  if (isnan(fluxTotal))
+    return 1;
+  if (fluxTotal!=0.0)
+    {
+      *fluxXCent/=fluxTotal;
+      *fluxYCent/=fluxTotal;
+      if (opt->vmode!=0)
+	printf("image2uv: brightness center at the (%7.1f,%7.1f) grid point\n",*fluxXCent,*fluxYCent);
+    }
+  else
+    {
+      *fluxXCent=NxPad/2.0;
+      *fluxYCent=NyPad/2.0;
+    }
+
+  return 0;
+}
+
+/*!
+\brief Transforms a group of images with the same padded size
+
+\details
+All the images in the group share one FFTW plan and one set of buffers. 
+The images are read and transformed Nbatch at a time with a single call
+to FFTW; if the number of images is not a multiple of Nbatch, a second 
+plan is made for the remaining images. The visibility amplitudes and phases
+of each image are then written to its own output file.
+
+All the images in the group also have the same size, so that the rows of the
+padded images that are all zeros are the same and the transform can skip them
+(see planFFT()). With the -w option, only the central window of the u-v grid
+is calculated and written.
+
+With the -f 32 option, all the arrays are in single precision: the images
+are read as float, transformed with the fftwf routines, and the visibility
+amplitudes and phases are written as float images.
+
+If the images are transformed one at a time and either they have at least
+PIPELINEMINPIXELS pixels or the -r option is given, the reading of each image
+is pipelined with the transforms of its rows (see readTransformRows()).
+
+The 2D images are read straight into their places in the input arrays of
+the FFT (see readFFTInput()), without an intermediate copy of the image.
+The padding of the input arrays is set to zero once, after planning, 
+because the out-of-place transforms leave their input unchanged.
+
+With the -S option, each input is a cube with Nstokes Stokes parameters. 
+The Stokes images of each cube are padded and transformed as separate 
+images of the same batch, i.e., one call to FFTW transforms Nbatch*Nstokes
+images, and the phases of all the Stokes parameters are calculated with
+respect to the phase center of Stokes I. The visibilities of all the
+Stokes parameters, m-breve, and the EVPA are written to one output file
+(see writeStokesOutput()).
+
+The visibilities of each image are converted into a slot of a bounded 
+queue of outputs (see startFITSWriter() in io.c), which are written on a 
+separate thread (see writeOutputSlot()) while the next images are read 
+and transformed; with the -q option, up to Nwrites outputs are in memory
+at any time, and the conversion waits only if all of them are still being
+written. The input files are prefetched PREFETCHDEPTH files ahead of the
+one that is read, if there is a prefetcher (see main()).
+
+If an image cannot be read or written, an error message is printed and 
+the rest of the images are transformed as usual.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param *opt a pointer to the options
+@param *frames an array with the images of the group
+@param Nframes an int with the number of images in the group
+
+\return Returns zero if all the images were transformed successfully, 1 if not
+
+*/
+int transformGroup(image2uvOptions *opt, image2uvFrame *frames, int Nframes)
+{
+  int NyPad=frames[0].NyPad, NxPad=frames[0].NxPad; // Size of padded image in 2D
+  int NxFFT=(opt->tmode==0 ? NxPad/2+1 : NxPad);    // number of columns of the FFT output
+  int Nplanes=frames[0].Nstokes;                    // number of Stokes images per input
+  long frameSize=(long)NyPad*NxPad;                 // number of points of each padded image
+  long outSize=(long)NyPad*NxFFT;                   // number of points of each FFT output
+  long bytesPerFrame;                               // size of the FFT buffers per image
+  size_t realSize=(opt->single ? sizeof(float) : sizeof(double)); // size of the real elements of the arrays
+  int datatype=(opt->single ? TFLOAT : TDOUBLE);    // CFITSIO type of the image and visibility arrays
+  int bitpix=opt->bitpix;                           // type of the images in the output files
+  int Nbatch;                                       // number of images per FFT batch
+  int Nrest;                                        // number of images in the last batch
+  int blockRows=0;                                  // number of rows per block of the pipelined reading (0: not pipelined)
+  int iStart,iFrame,k;                              // dummy indices for counting images
+  int iPlane,iFFT;                                  // dummy indices for the Stokes images and the transforms
+  int Nthis;                                        // number of images in the current batch
+  int *frameOK;                                     // flags for the images that were read
+  double *fluxXCent, *fluxYCent;                    // brightness center of each image
+  double fluxTotal;                                 // total flux in an image (arb units)
+  double planeXCent,planeYCent;                     // brightness center of the Q, U, and V images (not used)
+  void *ImageIn=NULL;                               // pointer to the image array of a cube (double or float)
+  fitsWriter writer;                                // queue of the outputs that are written in the background
+  int Nslots;                                       // number of outputs in memory at any time
+  size_t headerSize;                                // size of the header of a slot of the writer
+  size_t arraySize;                                 // size of each visibility array of a slot
+  size_t slotSize;                                  // size of a slot of the writer
+  image2uvOutput *o;                                // the output in a slot of the writer
+  void *inReal=NULL;                                // pointer to the real array for r2c FFTs
+  void *in=NULL, *out=NULL;                         // pointers to the complex arrays for 2D FFTs
+  image2uvFFTPlan p, pRest;                         // 2D fft plans used in FFTW
+  int iRowStart,iColStart;                          // Startng row and column of image in the padded image
+  int NyDummy,NxDummy;                              // dummy variables for the size of the padded image
+  int Ku,KuMax;                                     // largest |u-index| of the windows
+  image2uvWindow win;                               // window of the u-v grid that is written
+  double vScale,uScale;                             // physical sizes of u-v pixels along the two directions
+  double zeroBaselineAmp;                           // zero baseline amplitude of an image
+  int readflag;                                     // flag for the result of reading
+  int convflag;                                     // flag for the result of the conversion to visibilities
+  int status=0;                                     // return value
+
+  // no plans yet, so that only the plans that were made are destroyed
+  memset(&p,0,sizeof p);
+  memset(&pRest,0,sizeof pRest);
+
+  // figure out how many images can be transformed together
+  if (opt->tmode==0)
+    bytesPerFrame=realSize*(frameSize+2*outSize);
+  else
+    bytesPerFrame=2*realSize*(frameSize+outSize);
+  bytesPerFrame*=Nplanes;
+  if (opt->Nbatch>0)
+    Nbatch=opt->Nbatch;
+  else
+    Nbatch=BATCHMEMDEFAULT/bytesPerFrame;
+  if (Nbatch<1)
+    Nbatch=1;
+  if (Nbatch>Nframes)
+    Nbatch=Nframes;
+  Nrest=Nframes%Nbatch;
+
+  // the reading of large images, one at a time, is pipelined with the transforms of their rows
+  if (Nbatch==1 && Nplanes==1)
+    {
+      blockRows=opt->rowBlock;
+      if (blockRows<0)
+	blockRows=((long)frames[0].Ny*frames[0].Nx>=PIPELINEMINPIXELS ? ROWBLOCKDEFAULT : 0);
+      // a multiple of 4 rows, so that all the blocks have the same alignment
+      blockRows=4*((blockRows+3)/4);
+      if (blockRows>=frames[0].Ny)
+	blockRows=0;
+    }
+
+  if (opt->vmode!=0 && opt->Nin>1)
+    printf("image2uv: Transforming %d padded %dx%d image(s), %d at a time\n",Nframes,NxPad,NyPad,Nbatch);
+  
+  // the visibility arrays of each output are in a slot of the writer, after the header of the slot:
+  // the amplitudes, the phases (if needed), and m-breve (one or two arrays) and the EVPA, if needed
+  headerSize=SLOTALIGN*((sizeof(image2uvOutput)+SLOTALIGN-1)/SLOTALIGN);
+  arraySize=SLOTALIGN*((realSize*frameSize+SLOTALIGN-1)/SLOTALIGN);
+  slotSize=headerSize+arraySize*Nplanes*(opt->omode<=1 ? 2 : 1);
+  if (Nplanes>=3)
+    slotSize+=arraySize*(opt->omode==1 ? 3 : 2);
+
+  // the outputs are written in the background, with up to writeQueue of them in memory
+  // (but not more than fit in BATCHMEMDEFAULT bytes), while the next images are transformed
+  Nslots=(opt->writeQueue>0 ? opt->writeQueue : 1);
+  if (Nslots>Nframes)
+    Nslots=Nframes;
+  if ((long)Nslots*slotSize>BATCHMEMDEFAULT)
+    Nslots=BATCHMEMDEFAULT/slotSize;
+  if (Nslots<1)
+    Nslots=1;
+
+  // allocate memory for the image of a cube; the 2D images are read straight into
+  // the input arrays of the FFT
+  if (opt->smode)
+    ImageIn = malloc(realSize*frameSize*Nplanes);   // allocate memory to store image
+  frameOK = (int *)malloc(sizeof(int)*Nbatch);
+  fluxXCent = (double *)malloc(sizeof(double)*Nbatch);
+  fluxYCent = (double *)malloc(sizeof(double)*Nbatch);
+
+  // allocate memory for the batch of images to FFT and for the output of the FFT;
+  // the memory of fftw_malloc() is aligned for the SIMD instructions of either precision
+  if (opt->tmode==0)
+    inReal = fftw_malloc(realSize * frameSize*Nbatch*Nplanes);
+  else
+    in = fftw_malloc(2*realSize * frameSize*Nbatch*Nplanes);
+  out = fftw_malloc(2*realSize * outSize*Nbatch*Nplanes);
+  
+  // if memory allocation failed
+  if ((opt->smode && ImageIn == NULL) || frameOK == NULL ||
+      fluxXCent == NULL || fluxYCent == NULL || (inReal == NULL && in == NULL) || out == NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");   // print error message
+      status=1;                               // return with error code
+      goto cleanup;
+    }
+
+  // the rows of the padded images that hold the images
+  ArrayPad(frames[0].Ny, frames[0].Nx, opt->Npad, &iRowStart, &iColStart, &NyDummy, &NxDummy);
+
+  // the columns of the transforms that are needed for the windows of all the images
+  KuMax=0;
+  for (iFrame=0;iFrame<Nframes;iFrame++)
+    {
+      Ku=setWindow(opt,NyPad,NxPad,180.0/(NxPad*frames[iFrame].xScale*M_PI),
+		   180.0/(NyPad*frames[iFrame].yScale*M_PI),&win);
+      if (Ku<0 || KuMax<0)
+	KuMax=-1;
+      else if (Ku>KuMax)
+	KuMax=Ku;
+    }
+  
+  // make the FFTW plans, before the input arrays are filled
+  if (planFFT(opt,NyPad,NxPad,Nbatch*Nplanes,iRowStart-1,frames[0].Ny,KuMax,blockRows,inReal,in,out,&p)!=0 ||
+      (Nrest!=0 && planFFT(opt,NyPad,NxPad,Nrest*Nplanes,iRowStart-1,frames[0].Ny,KuMax,0,inReal,in,out,&pRest)!=0))
+    {
+      status=1;
+      goto cleanup;
+    }
+  if (opt->vmode!=0 && p.pruned)
+    printf("image2uv: Pruned FFT of %d rows and %s columns\n",frames[0].Ny,(KuMax<0 ? "all" : "the central"));
+  if (opt->vmode!=0 && blockRows>0)
+    printf("image2uv: Reading pipelined with the FFT in blocks of %d rows\n",blockRows);
+
+  // the padding of the input arrays needs to be zero; the images are read straight into their
+  // places, and the out-of-place transforms do not change the input, so it is set only once
+  if (inReal!=NULL)
+    memset(inReal,0,realSize*frameSize*Nbatch*Nplanes);
+  if (in!=NULL)
+    memset(in,0,2*realSize*frameSize*Nbatch*Nplanes);
+  
+  // start the writer, after all the other memory is allocated
+  if (startFITSWriter(&writer,Nslots,slotSize,writeOutputSlot,(opt->writeQueue>0))!=0)
+    {
+      status=1;
+      goto cleanup;
+    }
+  if (opt->vmode!=0 && opt->writeQueue>0 && opt->Nin>1)
+    printf("image2uv: Writing the outputs in the background, %d at a time\n",Nslots);
+
+  // the first input files are prefetched while the first ones are read, and then each file
+  // PREFETCHDEPTH files ahead of the one that is read
+  for (iFrame=1;iFrame<PREFETCHDEPTH && iFrame<Nframes;iFrame++)
+    queueFITSPrefetch(opt->prefetch,frames[iFrame].fileName);
+  
+  // go through the images, Nbatch at a time
+  for (iStart=0;iStart<Nframes;iStart+=Nbatch)
+    {
+      Nthis=(Nframes-iStart<Nbatch ? Nframes-iStart : Nbatch);
+      
+      // read the images of this batch and fill the input array
+      for (k=0;k<Nthis;k++)
+	{
+	  iFrame=iStart+k;
+	  if (iFrame+PREFETCHDEPTH<Nframes)
+	    queueFITSPrefetch(opt->prefetch,frames[iFrame+PREFETCHDEPTH].fileName);
+
+	  // read and transform the rows of a large image in blocks
+	  if (blockRows>0)
+	    {
+	      frameOK[k]=(readTransformRows(opt,frames+iFrame,&p,inReal,in,out,fluxXCent+k,fluxYCent+k)==0);
+	      closeFrame(frames+iFrame);
+	      if (!frameOK[k])
+		status=1;
+	      continue;
+	    }
+
+	  // now read the whole file; a 2D image straight into the input array of its transform
+	  iFFT=k*Nplanes;
+	  if (opt->smode)
+	    {
+	      // the padding needs to be zero
+	      memset(ImageIn,0,realSize*frameSize*Nplanes);
+	      readflag=readFITSCube(frames[iFrame].fileName, frames[iFrame].Ny, frames[iFrame].Nx, opt->Npad,
+				    "STOKES", 0, Nplanes, datatype, ImageIn);
+	    }
+	  else
+	    {
+	      readflag=readFFTInput(opt,frames+iFrame,0,frames[iFrame].Ny,
+				    (inReal!=NULL ? (char *)inReal+realSize*iFFT*frameSize : NULL),
+				    (in!=NULL ? (char *)in+2*realSize*iFFT*frameSize : NULL));
+	      closeFrame(frames+iFrame);
+	    }
+  
+	  // if there was a problem, report it and carry on with the rest
+	  frameOK[k]=(readflag==0);
+	  if (!frameOK[k])
+	    {
+	      printReadErrorImage2uv(frames[iFrame].fileName);   // print error message
+	      status=1;
+	    }
+	  else if (opt->vmode!=0)
+	    {
+	      if (opt->smode)
+		printf("image2uv: Read %dx%dx%d cube from file %s\n",frames[iFrame].Nx,frames[iFrame].Ny,Nplanes,
+		       frames[iFrame].fileName);
+	      else
+		printf("image2uv: Read %dx%d image from file %s\n",frames[iFrame].Nx,frames[iFrame].Ny,frames[iFrame].fileName);
+	    }
+
+	  // fill the input array using the cube that was just read
+	  // and, in the meantime, find the brightness center of the image;
+	  // the Stokes images of a cube are consecutive transforms of the batch
+	  // and share the brightness center of Stokes I
+	  if (opt->smode)
+	    {
+	      fluxTotal=fillFFTInput(ImageIn,NyPad,NxPad,opt->single,
+				     (inReal!=NULL ? (char *)inReal+realSize*iFFT*frameSize : NULL),
+				     (in!=NULL ? (char *)in+2*realSize*iFFT*frameSize : NULL),
+				     fluxXCent+k,fluxYCent+k);
+	      for (iPlane=1;iPlane<Nplanes && !isnan(fluxTotal);iPlane++)
+		if (isnan(fillFFTInput((char *)ImageIn+realSize*iPlane*frameSize,NyPad,NxPad,opt->single,
+				       (inReal!=NULL ? (char *)inReal+realSize*(iFFT+iPlane)*frameSize : NULL),
+				       (in!=NULL ? (char *)in+2*realSize*(iFFT+iPlane)*frameSize : NULL),
+				       &planeXCent,&planeYCent)))
+		  fluxTotal=NAN;
+	    }
+	  // a 2D image is already in the input array, and is only added up for its brightness center
+	  else if (opt->cmode==1)
+	    fluxTotal=fillFFTInput((inReal!=NULL ? (char *)inReal+realSize*iFFT*frameSize :
+				    (char *)in+2*realSize*iFFT*frameSize),NyPad,NxPad,opt->single,
+				   (inReal!=NULL ? (char *)inReal+realSize*iFFT*frameSize : NULL),
+				   (in!=NULL ? (char *)in+2*realSize*iFFT*frameSize : NULL),
+				   fluxXCent+k,fluxYCent+k);
+	  else
+	    fluxTotal=0.0;
+
+	  // the input array could not be filled, so the image is skipped
+	  if (isnan(fluxTotal))
+	    {
+	      frameOK[k]=0;
+	      status=1;
+	      fluxTotal=0.0;
+	    }
+
+	  // calculate the flux center
+	  // if there is some flux in the image and the centering option is on
+	  if (fluxTotal!=0.0 && opt->cmode==1)
+	    {
+	      // normalize the x- and y- coordinates
+	      fluxXCent[k]/=fluxTotal;
+	      fluxYCent[k]/=fluxTotal;
+	      if (opt->vmode!=0 && frameOK[k])
+		printf("image2uv: brightness center at the (%7.1f,%7.1f) grid point\n",fluxXCent[k],fluxYCent[k]);
+	    }
+	  else
+	    {
+	      // otherwise just center it
+	      fluxXCent[k]=NxPad/2.0;
+	      fluxYCent[k]=NyPad/2.0;
+	    }
+	}
+
+      // calculate the FFT of the images based on the FFTW plan
+      if (blockRows==0)
+	executeFFT((Nthis==Nbatch ? &p : &pRest),Nthis*Nplanes,NyPad,NxFFT,out);
+      
+      if (opt->vmode!=0)
+	printf("image2uv: FFT of %d padded %dx%d image(s) completed\n",Nthis,NxPad,NyPad);
+
+      // convert each image of the batch into a free slot of the writer, and queue it for writing
+      for (k=0;k<Nthis;k++)
+	{
+	  iFrame=iStart+k;
+	  if (!frameOK[k])
+	    continue;
+
+	  // wait for a slot, if all of them are being written
+	  o=(image2uvOutput *)getFITSWriterSlot(&writer);
+	  o->opt=opt;
+	  o->Nplanes=Nplanes;
+	  o->planeSize=arraySize/realSize;
+	  o->datatype=datatype;
+	  o->bitpix=bitpix;
+	  o->Va=(char *)o+headerSize;
+	  o->Vp=(opt->omode<=1 ? (char *)o->Va+arraySize*Nplanes : o->Va);
+	  o->Mre=(char *)o->Va+arraySize*Nplanes*(opt->omode<=1 ? 2 : 1);
+	  o->Mim=(opt->omode==1 ? (char *)o->Mre+arraySize : o->Mre);
+	  o->Evpa=(char *)o->Mim+arraySize;
+
+	  // Convert the complex FFT to visibility amplitudes and phases
+	  // Also transpose the FFT array so that it is centered.
+	  // calculate scale of pixels in u-v plane (the scales in the image are in degrees, so they need also
+	  // to be converted to rad.
+	  uScale=180.0/(NxPad*frames[iFrame].xScale*M_PI);
+	  vScale=180.0/(NyPad*frames[iFrame].yScale*M_PI);
+	  o->uScale=uScale;
+	  o->vScale=vScale;
+
+	  // the window of the u-v grid that is written
+	  setWindow(opt,NyPad,NxPad,uScale,vScale,&win);
+  
+	  iFFT=k*Nplanes;
+	  convflag=0;
+	  for (iPlane=0;iPlane<Nplanes && convflag==0;iPlane++)
+	    {
+	      convflag=fftToVis((char *)out+2*realSize*(iFFT+iPlane)*outSize,NyPad,NxPad,(opt->tmode==0),
+				opt->single,&win,fluxXCent[k],fluxYCent[k],opt->omode,
+				(char *)o->Va+arraySize*iPlane,(char *)o->Vp+arraySize*iPlane,&zeroBaselineAmp);
+
+	      if (opt->vmode!=0 && convflag==0)
+		printf("image2uv: zero baseline amplitude is %e\n",zeroBaselineAmp);
+	    }
+	  if (convflag!=0)
+	    {
+	      releaseFITSWriterSlot(&writer,o);
+	      status=1;
+	      continue;
+	    }
+
+	  // the fractional polarization m-breve and the EVPA from Stokes I, Q, and U
+	  if (Nplanes>=3 && fftToPol((char *)out+2*realSize*iFFT*outSize,(char *)out+2*realSize*(iFFT+1)*outSize,
+				     (char *)out+2*realSize*(iFFT+2)*outSize,NyPad,NxPad,(opt->tmode==0),
+				     opt->single,&win,opt->omode,o->Mre,o->Mim,o->Evpa)!=0)
+	    {
+	      releaseFITSWriterSlot(&writer,o);
+	      status=1;
+	      continue;
+	    }
+  
+	  // the output filename and the history of the output file
+	  frameOutput(opt,frames+iFrame,o->outFileName,o->hist);
+	  o->Ny=win.NyOut;
+	  o->Nx=win.NxFull;
+
+	  // written while the next images are transformed
+	  queueFITSWrite(&writer,o);
+	}
+    }
+
+  // wait for the outputs that are still being written
+  if (stopFITSWriter(&writer)!=0)
+    status=1;
+
+ cleanup:
+  // destroy the FFTW plans
+  destroyFFT(&p);
+  destroyFFT(&pRest);
+
+  // free the allocated memory
+  if (in!=NULL) fftw_free(in);
+  if (inReal!=NULL) fftw_free(inReal);
+  if (out!=NULL) fftw_free(out);
+  free(ImageIn);
+  free(frameOK);
+  free(fluxXCent);
+  free(fluxYCent);
+
+  return status;
+}
+
+/*!
+\brief Transforms a group of images with the same padded size in place, with little memory
+
+\details
+In the low-memory mode (-m low), each image is read straight into the 
+buffer of the FFT, which is the only array of the size of the padded image:
+NyPad by (NxPad/2+1) complex points for a real-to-complex transform, or 
+NyPad by NxPad for a complex-to-complex transform. The image is spread to
+the layout of the input of an in-place transform (see spreadFFTInput()),
+after its brightness center is found, and transformed in place with one
+plan for all the images of the group.
+
+The transform is then converted to visibilities (see fftToVis()) in
+blocks of rows of the output, of about LOWMEMBLOCKPIXELS pixels each,
+and each block is written to the output file (see writeFITSVisRows()) 
+before the next one is converted. The conversion cannot overwrite the 
+transform, since the output is centered and, for the r2c transform, the
+visibilities with u<0 are read from the rows of V(-u,-v), so only the 
+small arrays of one block are needed in addition to the buffer. The 
+output files have the same visibilities and layout as those of 
+transformGroup().
+
+If an image cannot be read or written, an error message is printed and 
+the rest of the images are transformed as usual.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param *opt a pointer to the options
+@param *frames an array with the images of the group
+@param Nframes an int with the number of images in the group
+
+\return Returns zero if all the images were transformed successfully, 1 if not
+
+*/
+int lowMemoryGroup(image2uvOptions *opt, image2uvFrame *frames, int Nframes)
+{
+  int NyPad=frames[0].NyPad, NxPad=frames[0].NxPad; // Size of padded image in 2D
+  int NxFFT=(opt->tmode==0 ? NxPad/2+1 : NxPad);    // number of columns of the FFT output
+  long gridSize=(long)NyPad*NxFFT;                  // number of complex points of the FFT buffer
+  size_t realSize=(opt->single ? sizeof(float) : sizeof(double)); // size of the real elements of the arrays
+  int datatype=(opt->single ? TFLOAT : TDOUBLE);    // CFITSIO type of the image and visibility arrays
+  int bitpix=opt->bitpix;                           // type of the images in the output files
+  int iFrame;                                       // dummy index for counting images
+  void *grid=NULL;                                  // the FFT buffer, with the image and then its transform
+  void *Va=NULL, *Vp=NULL;                          // pointers to arrays with amplitude and phase of a block of rows
+  void *Vre[2], *Vim[2];                            // arrays of the HDUs of the output
+  char *comment[2];                                 // descriptions of the HDUs of the output
+  int isComplex[2];                                 // flags for the HDUs with real and imaginary parts
+  int Nhdu;                                         // number of HDUs of the output
+  int blockRows;                                    // number of rows per block of the output
+  int firstRow,Nrows;                               // first row and number of rows of a block of the output
+  image2uvFFTPlan p;                                // 2D fft plan used in FFTW
+  int iRowStart,iColStart;                          // Startng row and column of image in the padded image
+  int NyDummy,NxDummy;                              // dummy variables for the size of the padded image
+  int Ku,KuMax;                                     // largest |u-index| of the windows
+  image2uvWindow win, block;                        // window of the u-v grid that is written, and a block of its rows
+  double fluxTotal;                                 // total flux in an image (arb units)
+  double fluxXCent,fluxYCent;                       // brightness center of an image
+  double zeroBaselineAmp;                           // zero baseline amplitude of an image
+  double vScale,uScale;                             // physical sizes of u-v pixels along the two directions
+  char outFileName[MAXPATH];                        // output filename
+  char hist[MAXPATH];                               // string for history in output FITS file
+  fitsfile *fptr;                                   // pointer to the output FITS file
+  int readflag,writeflag;                           // flags for the results of reading and writing
+  int status=0;                                     // return value
+
+  // no plans yet, so that only the plans that were made are destroyed
+  memset(&p,0,sizeof p);
+
+  // the blocks of rows of the output have about LOWMEMBLOCKPIXELS pixels
+  blockRows=LOWMEMBLOCKPIXELS/NxPad;
+  if (blockRows<1)
+    blockRows=1;
+  
+  // allocate memory for the FFT buffer and for a block of rows of the output;
+  // the memory of fftw_malloc() is aligned for the SIMD instructions of either precision
+  grid = fftw_malloc(2*realSize * gridSize);
+  Va = malloc(realSize*blockRows*NxPad);
+  Vp = (opt->omode<=1 ? malloc(realSize*blockRows*NxPad) : Va);
+  if (grid == NULL || Va == NULL || Vp == NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");   // print error message
+      status=1;                               // return with error code
+      goto cleanup;
+    }
+
+  if (opt->vmode!=0)
+    printf("image2uv: Transforming %d padded %dx%d image(s) in place, in a buffer of %.1f MB\n",Nframes,NxPad,NyPad,
+	   2.0*realSize*gridSize/1048576.0);
+
+  // the HDUs of the output, as set by the -O option
+  Nhdu=setOutputHDUs(opt->omode,Va,Vp,Vre,Vim,isComplex,NULL,comment);
+
+  // the rows of the padded images that hold the images
+  ArrayPad(frames[0].Ny, frames[0].Nx, opt->Npad, &iRowStart, &iColStart, &NyDummy, &NxDummy);
+
+  // the columns of the transforms that are needed for the windows of all the images
+  KuMax=0;
+  for (iFrame=0;iFrame<Nframes;iFrame++)
+    {
+      Ku=setWindow(opt,NyPad,NxPad,180.0/(NxPad*frames[iFrame].xScale*M_PI),
+		   180.0/(NyPad*frames[iFrame].yScale*M_PI),&win);
+      if (Ku<0 || KuMax<0)
+	KuMax=-1;
+      else if (Ku>KuMax)
+	KuMax=Ku;
+    }
+
+  // make the FFTW plan for the transforms in place, before the buffer is filled
+  if (planFFT(opt,NyPad,NxPad,1,iRowStart-1,frames[0].Ny,KuMax,0,(opt->tmode==0 ? grid : NULL),
+	      (opt->tmode==1 ? grid : NULL),grid,&p)!=0)
+    {
+      status=1;
+      goto cleanup;
+    }
+
+  for (iFrame=0;iFrame<Nframes;iFrame++)
+    {
+      // the padding needs to be zero
+      memset(grid,0,2*realSize*gridSize);
+
+      // read the image straight into the FFT buffer
+      readflag=openFrame(frames+iFrame);
+      if (readflag==0)
+	readflag=readFITSImageRowsHandle(frames[iFrame].fptr, frames[iFrame].Ny, frames[iFrame].Nx, opt->Npad,
+					 0, frames[iFrame].Ny, 0, datatype, grid);
+      closeFrame(frames+iFrame);
+      if (readflag!=0)
+	{
+	  printReadErrorImage2uv(frames[iFrame].fileName);   // print error message
+	  status=1;
+	  continue;
+	}
+      if (opt->vmode!=0)
+	printf("image2uv: Read %dx%d image from file %s\n",frames[iFrame].Nx,frames[iFrame].Ny,frames[iFrame].fileName);
+
+      // find the brightness center, before the image is spread to the layout of the transform
+      fluxTotal=fillFFTInput(grid,NyPad,NxPad,opt->single,NULL,NULL,&fluxXCent,&fluxYCent);
+      if (isnan(fluxTotal))
+	{
+	  status=1;
+	  continue;
+	}
+      if (fluxTotal!=0.0 && opt->cmode==1)
+	{
+	  fluxXCent/=fluxTotal;
+	  fluxYCent/=fluxTotal;
+	  if (opt->vmode!=0)
+	    printf("image2uv: brightness center at the (%7.1f,%7.1f) grid point\n",fluxXCent,fluxYCent);
+	}
+      else
+	{
+	  fluxXCent=NxPad/2.0;
+	  fluxYCent=NyPad/2.0;
+	}
+
+      // transform the image in place
+      spreadFFTInput(grid,NxPad,iRowStart-1,frames[iFrame].Ny,opt->tmode,opt->single);
+      executeFFT(&p,1,NyPad,NxFFT,grid);
+      if (opt->vmode!=0)
+	printf("image2uv: FFT of padded %dx%d image completed\n",NxPad,NyPad);
+
+      // calculate scale of pixels in u-v plane (the scales in the image are in degrees, so they need also
+      // to be converted to rad.
+      uScale=180.0/(NxPad*frames[iFrame].xScale*M_PI);
+      vScale=180.0/(NyPad*frames[iFrame].yScale*M_PI);
+
+      // the window of the u-v grid that is written
+      setWindow(opt,NyPad,NxPad,uScale,vScale,&win);
+
+      // the output filename and the history of the output file
+      frameOutput(opt,frames+iFrame,outFileName,hist);
+
+      if (createFITSVisMovie(outFileName,win.NyOut,win.NxFull,0,Nhdu,isComplex,NULL,comment,vScale,uScale,
+			     hist,opt->hmode,bitpix,&fptr)!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      // convert and write the visibilities one block of rows at a time
+      writeflag=0;
+      block=win;
+      for (firstRow=0;firstRow<win.NyOut && writeflag==0;firstRow+=blockRows)
+	{
+	  Nrows=(win.NyOut-firstRow<blockRows ? win.NyOut-firstRow : blockRows);
+	  block.kv0=win.kv0+firstRow;
+	  block.NyOut=Nrows;
+	  if (fftToVis(grid,NyPad,NxPad,(opt->tmode==0),opt->single,&block,fluxXCent,fluxYCent,
+		       opt->omode,Va,Vp,&zeroBaselineAmp)!=0)
+	    {
+	      writeflag=1;
+	      break;
+	    }
+	  writeflag=writeFITSVisRows(fptr,win.NyOut,win.NxFull,opt->hmode,0,firstRow,Nrows,Nhdu,Vre,Vim,datatype);
+	}
+      writeflag+=closeFITSVisMovie(fptr);
+      if (writeflag!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      if (opt->vmode!=0)
+	{
+	  printf("image2uv: zero baseline amplitude is %e\n",zeroBaselineAmp);
+	  printf("image2uv: Wrote visibilities to file %s in blocks of %d rows\n",outFileName,blockRows);
+	}
+    }
+
+ cleanup:
+  // destroy the FFTW plan
+  destroyFFT(&p);
+
+  // free the allocated memory
+  if (grid!=NULL) fftw_free(grid);
+  free(Va);
+  if (Vp!=Va) free(Vp);
+
+  return status;
+}
+
+/*!
+\brief Checks whether a column of the FFT array is held in memory
+
+\version 1.0
+
+\pre It is called from writeHeldVis()
+
+@param *win a pointer to the window of the u-v grid, with the columns that are held
+@param col an int with the column of the FFT array
+
+\return Returns 1 if the column is held, zero if not
+
+*/
+int heldColumn(image2uvWindow *win, int col)
+{
+  return (win->NxHeld==0 || (col>=win->colOffset && col<win->colOffset+win->NxHeld));
+}
+
+/*!
+\brief Converts and writes the visibilities that come from the part of the FFT array held in memory
+
+\details
+The array slab holds Nslab rows of the FFT array, from row win->rowOffset
+on, and either all its columns or, if win->NxHeld is set, win->NxHeld 
+columns from column win->colOffset on (e.g., the slab of rows of an MPI
+process, or a tile of columns of the out-of-core mode). Each row of the 
+window win of the u-v grid is transposed from one row of the FFT array 
+and, for a real-to-complex transform, its columns with u<0 from the row
+of V(-u,-v) (see transposeTables()). The rectangles of the window that come 
+from the part that is held, i.e., the columns with u>=0 of the rows that 
+are transposed from it and the columns with u<0 of the rows whose V(-u,-v)
+is in it, are converted (see fftToVis()) and written (see 
+writeFITSVisSubset()) in blocks of at most blockRows rows, so that the 
+parts of the array together write each visibility of the window once.
+
+\version 1.0
+
+\pre It is called from mpiGroup() and outOfCoreGroup(), with the output file open
+
+@param *slab a pointer to the part of the FFT array that is held
+@param Nslab an int with the number of rows that are held
+@param NyPad an int with the number of rows of the padded image
+@param NxPad an int with the number of columns of the padded image
+@param r2cmode an int with a flag for whether the FFT array holds the output of a real-to-complex FFT
+@param single an int with a flag for single precision
+@param *win a pointer to the window of the u-v grid, with the part of the FFT array that is held
+@param fluxXCent a double with the x-coordinate of the phase center (in grid points, starting from 1)
+@param fluxYCent a double with the y-coordinate of the phase center (in grid points, starting from 1)
+@param omode an int with the quantities to be stored (0: amp,phase, 1: re,im, 2: amp, 3: power)
+@param blockRows an int with the maximum number of rows of a block
+@param *Va a pointer to an array of blockRows by win->NxOut points for the amplitudes of a block
+@param *Vp a pointer to an array of blockRows by win->NxOut points for the phases of a block
+@param Nhdu an int with the number of HDUs of the output
+@param **Vre an array with the arrays of the HDUs of the output (Va or Vp)
+@param **Vim an array with the arrays of the imaginary parts of the HDUs of the output (or NULL)
+@param *fptr a pointer to the output FITS file
+
+\return Returns zero if successful, 1 if not
+
+*/
+int writeHeldVis(void *slab, int Nslab, int NyPad, int NxPad, int r2cmode, int single, image2uvWindow *win,
+		 double fluxXCent, double fluxYCent, int omode, int blockRows, void *Va, void *Vp,
+		 int Nhdu, void **Vre, void **Vim, fitsfile *fptr)
+{
+  int *colFrom,*rowFrom,*rowFromConj;               // tables of the columns and rows of the whole FFT array
+  int *rowSource;                                   // the table of the rows of a run of columns
+  int c0,c1,r0,r1;                                  // first and last+1 columns and rows of a rectangle
+  int negative;                                     // flag for a run of columns with u<0 of an r2c transform
+  int held;                                         // flag for a run of columns that are held
+  int inSlab;                                       // flag for a run of rows that are held
+  image2uvWindow full=*win, block=*win;             // the window with the whole array, and a rectangle
+  int datatype=(single ? TFLOAT : TDOUBLE);         // CFITSIO type of the visibility arrays
+  int writeflag=0;                                  // flag for the result of writing
+  double zeroBaselineAmp;                           // zero baseline amplitude (given with the window)
+
+  colFrom=(int *)malloc(sizeof(int)*win->NxOut);
+  rowFrom=(int *)malloc(sizeof(int)*win->NyOut);
+  rowFromConj=(int *)malloc(sizeof(int)*win->NyOut);
+  if (colFrom==NULL || rowFrom==NULL || rowFromConj==NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");
+      free(colFrom);
+      free(rowFrom);
+      free(rowFromConj);
+      return 1;
+    }
+
+  // the rows and columns of the whole FFT array, to find those that are held
+  full.rowOffset=0;
+  full.colOffset=0;
+  transposeTables(NyPad,NxPad,r2cmode,&full,colFrom,rowFrom,rowFromConj);
+
+  for (c0=0;c0<win->NxOut && writeflag==0;c0=c1)
+    {
+      // a run of columns that are all in the same half plane, and all held or not
+      negative=(colFrom[c0]<0);
+      held=heldColumn(win,(negative ? -colFrom[c0]-1 : colFrom[c0]));
+      for (c1=c0+1;c1<win->NxOut && (colFrom[c1]<0)==negative &&
+	     heldColumn(win,(negative ? -colFrom[c1]-1 : colFrom[c1]))==held;c1++);
+      if (!held)
+	continue;
+      rowSource=(negative ? rowFromConj : rowFrom);
+
+      for (r0=0;r0<win->NyOut && writeflag==0;r0=r1)
+	{
+	  // a run of rows that are all held, or all not
+	  inSlab=(rowSource[r0]>=win->rowOffset && rowSource[r0]<win->rowOffset+Nslab);
+	  for (r1=r0+1;r1<win->NyOut && r1-r0<blockRows &&
+		 (rowSource[r1]>=win->rowOffset && rowSource[r1]<win->rowOffset+Nslab)==inSlab;r1++);
+	  if (!inSlab)
+	    continue;
+
+	  block.ku0=win->ku0+c0;
+	  block.NxOut=c1-c0;
+	  block.kv0=win->kv0+r0;
+	  block.NyOut=r1-r0;
+	  if (fftToVis(slab,NyPad,NxPad,r2cmode,single,&block,fluxXCent,fluxYCent,omode,Va,Vp,&zeroBaselineAmp)!=0)
+	    {
+	      writeflag=1;
+	      break;
+	    }
+	  writeflag=writeFITSVisSubset(fptr,0,r0,r1-r0,c0,c1-c0,Nhdu,Vre,Vim,datatype);
+	}
+    }
+
+  free(colFrom);
+  free(rowFrom);
+  free(rowFromConj);
+
+  return writeflag;
+}
+
+/*!
+\brief Reads or writes a block of the scratch file of the out-of-core mode
+
+\details
+It repeats the read or write until the whole block is done, since pread()
+and pwrite() may do only part of it at a time.
+
+\version 1.0
+
+\pre It is called from outOfCoreGroup()
+
+@param fd an int with the file descriptor of the scratch file
+@param writeMode an int with a flag for writing (1) or reading (0)
+@param *buf a pointer to the block in memory
+@param size a size_t with the size of the block (in bytes)
+@param offset an off_t with the position of the block in the scratch file (in bytes)
+
+\return Returns zero if successful, 1 if not
+
+*/
+int scratchIO(int fd, int writeMode, void *buf, size_t size, off_t offset)
+{
+  char *ptr=(char *)buf;                            // the part of the block that is left
+  ssize_t done;                                     // number of bytes read or written by one call
+
+  while (size>0)
+    {
+      done=(writeMode ? pwrite(fd,ptr,size,offset) : pread(fd,ptr,size,offset));
+      if (done<=0)
+	{
+	  printErrorImage2uv(writeMode ? "could not write the scratch file\n" : "could not read the scratch file\n");
+	  return 1;
+	}
+      ptr+=done;
+      size-=done;
+      offset+=done;
+    }
+
+  return 0;
+}
+
+/*!
+\brief Transforms a group of images with the same padded size out of core, with a scratch file
+
+\details
+In the out-of-core mode (-m disk), the complex grid of the transform is 
+kept in a scratch file instead of in memory. The transform is done in two
+passes over the grid, with blocks that fit in the memory budget (-B):
+
+- each block of rows of the padded image is read (see readFITSImageRows()),
+spread to the layout of the input of an in-place transform (see 
+spreadFFTInput()), and its rows are transformed in place; the block is 
+then written to the scratch file in tiles of tileCols columns, each of which
+holds all the NyPad rows of its columns, so that the grid is transposed 
+on disk one block at a time;
+- each tile is read back and its columns are transformed in place, and its
+visibilities are centered, converted (see fftToVis()), and written to the
+output file (see writeHeldVis()) right away.
+
+The tiles with no columns in the window of the u-v grid (-w) are neither
+written nor transformed. The output files have the same visibilities and 
+layout as those of transformGroup(). The scratch file is removed as soon as
+it is created, so that it does not outlive image2uv.
+
+If an image cannot be read or written, an error message is printed and 
+the rest of the images are transformed as usual.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param *opt a pointer to the options
+@param *frames an array with the images of the group
+@param Nframes an int with the number of images in the group
+
+\return Returns zero if all the images were transformed successfully, 1 if not
+
+*/
+int outOfCoreGroup(image2uvOptions *opt, image2uvFrame *frames, int Nframes)
+{
+  int NyPad=frames[0].NyPad, NxPad=frames[0].NxPad; // Size of padded image in 2D
+  int NxFFT=(opt->tmode==0 ? NxPad/2+1 : NxPad);    // number of columns of the FFT output
+  size_t complexSize=(opt->single ? sizeof(fftwf_complex) : sizeof(fftw_complex)); // size of the complex elements
+  int datatype=(opt->single ? TFLOAT : TDOUBLE);    // CFITSIO type of the image and visibility arrays
+  int bitpix=opt->bitpix;                           // type of the images in the output files
+  int wisdomKey=opt->tmode+7;                       // type of transform for the wisdom store
+  int blockRows;                                    // number of rows per block of the first pass
+  int tileCols;                                     // number of columns per tile of the second pass
+  int Ntiles;                                       // number of tiles of columns
+  int *tileNeeded=NULL;                             // flags for the tiles with columns in the window
+  long bufferSize;                                  // number of complex points of the buffer
+  void *buffer=NULL;                                // a block of rows (first pass) or a tile of columns (second pass)
+  void *staging;                                    // the part of a block of rows in one tile, after the block
+  void *Va=NULL, *Vp=NULL;                          // pointers to arrays with amplitude and phase of a block of rows
+  void *Vre[2], *Vim[2];                            // arrays of the HDUs of the output
+  char *comment[2];                                 // descriptions of the HDUs of the output
+  int isComplex[2];                                 // flags for the HDUs with real and imaginary parts
+  int Nhdu;                                         // number of HDUs of the output
+  int outRows;                                      // number of rows per block of the output
+  fftw_plan rowPlan=NULL, colPlan[2]={NULL,NULL};   // plans for the rows of a block and for the columns of a full and the last tile
+  fftwf_plan rowPlanf=NULL, colPlanf[2]={NULL,NULL}; // the same plans in single precision
+  fftw_iodim64 dim, howmanyDim;                     // dimensions of the transforms of the columns of a tile
+  int iFrame,iTile,indexR,indexC;                   // dummy indices for counting images, tiles, rows, and columns
+  int rowStart,Nblock;                              // first row and number of rows of a block of the padded image
+  int firstRow,Nrows;                               // first row (starting from 0) and number of rows of the image in a block
+  int Ncols;                                        // number of columns of a tile
+  int iRowStart,iColStart;                          // Startng row and column of image in the padded image
+  int NyDummy,NxDummy;                              // dummy variables for the size of the padded image
+  int *colFrom=NULL,*rowFrom=NULL,*rowFromConj=NULL; // tables of the columns and rows of the window
+  image2uvWindow win;                               // window of the u-v grid that is written
+  double blockFlux,blockXCent,blockYCent;           // flux and flux-weighted sums of the coordinates of a block
+  double fluxTotal,fluxXCent,fluxYCent;             // total flux and brightness center of an image
+  double compTotal,compX,compY;                     // compensations of the sums over the blocks
+  double zeroBaselineAmp;                           // zero baseline amplitude of an image
+  double vScale,uScale;                             // physical sizes of u-v pixels along the two directions
+  char scratchName[MAXPATH];                        // name of the scratch file
+  char outFileName[MAXPATH];                        // output filename
+  char hist[MAXPATH];                               // string for history in output FITS file
+  int fd=-1;                                        // file descriptor of the scratch file
+  fitsfile *fptr;                                   // pointer to the output FITS file
+  int readflag,writeflag;                           // flags for the result of reading and writing
+  int status=0;                                     // return value
+
+  // the blocks of rows, with their parts in one tile, and the tiles of columns fill the memory budget
+  blockRows=opt->memBudget/(2*complexSize*NxFFT);
+  if (blockRows<1)
+    blockRows=1;
+  if (blockRows>NyPad)
+    blockRows=NyPad;
+  tileCols=opt->memBudget/(complexSize*NyPad);
+  if (tileCols<1)
+    tileCols=1;
+  if (tileCols>NxFFT)
+    tileCols=NxFFT;
+  Ntiles=(NxFFT+tileCols-1)/tileCols;
+  bufferSize=(long)2*blockRows*NxFFT;
+  if ((long)NyPad*tileCols>bufferSize)
+    bufferSize=(long)NyPad*tileCols;
+
+  // the blocks of rows of the output have about LOWMEMBLOCKPIXELS pixels
+  outRows=LOWMEMBLOCKPIXELS/tileCols;
+  if (outRows<1)
+    outRows=1;
+
+  // allocate memory for the buffer, for a block of the output, and for the tables of the window
+  buffer = fftw_malloc(complexSize * bufferSize);
+  Va = malloc(complexSize/2*outRows*tileCols);
+  Vp = (opt->omode<=1 ? malloc(complexSize/2*outRows*tileCols) : Va);
+  tileNeeded = (int *)malloc(sizeof(int)*Ntiles);
+  colFrom = (int *)malloc(sizeof(int)*NxPad);
+  rowFrom = (int *)malloc(sizeof(int)*NyPad);
+  rowFromConj = (int *)malloc(sizeof(int)*NyPad);
+  if (buffer == NULL || Va == NULL || Vp == NULL || tileNeeded == NULL || colFrom == NULL || rowFrom == NULL ||
+      rowFromConj == NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");   // print error message
+      status=1;                               // return with error code
+      goto cleanup;
+    }
+  staging = (char *)buffer + complexSize*blockRows*NxFFT;
+
+  // the scratch file, in the directory of the scratch files
+  snprintf(scratchName,MAXPATH,"%s/image2uv_XXXXXX",(getenv(SCRATCHENV)!=NULL ? getenv(SCRATCHENV) : SCRATCHDIRDEFAULT));
+  fd=mkstemp(scratchName);
+  if (fd<0)
+    {
+      printErrorImage2uv("could not create the scratch file\n");
+      status=1;
+      goto cleanup;
+    }
+  unlink(scratchName);
+
+  if (opt->vmode!=0)
+    printf("image2uv: Transforming %d padded %dx%d image(s) out of core, in blocks of %d rows and tiles of %d columns\n",
+	   Nframes,NxPad,NyPad,blockRows,tileCols);
+
+  // the HDUs of the output, as set by the -O option
+  Nhdu=setOutputHDUs(opt->omode,Va,Vp,Vre,Vim,isComplex,NULL,comment);
+
+  // the rows of the padded images that hold the images
+  ArrayPad(frames[0].Ny, frames[0].Nx, opt->Npad, &iRowStart, &iColStart, &NyDummy, &NxDummy);
+
+  // make the FFTW plans for the transforms in place, before the buffer is filled
+  importWisdom(opt->wisdomDir,wisdomKey,opt->single,NyPad,NxPad,opt->nthreads,1,0,opt->vmode);
+  planRowFFT(opt,blockRows,NxPad,1,0,blockRows,buffer,buffer,buffer,&rowPlan,&rowPlanf);
+  dim.n=NyPad;
+  howmanyDim.is=1;
+  howmanyDim.os=1;
+  for (iTile=0;iTile<2;iTile++)
+    {
+      Ncols=(iTile==0 ? tileCols : NxFFT%tileCols);
+      if (Ncols==0)
+	continue;
+      dim.is=Ncols;
+      dim.os=Ncols;
+      howmanyDim.n=Ncols;
+      if (opt->single)
+	colPlanf[iTile]=fftwf_plan_guru64_dft(1, &dim, 1, &howmanyDim, (fftwf_complex *)buffer,
+					      (fftwf_complex *)buffer, FFTW_FORWARD, opt->planFlags);
+      else
+	colPlan[iTile]=fftw_plan_guru64_dft(1, &dim, 1, &howmanyDim, (fftw_complex *)buffer,
+					    (fftw_complex *)buffer, FFTW_FORWARD, opt->planFlags);
+    }
+  if ((opt->single && (rowPlanf==NULL || colPlanf[0]==NULL)) || (!opt->single && (rowPlan==NULL || colPlan[0]==NULL)))
+    {
+      printErrorImage2uv("FFTW planning failed!\n");
+      status=1;
+      goto cleanup;
+    }
+  if (!(opt->planFlags & FFTW_ESTIMATE))
+    exportWisdom(opt->wisdomDir,wisdomKey,opt->single,NyPad,NxPad,opt->nthreads,1,0,opt->vmode);
+
+  for (iFrame=0;iFrame<Nframes;iFrame++)
+    {
+      // calculate scale of pixels in u-v plane (the scales in the image are in degrees, so they need also
+      // to be converted to rad.
+      uScale=180.0/(NxPad*frames[iFrame].xScale*M_PI);
+      vScale=180.0/(NyPad*frames[iFrame].yScale*M_PI);
+
+      // the window of the u-v grid that is written, and the tiles of columns that it needs
+      setWindow(opt,NyPad,NxPad,uScale,vScale,&win);
+      transposeTables(NyPad,NxPad,(opt->tmode==0),&win,colFrom,rowFrom,rowFromConj);
+      for (iTile=0;iTile<Ntiles;iTile++)
+	tileNeeded[iTile]=0;
+      for (indexC=0;indexC<win.NxOut;indexC++)
+	tileNeeded[(colFrom[indexC]>=0 ? colFrom[indexC] : -colFrom[indexC]-1)/tileCols]=1;
+
+      // first pass: read and transform the rows, one block at a time, and transpose them to the tiles
+      fluxTotal=fluxXCent=fluxYCent=0.0;
+      compTotal=compX=compY=0.0;
+      readflag=writeflag=0;
+      for (rowStart=0;rowStart<NyPad && readflag==0 && writeflag==0;rowStart+=blockRows)
+	{
+	  Nblock=(NyPad-rowStart<blockRows ? NyPad-rowStart : blockRows);
+
+	  // the padding needs to be zero
+	  memset(buffer,0,complexSize*blockRows*NxFFT);
+
+	  // the rows of the image in the block, if any
+	  firstRow=(rowStart>iRowStart-1 ? rowStart-(iRowStart-1) : 0);
+	  Nrows=(rowStart+Nblock<iRowStart-1+frames[iFrame].Ny ? rowStart+Nblock-(iRowStart-1) : frames[iFrame].Ny)-firstRow;
+	  if (Nrows>0)
+	    {
+	      readflag=openFrame(frames+iFrame);
+	      if (readflag==0)
+		readflag=readFITSImageRowsHandle(frames[iFrame].fptr, frames[iFrame].Ny, frames[iFrame].Nx, opt->Npad,
+						 firstRow, Nrows, rowStart, datatype, buffer);
+	      if (readflag!=0)
+		break;
+
+	      // add up the flux and the brightness center, before the block is spread
+	      blockFlux=fillFFTInput(buffer,Nblock,NxPad,opt->single,NULL,NULL,&blockXCent,&blockYCent);
+	      if (isnan(blockFlux))
+		{
+		  writeflag=1;
+		  break;
+		}
+	      compensatedAdd(blockFlux,&fluxTotal,&compTotal);
+	      compensatedAdd(blockXCent,&fluxXCent,&compX);
+	      compensatedAdd(blockYCent+rowStart*blockFlux,&fluxYCent,&compY);
+
+	      spreadFFTInput(buffer,NxPad,iRowStart-1+firstRow-rowStart,Nrows,opt->tmode,opt->single);
+	      if (opt->single)
+		fftwf_execute(rowPlanf);
+	      else
+		fftw_execute(rowPlan);
+	    }
+
+	  // the part of the block in each tile, after the rows of the tile before it
+	  for (iTile=0;iTile<Ntiles && writeflag==0;iTile++)
+	    {
+	      if (!tileNeeded[iTile])
+		continue;
+	      Ncols=(iTile<Ntiles-1 ? tileCols : NxFFT-iTile*tileCols);
+	      for (indexR=0;indexR<Nblock;indexR++)
+		memcpy((char *)staging+complexSize*indexR*Ncols,
+		       (char *)buffer+complexSize*((long)indexR*NxFFT+iTile*tileCols),complexSize*Ncols);
+	      writeflag=scratchIO(fd,1,staging,complexSize*Nblock*Ncols,
+				  (off_t)complexSize*((off_t)iTile*tileCols*NyPad+(off_t)rowStart*Ncols));
+	    }
+	}
+      closeFrame(frames+iFrame);
+      if (readflag!=0)
+	{
+	  printReadErrorImage2uv(frames[iFrame].fileName);   // print error message
+	  status=1;
+	  continue;
+	}
+      if (writeflag!=0)
+	{
+	  status=1;
+	  continue;
+	}
+      if (opt->vmode!=0)
+	printf("image2uv: Read %dx%d image from file %s and transformed its rows\n",frames[iFrame].Nx,frames[iFrame].Ny,
+	       frames[iFrame].fileName);
+
+      fluxTotal+=compTotal;
+      if (fluxTotal!=0.0 && opt->cmode==1)
+	{
+	  fluxXCent=(fluxXCent+compX)/fluxTotal;
+	  fluxYCent=(fluxYCent+compY)/fluxTotal;
+	  if (opt->vmode!=0)
+	    printf("image2uv: brightness center at the (%7.1f,%7.1f) grid point\n",fluxXCent,fluxYCent);
+	}
+      else
+	{
+	  fluxXCent=NxPad/2.0;
+	  fluxYCent=NyPad/2.0;
+	}
+
+      // the output filename and the history of the output file
+      frameOutput(opt,frames+iFrame,outFileName,hist);
+
+      if (createFITSVisMovie(outFileName,win.NyOut,win.NxFull,0,Nhdu,isComplex,NULL,comment,vScale,uScale,
+			     hist,opt->hmode,bitpix,&fptr)!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      // second pass: transform the columns of each tile, and convert and write its visibilities;
+      // the first tile has the zero baseline
+      zeroBaselineAmp=0.0;
+      for (iTile=0;iTile<Ntiles && writeflag==0;iTile++)
+	{
+	  if (!tileNeeded[iTile])
+	    continue;
+	  Ncols=(iTile<Ntiles-1 ? tileCols : NxFFT-iTile*tileCols);
+	  writeflag=scratchIO(fd,0,buffer,complexSize*NyPad*Ncols,(off_t)complexSize*iTile*tileCols*NyPad);
+	  if (writeflag!=0)
+	    break;
+	  if (opt->single)
+	    fftwf_execute(colPlanf[Ncols==tileCols ? 0 : 1]);
+	  else
+	    fftw_execute(colPlan[Ncols==tileCols ? 0 : 1]);
+	  if (iTile==0)
+	    zeroBaselineAmp=(opt->single ? sqrt((double)((float *)buffer)[0]*((float *)buffer)[0]+
+						(double)((float *)buffer)[1]*((float *)buffer)[1]) :
+			     sqrt(((double *)buffer)[0]*((double *)buffer)[0]+((double *)buffer)[1]*((double *)buffer)[1]));
+
+	  win.colOffset=iTile*tileCols;
+	  win.NxHeld=Ncols;
+	  win.zeroBaselineAmp=zeroBaselineAmp;
+	  writeflag=writeHeldVis(buffer,NyPad,NyPad,NxPad,(opt->tmode==0),opt->single,&win,fluxXCent,fluxYCent,
+				 opt->omode,outRows,Va,Vp,Nhdu,Vre,Vim,fptr);
+	}
+      writeflag+=closeFITSVisMovie(fptr);
+      if (writeflag!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      if (opt->vmode!=0)
+	{
+	  printf("image2uv: zero baseline amplitude is %e\n",zeroBaselineAmp);
+	  printf("image2uv: Wrote visibilities to file %s in tiles of %d columns\n",outFileName,tileCols);
+	}
+    }
+
+ cleanup:
+  // destroy the FFTW plans
+  if (rowPlan!=NULL) fftw_destroy_plan(rowPlan);
+  if (rowPlanf!=NULL) fftwf_destroy_plan(rowPlanf);
+  for (iTile=0;iTile<2;iTile++)
+    {
+      if (colPlan[iTile]!=NULL) fftw_destroy_plan(colPlan[iTile]);
+      if (colPlanf[iTile]!=NULL) fftwf_destroy_plan(colPlanf[iTile]);
+    }
+
+  // close (and so remove) the scratch file and free the allocated memory
+  if (fd>=0) close(fd);
+  if (buffer!=NULL) fftw_free(buffer);
+  free(Va);
+  if (Vp!=Va) free(Vp);
+  free(tileNeeded);
+  free(colFrom);
+  free(rowFrom);
+  free(rowFromConj);
+
+  return status;
+}
+
+#ifdef USE_MPI
+/*!
+\brief Transforms a group of images with the same padded size with MPI, each process holding a slab of rows
+
+\details
+When image2uv is built with MPI (make image2uv_mpi) and started on more
+than one process (e.g., mpirun -np 16 image2uv_mpi ...), the FFT buffer of
+the padded image is distributed over the processes in slabs of consecutive
+rows, as set by FFTW (fftw_mpi_local_size_2d()), so that grids that do not
+fit in the memory of one node can be transformed. Each process reads only
+the rows of the image that fall in its slab (see readFITSImageRows()),
+straight into its slab, which is then spread to the layout of the input
+of an in-place transform (see spreadFFTInput()) and transformed in place 
+with the distributed FFTW transforms, whose output rows are distributed 
+in the same way as the input rows.
+
+The total flux and the brightness center are added up over the rows of
+each slab and then over the processes, and the zero baseline amplitude
+is sent by the first process, which holds the row of the zero baseline, 
+to the others. The output file is created by the first process, and each 
+process in turn then writes the visibilities of the window of the u-v 
+grid that come from its slab (see writeHeldVis()). The output files have
+the same visibilities and layout as those of transformGroup().
+
+Since all the processes take part in each transform, an image that cannot
+be read by any of them is skipped by all of them.
+
+\version 1.0
+
+\pre It is called from main(), on all the MPI processes
+
+@param *opt a pointer to the options
+@param *frames an array with the images of the group
+@param Nframes an int with the number of images in the group
+
+\return Returns zero if all the images were transformed successfully, 1 if not
+
+*/
+int mpiGroup(image2uvOptions *opt, image2uvFrame *frames, int Nframes)
+{
+  int NyPad=frames[0].NyPad, NxPad=frames[0].NxPad; // Size of padded image in 2D
+  int NxFFT=(opt->tmode==0 ? NxPad/2+1 : NxPad);    // number of columns of the FFT output
+  size_t realSize=(opt->single ? sizeof(float) : sizeof(double)); // size of the real elements of the arrays
+  int datatype=(opt->single ? TFLOAT : TDOUBLE);    // CFITSIO type of the image and visibility arrays
+  int bitpix=opt->bitpix;                           // type of the images in the output files
+  int wisdomKey=opt->tmode+5;                       // type of transform for the wisdom store
+  int iFrame,iRank;                                 // dummy indices for counting images and processes
+  ptrdiff_t localRows,localStart;                   // number of rows of the slab of this process and its first row
+  ptrdiff_t localSize;                              // number of complex points of the slab
+  void *slab;                                       // the slab of the FFT buffer, with the image and then its transform
+  void *Va, *Vp;                                    // pointers to arrays with amplitude and phase of a block of rows
+  void *Vre[2], *Vim[2];                            // arrays of the HDUs of the output
+  char *comment[2];                                 // descriptions of the HDUs of the output
+  int isComplex[2];                                 // flags for the HDUs with real and imaginary parts
+  int Nhdu;                                         // number of HDUs of the output
+  int blockRows;                                    // number of rows per block of the output
+  fftw_plan plan=NULL;                              // distributed 2D fft plan used in FFTW
+  fftwf_plan planf=NULL;                            // the same plan in single precision
+  int iRowStart,iColStart;                          // Startng row and column of image in the padded image
+  int NyDummy,NxDummy;                              // dummy variables for the size of the padded image
+  int firstRow,Nrows;                               // first row (starting from 0) and number of rows of the image in the slab
+  image2uvWindow win;                               // window of the u-v grid that is written
+  double sums[3];                                   // total flux and flux-weighted sums of the coordinates
+  double fluxXCent,fluxYCent;                       // brightness center of an image
+  double zeroBaselineAmp;                           // zero baseline amplitude of an image
+  double vScale,uScale;                             // physical sizes of u-v pixels along the two directions
+  char outFileName[MAXPATH];                        // output filename
+  char hist[MAXPATH];                               // string for history in output FITS file
+  fitsfile *fptr;                                   // pointer to the output FITS file
+  int readflag,writeflag;                           // flags for the result of reading and writing
+  int status=0;                                     // return value
+
+  // the slab of rows of the FFT of this process
+  if (opt->single)
+    localSize=fftwf_mpi_local_size_2d(NyPad,NxFFT,MPI_COMM_WORLD,&localRows,&localStart);
+  else
+    localSize=fftw_mpi_local_size_2d(NyPad,NxFFT,MPI_COMM_WORLD,&localRows,&localStart);
+  if (localSize<1)                                  // a process may have no rows
+    localSize=1;
+
+  // the blocks of rows of the output have about LOWMEMBLOCKPIXELS pixels
+  blockRows=LOWMEMBLOCKPIXELS/NxPad;
+  if (blockRows<1)
+    blockRows=1;
+
+  // allocate memory for the slab and for a block of rows of the output
+  slab = fftw_malloc(2*realSize * localSize);
+  Va = malloc(realSize*blockRows*NxPad);
+  Vp = (opt->omode<=1 ? malloc(realSize*blockRows*NxPad) : Va);
+  if (slab == NULL || Va == NULL || Vp == NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");   // print error message
+      MPI_Abort(MPI_COMM_WORLD,1);            // the other processes cannot go on without this one
+    }
+
+  if (opt->vmode!=0)
+    printf("image2uv: Transforming %d padded %dx%d image(s) on %d MPI processes, in slabs of %.1f MB\n",
+	   Nframes,NxPad,NyPad,opt->mpiSize,2.0*realSize*localSize/1048576.0);
+
+  // the HDUs of the output, as set by the -O option
+  Nhdu=setOutputHDUs(opt->omode,Va,Vp,Vre,Vim,isComplex,NULL,comment);
+
+  // the rows of the image that fall in the slab
+  ArrayPad(frames[0].Ny, frames[0].Nx, opt->Npad, &iRowStart, &iColStart, &NyDummy, &NxDummy);
+  firstRow=(localStart>iRowStart-1 ? localStart-(iRowStart-1) : 0);
+  Nrows=(localStart+localRows<iRowStart-1+frames[0].Ny ? localStart+localRows-(iRowStart-1) : frames[0].Ny)-firstRow;
+  if (Nrows<0)
+    Nrows=0;
+
+  // the wisdom is imported by the first process and sent to the others
+  if (opt->mpiRank==0)
+    importWisdom(opt->wisdomDir,wisdomKey,opt->single,NyPad,NxPad,opt->nthreads,opt->mpiSize,0,opt->vmode);
+  else if (opt->single)
+    fftwf_forget_wisdom();
+  else
+    fftw_forget_wisdom();
+  if (opt->single)
+    fftwf_mpi_broadcast_wisdom(MPI_COMM_WORLD);
+  else
+    fftw_mpi_broadcast_wisdom(MPI_COMM_WORLD);
+
+  // make the distributed FFTW plan for the transforms in place, before the slab is filled
+  if (opt->single && opt->tmode==0)
+    planf=fftwf_mpi_plan_dft_r2c_2d(NyPad,NxPad,(float *)slab,(fftwf_complex *)slab,MPI_COMM_WORLD,opt->planFlags);
+  else if (opt->single)
+    planf=fftwf_mpi_plan_dft_2d(NyPad,NxPad,(fftwf_complex *)slab,(fftwf_complex *)slab,MPI_COMM_WORLD,
+				FFTW_FORWARD,opt->planFlags);
+  else if (opt->tmode==0)
+    plan=fftw_mpi_plan_dft_r2c_2d(NyPad,NxPad,(double *)slab,(fftw_complex *)slab,MPI_COMM_WORLD,opt->planFlags);
+  else
+    plan=fftw_mpi_plan_dft_2d(NyPad,NxPad,(fftw_complex *)slab,(fftw_complex *)slab,MPI_COMM_WORLD,
+			      FFTW_FORWARD,opt->planFlags);
+  if (plan==NULL && planf==NULL)
+    {
+      printErrorImage2uv("could not make the FFTW plan\n");
+      MPI_Abort(MPI_COMM_WORLD,1);
+    }
+
+  // the wisdom of all the processes is gathered and stored by the first one
+  if (!(opt->planFlags & FFTW_ESTIMATE))
+    {
+      if (opt->single)
+	fftwf_mpi_gather_wisdom(MPI_COMM_WORLD);
+      else
+	fftw_mpi_gather_wisdom(MPI_COMM_WORLD);
+      if (opt->mpiRank==0)
+	exportWisdom(opt->wisdomDir,wisdomKey,opt->single,NyPad,NxPad,opt->nthreads,opt->mpiSize,0,opt->vmode);
+    }
+
+  for (iFrame=0;iFrame<Nframes;iFrame++)
+    {
+      // the padding needs to be zero
+      memset(slab,0,2*realSize*localSize);
+
+      // read the rows of the image in the slab straight into the slab
+      readflag=0;
+      if (Nrows>0)
+	{
+	  readflag=openFrame(frames+iFrame);
+	  if (readflag==0)
+	    readflag=readFITSImageRowsHandle(frames[iFrame].fptr, frames[iFrame].Ny, frames[iFrame].Nx, opt->Npad,
+					     firstRow, Nrows, localStart, datatype, slab);
+	}
+      closeFrame(frames+iFrame);
+      MPI_Allreduce(MPI_IN_PLACE,&readflag,1,MPI_INT,MPI_MAX,MPI_COMM_WORLD);
+      if (readflag!=0)
+	{
+	  if (opt->mpiRank==0)
+	    printReadErrorImage2uv(frames[iFrame].fileName);   // print error message
+	  status=1;
+	  continue;
+	}
+      if (opt->vmode!=0)
+	printf("image2uv: Read %dx%d image from file %s\n",frames[iFrame].Nx,frames[iFrame].Ny,frames[iFrame].fileName);
+
+      // find the brightness center, before the image is spread to the layout of the transform;
+      // the rows of the slab are counted from its first row
+      sums[0]=sums[1]=sums[2]=0.0;
+      if (localRows>0)
+	{
+	  sums[0]=fillFFTInput(slab,localRows,NxPad,opt->single,NULL,NULL,sums+1,sums+2);
+	  sums[2]+=localStart*sums[0];
+	}
+      // a NaN from a process that could not add up its slab is a NaN in the sum of all of them
+      MPI_Allreduce(MPI_IN_PLACE,sums,3,MPI_DOUBLE,MPI_SUM,MPI_COMM_WORLD);
+      if (isnan(sums[0]))
+	{
+	  status=1;
+	  continue;
+	}
+      if (sums[0]!=0.0 && opt->cmode==1)
+	{
+	  fluxXCent=sums[1]/sums[0];
+	  fluxYCent=sums[2]/sums[0];
+	  if (opt->vmode!=0)
+	    printf("image2uv: brightness center at the (%7.1f,%7.1f) grid point\n",fluxXCent,fluxYCent);
+	}
+      else
+	{
+	  fluxXCent=NxPad/2.0;
+	  fluxYCent=NyPad/2.0;
+	}
+
+      // transform the image in place
+      if (Nrows>0)
+	spreadFFTInput(slab,NxPad,iRowStart-1+firstRow-localStart,Nrows,opt->tmode,opt->single);
+      if (opt->single)
+	fftwf_execute(planf);
+      else
+	fftw_execute(plan);
+      if (opt->vmode!=0)
+	printf("image2uv: FFT of padded %dx%d image completed\n",NxPad,NyPad);
+
+      // the zero baseline is in the first row, which is in the slab of the first process
+      zeroBaselineAmp=(opt->single ? sqrt((double)((float *)slab)[0]*((float *)slab)[0]+
+					  (double)((float *)slab)[1]*((float *)slab)[1]) :
+		       sqrt(((double *)slab)[0]*((double *)slab)[0]+((double *)slab)[1]*((double *)slab)[1]));
+      MPI_Bcast(&zeroBaselineAmp,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+
+      // calculate scale of pixels in u-v plane (the scales in the image are in degrees, so they need also
+      // to be converted to rad.
+      uScale=180.0/(NxPad*frames[iFrame].xScale*M_PI);
+      vScale=180.0/(NyPad*frames[iFrame].yScale*M_PI);
+
+      // the window of the u-v grid that is written, with the rows of the slab
+      setWindow(opt,NyPad,NxPad,uScale,vScale,&win);
+      win.rowOffset=localStart;
+      win.zeroBaselineAmp=zeroBaselineAmp;
+
+      // the output filename and the history of the output file
+      frameOutput(opt,frames+iFrame,outFileName,hist);
+
+      // the first process creates the output file
+      writeflag=0;
+      if (opt->mpiRank==0)
+	{
+	  writeflag=createFITSVisMovie(outFileName,win.NyOut,win.NxFull,0,Nhdu,isComplex,NULL,comment,vScale,uScale,
+				       hist,opt->hmode,bitpix,&fptr);
+	  if (writeflag==0)
+	    writeflag=closeFITSVisMovie(fptr);
+	}
+      MPI_Bcast(&writeflag,1,MPI_INT,0,MPI_COMM_WORLD);
+      if (writeflag!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      // and each process in turn writes the visibilities from its slab
+      for (iRank=0;iRank<opt->mpiSize;iRank++)
+	{
+	  if (iRank==opt->mpiRank && writeflag==0 && localRows>0)
+	    {
+	      writeflag=openFITSVisMovie(outFileName,&fptr);
+	      if (writeflag==0)
+		{
+		  writeflag=writeHeldVis(slab,localRows,NyPad,NxPad,(opt->tmode==0),opt->single,&win,
+					 fluxXCent,fluxYCent,opt->omode,blockRows,Va,Vp,Nhdu,Vre,Vim,fptr);
+		  writeflag+=closeFITSVisMovie(fptr);
+		}
+	    }
+	  MPI_Barrier(MPI_COMM_WORLD);
+	}
+      MPI_Allreduce(MPI_IN_PLACE,&writeflag,1,MPI_INT,MPI_MAX,MPI_COMM_WORLD);
+      if (writeflag!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      if (opt->vmode!=0)
+	{
+	  printf("image2uv: zero baseline amplitude is %e\n",zeroBaselineAmp);
+	  printf("image2uv: Wrote visibilities to file %s from %d MPI processes\n",outFileName,opt->mpiSize);
+	}
+    }
+
+  // destroy the FFTW plan
+  if (plan!=NULL) fftw_destroy_plan(plan);
+  if (planf!=NULL) fftwf_destroy_plan(planf);
+
+  // free the allocated memory
+  fftw_free(slab);
+  free(Va);
+  if (Vp!=Va) free(Vp);
+
+  return status;
+}
+#endif
+
+/*!
+\brief Reads an image that is not padded and finds its phase center
+
+\details
+Reads the image of the input file and finds the point with respect to which
+the phases are calculated, i.e., its geometric center or, with the -c option,
+its brightness center (in grid points, starting from 1).
+
+\version 1.0
+
+\pre It is called from sampleGroup() and zoomGroup()
+
+@param *opt a pointer to the options
+@param *frame a pointer to the input image and its sizes
+@param *ImageIn a pointer to the Ny by Nx array which returns the image
+@param *fluxTotal on return, a double with the total flux in the image
+@param *fluxXCent on return, a double with the x-coordinate of the phase center
+@param *fluxYCent on return, a double with the y-coordinate of the phase center
+
+\return Returns zero if successful, 1 if not
+
+*/
+int readFrame(image2uvOptions *opt, image2uvFrame *frame, double *ImageIn,
+	      double *fluxTotal, double *fluxXCent, double *fluxYCent)
+{
+  int readflag;                                     // flag for the result of reading
+
+  readflag=openFrame(frame);
+  if (readflag==0)
+    readflag=readFITSImageRowsHandle(frame->fptr, frame->Ny, frame->Nx, 0, 0, frame->Ny, 0, TDOUBLE, ImageIn);
+  closeFrame(frame);
+  if (readflag!=0)
+    {
+      printReadErrorImage2uv(frame->fileName);   // print error message
+      return 1;
+    }
+  if (opt->vmode!=0)
+    printf("image2uv: Read %dx%d image from file %s\n",frame->Nx,frame->Ny,frame->fileName);
+
+  // find the brightness center of the image
+  *fluxTotal=fillFFTInput(ImageIn,frame->Ny,frame->Nx,0,NULL,NULL,fluxXCent,fluxYCent);
+  if (isnan(*fluxTotal))
+    return 1;
+  if (*fluxTotal!=0.0 && opt->cmode==1)
+    {
+      *fluxXCent/=*fluxTotal;
+      *fluxYCent/=*fluxTotal;
+      if (opt->vmode!=0)
+	printf("image2uv: brightness center at the (%7.1f,%7.1f) grid point\n",*fluxXCent,*fluxYCent);
+    }
+  else
+    {
+      // otherwise just center it
+      *fluxXCent=frame->Nx/2.0;
+      *fluxYCent=frame->Ny/2.0;
+    }
+
+  return 0;
+}
+
+/*!
+\brief Calculates the visibilities of a group of images of the same size at a list of baselines
+
+\details
+All the images in the group share one plan for the non-uniform FFT (see
+nufft.c). For each image, the visibilities are calculated at the Nb 
+baselines (u,v) with respect to the geometric center or, with the -c option,
+the brightness center of the image, and written to a table in its own 
+output file.
+
+The coordinates of the baselines are converted to cycles per pixel using the
+physical sizes of the pixels of each image (in degrees).
+
+If an image cannot be read or written, an error message is printed and 
+the rest of the images are processed as usual.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param *opt a pointer to the options
+@param *frames an array with the images of the group
+@param Nframes an int with the number of images in the group
+@param Nb an int with the number of baselines
+@param *u a pointer to the u-coordinates of the baselines (in wavelengths)
+@param *v a pointer to the v-coordinates of the baselines (in wavelengths)
+
+\return Returns zero if all the images were processed successfully, 1 if not
+
+*/
+int sampleGroup(image2uvOptions *opt, image2uvFrame *frames, int Nframes, int Nb, double *u, double *v)
+{
+  int Ny=frames[0].Ny, Nx=frames[0].Nx;             // size of the images
+  int iFrame,ib;                                    // dummy indices for counting images and baselines
+  double fluxXCent, fluxYCent;                      // brightness center of an image
+  double fluxTotal;                                 // total flux in an image (arb units)
+  double zeroBaselineAmp;                           // amplitude at zero baseline
+  double *ImageIn;                                  // pointer to image array
+  double *xi, *eta;                                 // baselines in cycles per pixel
+  double *Vre, *Vim, *Va, *Vp;                      // pointers to arrays with the visibilities
+  nufftPlan *plan=NULL;                             // plan for the non-uniform FFT
+  char outFileName[MAXPATH];                        // output filename
+  char hist[MAXPATH];                               // string for history in output FITS file
+  int readflag, writeflag;                          // flags for the results of reading and writing
+  int status=0;                                     // return value
+
+  if (opt->vmode!=0 && opt->Nin>1)
+    printf("image2uv: Sampling %d %dx%d image(s) at %d baselines\n",Nframes,Nx,Ny,Nb);
+
+  // allocate memory for the image and the visibilities
+  ImageIn = (double *)malloc(sizeof(double)*Nx*Ny);
+  xi = (double *)malloc(sizeof(double)*Nb);
+  eta = (double *)malloc(sizeof(double)*Nb);
+  Vre = (double *)malloc(sizeof(double)*Nb);
+  Vim = (double *)malloc(sizeof(double)*Nb);
+  Va = (double *)malloc(sizeof(double)*Nb);
+  Vp = (double *)malloc(sizeof(double)*Nb);
+  if (ImageIn == NULL || xi == NULL || eta == NULL || Vre == NULL || Vim == NULL || Va == NULL || Vp == NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");   // print error message
+      status=1;                               // return with error code
+      goto cleanup;
+    }
+
+  // make the plan, reusing the wisdom for the real-to-complex FFT of the oversampled grid
+  importWisdom(opt->wisdomDir,0,0,NUFFTOVERSAMPLE*Ny,NUFFTOVERSAMPLE*Nx,opt->nthreads,1,0,opt->vmode);
+  plan=nufftPlanCreate(Ny,Nx,NUFFTSPREAD,opt->planFlags);
+  if (plan==NULL)
+    {
+      status=1;
+      goto cleanup;
+    }
+  if (!(opt->planFlags & FFTW_ESTIMATE))
+    exportWisdom(opt->wisdomDir,0,0,NUFFTOVERSAMPLE*Ny,NUFFTOVERSAMPLE*Nx,opt->nthreads,1,0,opt->vmode);
+
+  for (iFrame=0;iFrame<Nframes;iFrame++)
+    {
+      // read the image and find its phase center
+      readflag=readFrame(opt,frames+iFrame,ImageIn,&fluxTotal,&fluxXCent,&fluxYCent);
+      if (readflag!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      // convert the baselines to cycles per pixel; the scales in the image are in degrees
+      for (ib=0;ib<Nb;ib++)
+	{
+	  xi[ib]=u[ib]*frames[iFrame].xScale*M_PI/180.0;
+	  eta[ib]=v[ib]*frames[iFrame].yScale*M_PI/180.0;
+	}
+
+      // the grid points of the brightness center start from 1
+      if (nufftExecute(plan,ImageIn,fluxXCent-1.0,fluxYCent-1.0,Nb,xi,eta,Vre,Vim)!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      // convert to the amplitudes and phases, or the power, of the -O option
+      zeroBaselineAmp=fabs(fluxTotal);
+      for (ib=0;ib<Nb && opt->omode!=1;ib++)
+	{
+	  Va[ib]=Vre[ib]*Vre[ib]+Vim[ib]*Vim[ib];
+	  if (opt->omode==3)
+	    continue;
+	  Va[ib]=sqrt(Va[ib]);
+	  if (opt->omode==2)
+	    continue;
+	  if (Va[ib]>MINAMP*zeroBaselineAmp)
+	    Vp[ib]=atan2(Vim[ib],Vre[ib]);
+	  else
+	    Vp[ib]=0.0;
+	}
+
+      if (opt->vmode!=0)
+	printf("image2uv: Non-uniform FFT at %d baselines completed\n",Nb);
+
+      // the output filename and the history of the output file
+      frameOutput(opt,frames+iFrame,outFileName,hist);
+
+      // the real and imaginary parts are always written
+      writeflag=writeFITSVisTable(outFileName,Nb,u,v,Vre,Vim,
+				  (opt->omode==0 || opt->omode==2 ? Va : NULL),
+				  (opt->omode==0 ? Vp : NULL),
+				  (opt->omode==3 ? Va : NULL),hist);
+      if (writeflag!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      if (opt->vmode!=0)
+	printf("image2uv: Wrote visibilities at %d baselines to file %s\n",Nb,outFileName);
+    }
+
+ cleanup:
+  nufftPlanDestroy(plan);
+
+  // free the allocated memory
+  free(ImageIn);
+  free(xi);
+  free(eta);
+  free(Vre);
+  free(Vim);
+  free(Va);
+  free(Vp);
+
+  return status;
+}
+
+/*!
+\brief Calculates the visibilities of a group of images of the same size on a zoomed u-v window
+
+\details
+All the images in the group share one plan for the chirp-z transform (see
+czt.c). For each image, the visibilities are calculated on the Nu by Nv 
+window of the -z option with respect to the geometric center or, with the 
+-c option, the brightness center of the image, and written to its own
+output file in the same format as for a regular u-v grid.
+
+The window is converted to cycles per pixel using the physical sizes of the
+pixels of each image, so the plan is made again whenever the pixel sizes
+change from one image to the next.
+
+The transform is always calculated in double precision; with the -f 32
+option, only the output images are converted to float.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param *opt a pointer to the options
+@param *frames an array with the images of the group
+@param Nframes an int with the number of images in the group
+
+\return Returns zero if all the images were processed successfully, 1 if not
+
+*/
+int zoomGroup(image2uvOptions *opt, image2uvFrame *frames, int Nframes)
+{
+  int Ny=frames[0].Ny, Nx=frames[0].Nx;             // size of the images
+  int Nu=opt->zoomNu, Nv=opt->zoomNv;               // size of the window
+  int iFrame,index;                                 // dummy indices for counting images and points
+  double du,dv;                                     // spacing of the window (in wavelengths)
+  double uvOrigin[2];                               // u and v of the first point of the window
+  double xScale,yScale;                             // pixel sizes (in rad)
+  double fluxXCent, fluxYCent;                      // brightness center of an image
+  double fluxTotal;                                 // total flux in an image (arb units)
+  double zeroBaselineAmp;                           // amplitude at zero baseline
+  double *ImageIn;                                  // pointer to image array
+  double *Va, *Vp;                                  // pointers to arrays with amplitude and phase
+  fftw_complex *V;                                  // pointer to array with the visibilities
+  zoomPlan *plan=NULL;                              // plan for the chirp-z transform
+  char outFileName[MAXPATH];                        // output filename
+  char hist[MAXPATH];                               // string for history in output FITS file
+  int readflag, writeflag;                          // flags for the results of reading and writing
+  int status=0;                                     // return value
+
+  // the spacing and origin of the window
+  du=(Nu>1 ? (opt->zoomWindow[1]-opt->zoomWindow[0])/(Nu-1) : 0.0);
+  dv=(Nv>1 ? (opt->zoomWindow[3]-opt->zoomWindow[2])/(Nv-1) : 0.0);
+  uvOrigin[0]=opt->zoomWindow[0];
+  uvOrigin[1]=opt->zoomWindow[2];
+
+  if (opt->vmode!=0 && opt->Nin>1)
+    printf("image2uv: Zoomed transform of %d %dx%d image(s) on a %dx%d window\n",Nframes,Nx,Ny,Nu,Nv);
+
+  // allocate memory for the image and the visibilities
+  ImageIn = (double *)malloc(sizeof(double)*Nx*Ny);
+  Va = (double *)malloc(sizeof(double)*Nu*Nv);
+  Vp = (double *)malloc(sizeof(double)*Nu*Nv);
+  V = (fftw_complex *)fftw_malloc(sizeof(fftw_complex)*Nu*Nv);
+  if (ImageIn == NULL || Va == NULL || Vp == NULL || V == NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");   // print error message
+      status=1;                               // return with error code
+      goto cleanup;
+    }
+
+  for (iFrame=0;iFrame<Nframes;iFrame++)
+    {
+      // make the plan, with the window in cycles per pixel, unless the pixel sizes are the
+      // same as for the previous image; the scales in the image are in degrees
+      if (plan==NULL || frames[iFrame].xScale!=frames[iFrame-1].xScale ||
+	  frames[iFrame].yScale!=frames[iFrame-1].yScale)
+	{
+	  zoomPlanDestroy(plan);
+	  xScale=frames[iFrame].xScale*M_PI/180.0;
+	  yScale=frames[iFrame].yScale*M_PI/180.0;
+	  importWisdom(opt->wisdomDir,2,0,cztLength(Ny+Nv-1),cztLength(Nx+Nu-1),opt->nthreads,Ny,Nu,opt->vmode);
+	  plan=zoomPlanCreate(Ny,Nx,Nv,Nu,uvOrigin[1]*yScale,dv*yScale,uvOrigin[0]*xScale,du*xScale,opt->planFlags);
+	  if (plan==NULL)
+	    {
+	      status=1;
+	      goto cleanup;
+	    }
+	  if (!(opt->planFlags & FFTW_ESTIMATE))
+	    exportWisdom(opt->wisdomDir,2,0,cztLength(Ny+Nv-1),cztLength(Nx+Nu-1),opt->nthreads,Ny,Nu,opt->vmode);
+	}
+
+      // read the image and find its phase center
+      readflag=readFrame(opt,frames+iFrame,ImageIn,&fluxTotal,&fluxXCent,&fluxYCent);
+      if (readflag!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      // the grid points of the brightness center start from 1
+      if (zoomExecute(plan,ImageIn,fluxXCent-1.0,fluxYCent-1.0,V)!=0)
+	{
+	  status=1;
+	  continue;
+	}
+
+      // convert to the quantities of the -O option
+      zeroBaselineAmp=fabs(fluxTotal);
+      for (index=0;index<Nu*Nv;index++)
+	{
+	  if (opt->omode==1)        // real and imaginary parts
+	    {
+	      Va[index]=V[index][0];
+	      Vp[index]=V[index][1];
+	      continue;
+	    }
+	  Va[index]=V[index][0]*V[index][0]+V[index][1]*V[index][1];
+	  if (opt->omode==3)        // power
+	    continue;
+	  Va[index]=sqrt(Va[index]);
+	  if (opt->omode==2)        // amplitudes
+	    continue;
+	  if (Va[index]>MINAMP*zeroBaselineAmp)
+	    Vp[index]=atan2(V[index][1],V[index][0]);
+	  else
+	    Vp[index]=0.0;
+	}
+
+      if (opt->vmode!=0)
+	printf("image2uv: Zoomed transform on a %dx%d window completed\n",Nu,Nv);
+
+      // the output filename and the history of the output file
+      frameOutput(opt,frames+iFrame,outFileName,hist);
+
+      writeflag=writeVisOutput(opt,outFileName,Nv,Nu,Va,Vp,dv,du,hist,0,uvOrigin,
+			       TDOUBLE,opt->bitpix);
+      if (writeflag!=0)
+	status=1;
+    }
+
+ cleanup:
+  zoomPlanDestroy(plan);
+
+  // free the allocated memory
+  free(ImageIn);
+  free(Va);
+  free(Vp);
+  if (V!=NULL) fftw_free(V);
+
+  return status;
+}
+
+/*!
+\brief Reads a frame of a movie and fills the input of its FFT
+
+\details
+Reads the image of a frame, from a 2D image or from a plane along the
+time axis of a cube, and fills the input array of the FFT with it (see
+fillFFTInput()). It also finds the point with respect to which the phases
+are calculated, i.e., the center of the padded image or, with the -c
+option, the brightness center of the frame (in grid points, starting 
+from 1).
+
+CFITSIO is not reentrant unless it is built to be, so the file is read
+with the lock fitsLock held, which the writing of the output holds too.
+
+\version 1.0
+
+\pre It is called from readMovieThread()
+
+@param *opt a pointer to the options
+@param *frame a pointer to the frame and its sizes
+@param *ImageIn a pointer to the padded image array
+@param *inReal a pointer to the input array of a real-to-complex FFT (NULL for c2c)
+@param *in a pointer to the input array of a complex-to-complex FFT (NULL for r2c)
+@param *fluxXCent on return, a double with the x-coordinate of the phase center
+@param *fluxYCent on return, a double with the y-coordinate of the phase center
+@param *fitsLock a pointer to the lock of the calls to CFITSIO
+
+\return Returns zero if successful, 1 if not
+
+*/
+int readMovieFrame(image2uvOptions *opt, image2uvFrame *frame, void *ImageIn, void *inReal, void *in,
+		   double *fluxXCent, double *fluxYCent, pthread_mutex_t *fitsLock)
+{
+  size_t realSize=(opt->single ? sizeof(float) : sizeof(double)); // size of the real elements of the arrays
+  int datatype=(opt->single ? TFLOAT : TDOUBLE);    // CFITSIO type of the image array
+  double fluxTotal;                                 // total flux in the frame (arb units)
+  int readflag;                                     // flag for the result of reading
+
+  // the padding needs to be zero
+  memset(ImageIn,0,realSize*frame->NyPad*frame->NxPad);
+
+  pthread_mutex_lock(fitsLock);
+  readflag=readFITSCube(frame->fileName, frame->Ny, frame->Nx, opt->Npad, "TIME", frame->plane, 1,
+			datatype, ImageIn);
+  pthread_mutex_unlock(fitsLock);
+
+  if (readflag!=0)
+    {
+      printReadErrorImage2uv(frame->fileName);   // print error message
+      return 1;
+    }
+  if (opt->vmode!=0)
+    printf("image2uv: Read %dx%d frame %d from file %s\n",frame->Nx,frame->Ny,frame->plane,frame->fileName);
+
+  fluxTotal=fillFFTInput(ImageIn,frame->NyPad,frame->NxPad,opt->single,inReal,in,fluxXCent,fluxYCent);
+  if (isnan(fluxTotal))
+    return 1;
+
+  // if there is some flux in the frame and the centering option is on
+  if (fluxTotal!=0.0 && opt->cmode==1)
+    {
+      *fluxXCent/=fluxTotal;
+      *fluxYCent/=fluxTotal;
+    }
+  else
+    {
+      *fluxXCent=frame->NxPad/2.0;
+      *fluxYCent=frame->NyPad/2.0;
+    }
+
+  return 0;
+}
+
+/*!
+\brief Reads a frame of a movie, as the reading stage of the pipeline of movieGroup()
+
+\details
+Reads the frame m->iStep into the input buffers m->iStep%2 (see 
+readMovieFrame()), and keeps its flag and its phase center in the
+entries m->iStep%3. The loops over the frame use up to -j OpenMP threads,
+which need to be set on each thread that starts parallel regions.
+
+\version 1.0
+
+\pre It is called from movieGroup(), on a thread of its own
+
+@param *arg a pointer to the state of the pipeline (image2uvMovie)
+
+\return Returns NULL
+
+*/
+void *readMovieThread(void *arg)
+{
+  image2uvMovie *m=(image2uvMovie *)arg;            // the state of the pipeline
+  int iStep=m->iStep;                               // the frame that is read
+
+#ifdef _OPENMP
+  omp_set_num_threads(m->opt->nthreads);
+#endif
+  m->frameOK[iStep%3]=(readMovieFrame(m->opt,m->frames+iStep,m->ImageIn,m->inReal[iStep%2],m->in[iStep%2],
+				      m->fluxXCent+iStep%3,m->fluxYCent+iStep%3,&m->fitsLock)==0);
+  if (!m->frameOK[iStep%3])
+    m->readStatus=1;
+
+  return NULL;
+}
+
+/*!
+\brief Converts and writes a frame of a movie, as the writing stage of the pipeline of movieGroup()
+
+\details
+Converts the FFT of the frame m->iStep-2, in the output buffer 
+m->iStep%2, to visibilities (see fftToVis()) and writes them to their
+plane of the output file, with the lock of the calls to CFITSIO held.
+A frame that could not be read is skipped. The conversion uses up to -j
+OpenMP threads, which need to be set on each thread that starts parallel
+regions.
+
+\version 1.0
+
+\pre It is called from movieGroup(), on a thread of its own
+
+@param *arg a pointer to the state of the pipeline (image2uvMovie)
+
+\return Returns NULL
+
+*/
+void *writeMovieThread(void *arg)
+{
+  image2uvMovie *m=(image2uvMovie *)arg;            // the state of the pipeline
+  int iFrame=m->iStep-2;                            // the frame that is written
+  image2uvOptions *opt=m->opt;                      // the options
+  double zeroBaselineAmp;                           // zero baseline amplitude of the frame
+  int writeflag;                                    // flag for the result of writing
+
+  if (!m->frameOK[iFrame%3])
+    return NULL;
+
+#ifdef _OPENMP
+  omp_set_num_threads(opt->nthreads);
+#endif
+  if (fftToVis(m->out[iFrame%2],m->NyPad,m->NxPad,(opt->tmode==0),opt->single,&m->win,
+	       m->fluxXCent[iFrame%3],m->fluxYCent[iFrame%3],opt->omode,m->Va,m->Vp,&zeroBaselineAmp)!=0)
+    {
+      m->writeStatus=1;
+      return NULL;
+    }
+
+  pthread_mutex_lock(&m->fitsLock);
+  writeflag=writeFITSVisMovieFrame(m->fptr,m->win.NyOut,m->win.NxFull,opt->hmode,iFrame,m->Nhdu,m->Vre,m->Vim,
+				   (opt->single ? TFLOAT : TDOUBLE));
+  pthread_mutex_unlock(&m->fitsLock);
+  if (writeflag!=0)
+    m->writeStatus=1;
+
+  return NULL;
+}
+
+/*!
+\brief Transforms the frames of a movie into one time-indexed cube of visibilities
+
+\details
+The frames are the planes along the time axis of 3D or 4D cubes or 2D
+images, in the order in which they were given, and all need to have the
+same size; the u-v grid is set by the pixel sizes of the first frame.
+Their visibilities are written, one frame at a time, into the Nframes
+planes along the last (TIME) axis of the cubes of one output file (see
+createFITSVisMovie()): the HDUs AMP and PHASE, the HDU VIS with the real
+and imaginary parts along a COMPLEX third axis, or the HDU AMP or POWER,
+as set by the -O option. A frame that cannot be read is reported and
+left as zeros.
+
+The frames go through a pipeline of three stages, reading (and filling the
+input of the FFT), FFT, and converting (and writing), with two sets of FFT
+buffers and plans used in turn: while frame k is transformed, frame k+1
+is read into the other input buffer and frame k-1 is converted from the
+other output buffer and written. At each step the reading and the writing
+stages run on threads of their own (see readMovieThread() and 
+writeMovieThread()), each with its own OpenMP threads for its loops, and
+the FFT runs on the calling thread with the FFTW threads, so that the
+stages overlap with or without OpenMP and the peak memory is that of a
+few frames, however long the movie is. If a thread cannot be started, 
+its stage runs on the calling thread instead.
+
+\version 1.0
+
+\pre It is called from main()
+
+@param *opt a pointer to the options
+@param *frames an array with the frames, in time order
+@param Nframes an int with the number of frames
+
+\return Returns zero if all the frames were transformed successfully, 1 if not
+
+*/
+int movieGroup(image2uvOptions *opt, image2uvFrame *frames, int Nframes)
+{
+  int NyPad=frames[0].NyPad, NxPad=frames[0].NxPad; // Size of padded image in 2D
+  int NxFFT=(opt->tmode==0 ? NxPad/2+1 : NxPad);    // number of columns of the FFT output
+  long frameSize=(long)NyPad*NxPad;                 // number of points of each padded image
+  long outSize=(long)NyPad*NxFFT;                   // number of points of each FFT output
+  size_t realSize=(opt->single ? sizeof(float) : sizeof(double)); // size of the real elements of the arrays
+  int bitpix=opt->bitpix;                           // type of the images in the output file
+  int iFrame,iStep,slot;                            // dummy indices for the frames, the steps, and the buffers
+  image2uvMovie m;                                  // the state of the pipeline, shared with its threads
+  pthread_t reader,writer;                          // the threads of the reading and the writing stages
+  int reading,writing;                              // flags for the stages that run on their threads
+  image2uvFFTPlan p[2];                             // 2D fft plans used in FFTW, one per set of buffers
+  int iRowStart,iColStart;                          // Startng row and column of image in the padded image
+  int NyDummy,NxDummy;                              // dummy variables for the size of the padded image
+  int Ku;                                           // largest |u-index| of the window
+  double vScale,uScale;                             // physical sizes of u-v pixels along the two directions
+  int isComplex[2];                                 // flags for the HDUs with real and imaginary parts
+  char *extname[2], *comment[2];                    // names and descriptions of the HDUs
+  char hist[MAXPATH];                               // string for history in output FITS file
+  int status=0;                                     // return value
+
+  for (iFrame=1;iFrame<Nframes;iFrame++)
+    if (frames[iFrame].Nx!=frames[0].Nx || frames[iFrame].Ny!=frames[0].Ny)
+      {
+	printErrorImage2uv("all the frames of a movie need to have the same size\n");
+	return 1;
+      }
+
+  // nothing allocated and no plans yet, so that only what was made is freed
+  memset(&m,0,sizeof m);
+  memset(p,0,sizeof p);
+  m.opt=opt;
+  m.frames=frames;
+  m.NyPad=NyPad;
+  m.NxPad=NxPad;
+
+  // the u-v grid of the first frame, and the window that is written
+  uScale=180.0/(NxPad*frames[0].xScale*M_PI);
+  vScale=180.0/(NyPad*frames[0].yScale*M_PI);
+  Ku=setWindow(opt,NyPad,NxPad,uScale,vScale,&m.win);
+
+  if (opt->vmode!=0)
+    printf("image2uv: Transforming a movie of %d padded %dx%d frame(s)\n",Nframes,NxPad,NyPad);
+
+  // allocate memory for the image, the visibilities, and the two sets of FFT buffers
+  m.ImageIn = malloc(realSize*frameSize);
+  m.Va = malloc(realSize*frameSize);
+  m.Vp = (opt->omode<=1 ? malloc(realSize*frameSize) : m.Va);
+  if (m.ImageIn == NULL || m.Va == NULL || m.Vp == NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");   // print error message
+      status=1;                               // return with error code
+      goto cleanup;
+    }
+  for (slot=0;slot<2;slot++)
+    {
+      if (opt->tmode==0)
+	m.inReal[slot] = fftw_malloc(realSize * frameSize);
+      else
+	m.in[slot] = fftw_malloc(2*realSize * frameSize);
+      m.out[slot] = fftw_malloc(2*realSize * outSize);
+      if ((m.inReal[slot] == NULL && m.in[slot] == NULL) || m.out[slot] == NULL)
+	{
+	  printErrorImage2uv("malloc failed!\n");   // print error message
+	  status=1;                               // return with error code
+	  goto cleanup;
+	}
+    }
+
+  // the rows of the padded images that hold the frames
+  ArrayPad(frames[0].Ny, frames[0].Nx, opt->Npad, &iRowStart, &iColStart, &NyDummy, &NxDummy);
+
+  // make the FFTW plans for each set of buffers, before the pipeline starts
+  for (slot=0;slot<2;slot++)
+    if (planFFT(opt,NyPad,NxPad,1,iRowStart-1,frames[0].Ny,Ku,0,m.inReal[slot],m.in[slot],m.out[slot],p+slot)!=0)
+      {
+	status=1;
+	goto cleanup;
+      }
+
+  // the HDUs of the output file, as set by the -O option
+  m.Nhdu=setOutputHDUs(opt->omode,m.Va,m.Vp,m.Vre,m.Vim,isComplex,extname,comment);
+
+  // create a history string to include in the FITS output
+  snprintf(hist,sizeof(hist),"Created from Movie of %d Frames in File: %s",Nframes,frames[0].fileName);
+
+  if (createFITSVisMovie(opt->outFileName,m.win.NyOut,m.win.NxFull,Nframes,m.Nhdu,isComplex,extname,comment,
+			 vScale,uScale,hist,opt->hmode,bitpix,&m.fptr)!=0)
+    {
+      status=1;
+      goto cleanup;
+    }
+
+  // at step iStep, frame iStep is read into the buffers iStep%2, frame iStep-1 is
+  // transformed in the buffers (iStep-1)%2, and frame iStep-2 is converted from the
+  // buffers iStep%2 and written; the flags and centers are kept for three frames
+  pthread_mutex_init(&m.fitsLock,NULL);
+  for (iStep=0;iStep<Nframes+2;iStep++)
+    {
+      m.iStep=iStep;
+      reading=(iStep<Nframes && pthread_create(&reader,NULL,readMovieThread,&m)==0);
+      if (iStep<Nframes && !reading)
+	readMovieThread(&m);
+      writing=(iStep>=2 && pthread_create(&writer,NULL,writeMovieThread,&m)==0);
+      if (iStep>=2 && !writing)
+	writeMovieThread(&m);
+
+      if (iStep>=1 && iStep-1<Nframes && m.frameOK[(iStep-1)%3])
+	executeFFT(p+(iStep-1)%2,1,NyPad,NxFFT,m.out[(iStep-1)%2]);
+
+      if (reading)
+	pthread_join(reader,NULL);
+      if (writing)
+	pthread_join(writer,NULL);
+    }
+  pthread_mutex_destroy(&m.fitsLock);
+
+  if (closeFITSVisMovie(m.fptr)!=0)
+    m.writeStatus=1;
+  if (opt->vmode!=0 && m.writeStatus==0)
+    printf("image2uv: Wrote visibility movie of %d frame(s) to file %s\n",Nframes,opt->outFileName);
+  status=(m.readStatus || m.writeStatus);
+
+ cleanup:
+  // destroy the FFTW plans and free the allocated memory
+  for (slot=0;slot<2;slot++)
+    {
+      destroyFFT(p+slot);
+      if (m.in[slot]!=NULL) fftw_free(m.in[slot]);
+      if (m.inReal[slot]!=NULL) fftw_free(m.inReal[slot]);
+      if (m.out[slot]!=NULL) fftw_free(m.out[slot]);
+    }
+  free(m.ImageIn);
+  if (m.Vp!=m.Va) free(m.Vp);
+  free(m.Va);
+
+  return status;
+}
+
+/*!
+ \brief Main program
+
+ \author Dimitrios Psaltis
+
+ \version 1.0
+
+ \date September 30, 2017
+
+ \pre Nothing
+
+ */
+int main(int argc, char *argv[])
+{
+  image2uvOptions opt;                              // options set on the command line
+  image2uvFrame *frames=NULL;                       // input images and their sizes
+  image2uvFrame *moreFrames;                        // input images, after the planes of a movie cube are added
+  int Nframes=0;                                    // number of input images that can be read
+  int iFrame,iGroup;                                // dummy indices for counting images
+  int iPlane,Nplanes=1;                             // dummy index and number of the frames of a movie cube
+  int Nopen=0;                                      // number of input files kept open after reading their sizes
+  int iColStart,iRowStart;                          // Startng row and column of padded image
+  int readflag;                                     // flag for the result of reading a file
+  int status=0;                                     // return value
+  int dummyResult;                                  // dummy variable for integer results of functions
+  int Nb=0;                                         // number of baselines
+  double *u=NULL, *v=NULL;                          // baselines (in wavelengths)
+  int parseflag;                                    // flag for the result of parsing the command line
+  fitsPrefetch prefetch;                            // prefetcher of the input files
+  fitsIndex index;                                  // catalog of the metadata of the input files
+  int Nindexed=0;                                   // number of input files found in the catalog
+  int fftwReady=0;                                  // flag for whether the FFTW threads were set up
+#ifdef USE_MPI
+  int threadLevel;                                  // level of thread support of the MPI library
+
+  // only the main thread of each process calls MPI
+  MPI_Init_thread(&argc,&argv,MPI_THREAD_FUNNELED,&threadLevel);
+#endif
+	  
+  // parse the command line
+  parseflag=parse(argc, argv, &opt);
+
+  // if there was an error in parsing, return with an error code
+  if (parseflag!=0)
+    {
+      status=1;
+      goto cleanup;
+    }
+
+#ifdef USE_MPI
+  if (opt.mpiSize>1)
+    {
+      if (opt.smode || opt.mmode || opt.zmode || opt.baselineFile[0]!='\0' || opt.lowmem || opt.compression.type!=0 ||
+	  isFITSPipe(opt.inFileNames[0]) || isFITSPipe(opt.outFileName))
+	{
+	  if (opt.mpiRank==0)
+	    printErrorImage2uv("-S, -M, -z, -b, -C, -m low, -m disk, and the standard input and output cannot be used with more than one MPI process\n");
+	  status=1;
+	  goto cleanup;
+	}
+      // only the first process prints, and the options cannot be asked for again
+      if (opt.mpiRank!=0)
+	opt.vmode=0;
+      else if (opt.vmode==2)
+	opt.vmode=1;
+    }
+#endif
+
+  // if in verbose mode, ask for all the inputs again
+  if (opt.vmode==2)
+    verboseinput((opt.Nin==1 || opt.mmode ? opt.outFileName : NULL), &opt.vmode, &opt.cmode, &opt.Npad);
+
+  // at a list of baselines or on a zoomed window, the image is not padded
+  if (opt.zmode)
+    opt.Npad=0;
+  if (opt.baselineFile[0]!='\0')
+    {
+      opt.Npad=0;
+      if (readBaselines(opt.baselineFile,&Nb,&u,&v)!=0)
+	{
+	  status=1;
+	  goto cleanup;
+	}
+      if (opt.vmode!=0)
+	printf("image2uv: Read %d baselines from file %s\n",Nb,opt.baselineFile);
+    }
+
+  // the sizes of the input files are taken from their catalog, if one is given
+  if (opt.indexFile[0]!='\0')
+    {
+      if (readFITSIndex(opt.indexFile,&index)!=0)
+	{
+	  if (opt.mpiRank==0)
+	    printErrorImage2uv("reading the catalog of the input files failed!\n");
+	  status=1;
+	  goto cleanup;
+	}
+      opt.index=&index;
+    }
+
+  // set up the threads for FFTW and for the loops over the arrays
+  if (opt.nthreads>1)
+    {
+      if (fftw_init_threads()==0 || (opt.single && fftwf_init_threads()==0))
+	{
+	  printErrorImage2uv("could not initialize the FFTW threads\n");
+	  status=1;
+	  goto cleanup;
+	}
+      // all the plans made from now on use these threads
+      fftw_plan_with_nthreads(opt.nthreads);
+      if (opt.single)
+	fftwf_plan_with_nthreads(opt.nthreads);
+      if (opt.vmode!=0)
+	printf("image2uv: Using %d threads\n",opt.nthreads);
+    }
+#ifdef _OPENMP
+  omp_set_num_threads(opt.nthreads);
+#else
+  // only FFTW has its own threads, everything else runs on one thread
+  if (opt.nthreads>1 && opt.mpiRank==0)
+    printErrorImage2uv("built without OpenMP, so only the FFTs use more than one thread\n");
+#endif
+#ifdef USE_MPI
+  // after the FFTW threads, as FFTW requires
+  fftw_mpi_init();
+  if (opt.single)
+    fftwf_mpi_init();
+#endif
+  fftwReady=1;
+
+  frames=(image2uvFrame *)malloc(sizeof(image2uvFrame)*opt.Nin);
+  if (frames==NULL)
+    {
+      printErrorImage2uv("malloc failed!\n");   // print error message
+      status=1;                               // return with error code
+      goto cleanup;
+    }
+  
+  // the outputs are written while other files are read only if CFITSIO is thread-safe
+  if (opt.writeQueue>0 && !fits_is_reentrant())
+    {
+      if (opt.vmode!=0 && opt.Nin>1)
+	printf("image2uv: CFITSIO is not reentrant; writing the outputs in the foreground\n");
+      opt.writeQueue=0;
+    }
+
+  // in batch mode, the input files are prefetched ahead of the ones that are read
+  if (opt.Nin>1 && startFITSPrefetch(&prefetch)==0)
+    {
+      opt.prefetch=&prefetch;
+      for (iFrame=1;iFrame<PREFETCHDEPTH && iFrame<opt.Nin;iFrame++)
+	queueFITSPrefetch(opt.prefetch,opt.inFileNames[iFrame]);
+    }
+
+  // in batch mode, create the directory of the output files, if needed
+  if (opt.Nin>1 && !opt.mmode && mkdir(opt.outDir,0755)!=0 && errno!=EEXIST)
+    {
+      if (opt.mpiRank==0)
+	printErrorImage2uv("could not create the output directory\n");
+      status=1;
+      goto cleanup;
+    }
+  
+  // read the size (in 2D) of all the input files
+  for (iFrame=0;iFrame<opt.Nin;iFrame++)
+    {
+      image2uvFrame *frame=frames+Nframes;
+
+      if (iFrame+PREFETCHDEPTH<opt.Nin)
+	queueFITSPrefetch(opt.prefetch,opt.inFileNames[iFrame+PREFETCHDEPTH]);
+      frame->fileName=opt.inFileNames[iFrame];
+      frame->order=iFrame;
+      frame->xScale=0.0;
+      frame->yScale=0.0;
+      frame->Nstokes=1;
+      frame->plane=0;
+      frame->fptr=NULL;
+      if (indexedFrame(&opt,frame,&Nplanes))
+	{
+	  readflag=0;
+	  Nindexed++;
+	}
+      else if (opt.mmode)
+	readflag=readFITSCubedim(frame->fileName, &frame->Ny, &frame->Nx, "TIME", &Nplanes,
+				 &frame->yScale,&frame->xScale);
+      else if (opt.smode)
+	readflag=readFITSCubedim(frame->fileName, &frame->Ny, &frame->Nx, "STOKES", &frame->Nstokes,
+				 &frame->yScale,&frame->xScale);
+      else
+	{
+	  // open the 2D image once, and keep it open until it is read, if not too many are open
+	  readflag=openFrame(frame);
+	  if (readflag==0)
+	    readflag=readFITSImagedimHandle(frame->fptr, &frame->Ny, &frame->Nx,&frame->yScale,&frame->xScale);
+	  if (readflag!=0 || Nopen>=MAXOPENINPUTS)
+	    closeFrame(frame);
+	  else
+	    Nopen++;
+	}
+
+      // if there is a problem
+      if (readflag!=0)
+	{
+	  printReadErrorImage2uv(frame->fileName);   // print error message
+	  status=1;
+	  continue;
+	}
+      
+      // if there was no physical scale in the image, just set it to unity
+      if (frame->xScale==0 || frame->yScale==0)
+	{
+	  frame->xScale=1.0;
+	  frame->yScale=1.0;
+	}
+
+      // only I, Q, U, and V are transformed
+      if (frame->Nstokes>MAXSTOKES)
+	frame->Nstokes=MAXSTOKES;
+
+      // figure out padding
+      dummyResult=ArrayPad(frame->Ny, frame->Nx, opt.Npad, &iRowStart, &iColStart, &frame->NyPad, &frame->NxPad);  
+
+      Nframes++;
+
+      // each plane along the time axis of a movie cube is a frame
+      if (opt.mmode && Nplanes>1)
+	{
+	  moreFrames=(image2uvFrame *)realloc(frames,sizeof(image2uvFrame)*(Nframes+Nplanes-1+opt.Nin-iFrame-1));
+	  if (moreFrames==NULL)
+	    {
+	      printErrorImage2uv("malloc failed!\n");   // print error message
+	      status=1;                               // return with error code
+	      goto cleanup;
+	    }
+	  frames=moreFrames;
+	  for (iPlane=1;iPlane<Nplanes;iPlane++)
+	    {
+	      frames[Nframes]=frames[Nframes-1];
+	      frames[Nframes].plane=iPlane;
+	      Nframes++;
+	    }
+	}
+    }
+
+  if (opt.index!=NULL && opt.vmode!=0)
+    printf("image2uv: Took the sizes of %d of %d input files from the catalog %s\n",Nindexed,opt.Nin,opt.indexFile);
+
+  // the frames of a movie are transformed in the order in which they were given
+  if (opt.mmode)
+    {
+      if (Nframes>0 && movieGroup(&opt,frames,Nframes)!=0)
+	status=1;
+      Nframes=0;
+    }
+
+  // group the images by padded size, so that each group shares one plan
+  qsort(frames,Nframes,sizeof(image2uvFrame),compareFrames);
+
+  for (iFrame=0;iFrame<Nframes;iFrame=iGroup)
+    {
+      // find the end of the group of images with the same padded size and size
+      for (iGroup=iFrame;iGroup<Nframes;iGroup++)
+	if (frames[iGroup].NyPad!=frames[iFrame].NyPad || frames[iGroup].NxPad!=frames[iFrame].NxPad ||
+	    frames[iGroup].Ny!=frames[iFrame].Ny || frames[iGroup].Nx!=frames[iFrame].Nx ||
+	    frames[iGroup].Nstokes!=frames[iFrame].Nstokes)
+	  break;
+
+      if (Nb>0)
+	{
+	  if (sampleGroup(&opt,frames+iFrame,iGroup-iFrame,Nb,u,v)!=0)
+	    status=1;
+	}
+      else if (opt.zmode)
+	{
+	  if (zoomGroup(&opt,frames+iFrame,iGroup-iFrame)!=0)
+	    status=1;
+	}
+#ifdef USE_MPI
+      else if (opt.mpiSize>1)
+	{
+	  if (mpiGroup(&opt,frames+iFrame,iGroup-iFrame)!=0)
+	    status=1;
+	}
+#endif
+      else if (opt.lowmem==2)
+	{
+	  if (outOfCoreGroup(&opt,frames+iFrame,iGroup-iFrame)!=0)
+	    status=1;
+	}
+      else if (opt.lowmem)
+	{
+	  if (lowMemoryGroup(&opt,frames+iFrame,iGroup-iFrame)!=0)
+	    status=1;
+	}
+      else if (transformGroup(&opt,frames+iFrame,iGroup-iFrame)!=0)
+	status=1;
+    }
+
+ cleanup:
+  // close any input files that were not read, e.g., because a group failed
+  for (iFrame=0;iFrame<Nframes;iFrame++)
+    closeFrame(frames+iFrame);
+  if (opt.prefetch!=NULL)
+    stopFITSPrefetch(opt.prefetch);
+
+  // free the allocated memory
+  for (iFrame=0;iFrame<opt.Nin;iFrame++)
+    free(opt.inFileNames[iFrame]);
+  free(opt.inFileNames);
+  free(frames);
+  if (opt.index!=NULL)
+    freeFITSIndex(opt.index);
+  free(u);
+  free(v);
+#ifdef USE_MPI
+  if (fftwReady)
+    {
+      fftw_mpi_cleanup();
+      if (opt.single)
+	fftwf_mpi_cleanup();
+    }
+#endif
+  if (fftwReady && opt.nthreads>1)
+    {
+      fftw_cleanup_threads();
+      if (opt.single)
+	fftwf_cleanup_threads();
+    }
+#ifdef USE_MPI
+  MPI_Finalize();
+#endif
+
+  return status;                                     // normal return
 }
@@ -3,11 +3,17 @@
 #include<stdlib.h>
 #include<unistd.h>
 #include<string.h>
+#include<stdint.h>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<pthread.h>
 
 #define RED "\x1B[31m"                   //!< color RED for error output
 #define RESETCOLOR "\x1B[0m"             //!< color to reset to normal
+#define HCOMPTILEROWS 16                 //!< number of rows per tile of the images compressed with HCOMPRESS
 
-#include "fitsio.h"
+#include "io.h"
 /*! \file
   \brief 
   Subroutines to perform I/O with FITS, OIFITS, etc. files
@@ -90,75 +96,38 @@ void printErrorIO(char errmsg[])
 int readFITSImagedim(char fname[], int *Ny, int *Nx, double *yScale, double *xScale)
 {
   fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
-  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
-
-  int bitpix;              // data type for pixel values
-  int naxis;               // number of axes
-  long naxes[2] = {1,1};   // dimension of each axis
-  char keyname[80],value[80],comment[80]; // strings for reading keywords from FITS file
-  char *ptr;                     // pointer used for converting strings to numbers
+  int status;       // CFITSIO status value
 
   // open file as READONLY
-  if (!fits_open_file(&fptr, fname, READONLY, &status))
+  status=openFITSImage(fname, &fptr);
+  if (status==0)
     {
-      // get the parameters of the image
-      if (!fits_get_img_param(fptr, 2, &bitpix, &naxis, naxes, &status) )
-        {
-          if (naxis!=2)   // we will only be using 2D images
-	    printErrorIO("readFITS: only 2D images are supported\n");
-	  else
-	    {
-	      *Nx=naxes[0];      // naxes[0] are C-like columns
-	      *Ny=naxes[1];
-	    }
-	}
-
-      // read the physical sizes of the pixels, stored in Keywords "CDELT1" and "CDELT2"
-      // start from the first dimension
-      strcpy(keyname,"CDELT1");
-      if (!fits_read_key_str(fptr, keyname, value, comment, &status))
-	{
-	  *xScale=strtod(value, &ptr);
-	}
-
-      // continue with the second dimension
-      strcpy(keyname,"CDELT2");
-      if (!fits_read_key_str(fptr, keyname, value, comment, &status))
-	{
-	  *yScale=strtod(value, &ptr);
-	}
-
-      fits_close_file(fptr, &status);   // close image file for now
-    } 
-  
-  // print any error message
-  if (status) fits_report_error(stderr, status); 
+      status=readFITSImagedimHandle(fptr, Ny, Nx, yScale, xScale);
+      closeFITSImage(fptr);   // close image file for now
+    }
 
   return(status);
 }
 
 /*!
   \brief 
-  Reads the image stored in a FITS file and, optionally, pads it with zeros.
+  Opens a FITS file with an image for reading
 
   \details
-  Reads the image stored in the FITS file 'fname', with known dimensions
-  Nx and Ny [to be obtained using readFITSdim()]. If Npad is larger than Nx or Ny,
-  then it pads the image so that the corresponding dimension has Npad grid points.
+  Opens the FITS file 'fname' as READONLY and returns it in fptr, so that
+  the sizes of the image can be read with readFITSImagedimHandle() and its
+  pixels with readFITSImageRowsHandle() or readFITSImageStridedHandle(),
+  without opening the file (and parsing its header) more than once. On 
+  a network filesystem with many input files, each open is costly. The
+  file needs to be closed with closeFITSImage().
 
   It returns zero if everything was OK or the FITS error code (and prints
-  an error message) if it wasn't.
+  an error message) if it wasn't; fptr is then NULL.
 
   @param fname[] a string with the filename to be read
-  @param Nx an int with the dimension of the "x-axis"
-  @param Ny an int with the dimension of the "y-axis"
-  @param Npad an int with the dimension along each direction of the padded image
+  @param **fptr on return, a pointer to the open FITS file
 
-  \author Dimitrios Psaltis
-  
   \version 1.0
-  
-  \date October 2, 2017
 
   \bug No known bugs
   
@@ -167,109 +136,39 @@ int readFITSImagedim(char fname[], int *Ny, int *Nx, double *yScale, double *xSc
   \todo nothing left
 
 */
-int readFITSImage(char fname[], int Ny, int Nx, int Npad, double *Image)
+int openFITSImage(char fname[], fitsfile **fptr)
 {
-  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
   int status = 0;   // CFITSIO status value MUST be initialized to zero! 
 
-  int bitpix;       // data type for pixel values
-  int naxis;        // number of axes
-  long naxes[2] = {1,1};   // dimension of each axis
-  long fpixel[2] = {1,1};  // pixel counter
-  int iRowStart,iColStart; // starting grid point at which to place the image, if padding is present
-  int NxPad,NyPad;         // size of padded image array
-
-  int dummyResult;         // dummy variable for the integer result of functions
-  double doubleType;       // dummy double variable to calculate its size
-  
-  // open file as READONLY
-  if (!fits_open_file(&fptr, fname, READONLY, &status))
+  *fptr=NULL;
+  if (fits_open_file(fptr, fname, READONLY, &status))
     {
-      // get the parameters of the image
-      if (!fits_get_img_param(fptr, 2, &bitpix, &naxis, naxes, &status) )
-        {
-          if (naxis!=2)   // we will only be using 2D images
-	    printErrorIO("readFITS: only 2D images are supported\n");
-          else
-	    {
-	      if (Nx!=naxes[0])          // check if x-size is as stated in the input
-		{
-		  printErrorIO("readFITS: error in image x-dimension\n");
-		  return 1;
-		}
-	      if (Ny!=naxes[1])          // check if y-size is as stated in the input
-		{
-		  printErrorIO("readFITS: error in image y-dimension\n");
-		  return 1;
-		}
-	    }
-	}
-
-      // calculate padding
-      dummyResult=ArrayPad(Ny, Nx, Npad, &iRowStart, &iColStart, &NyPad, &NxPad);
-
-      // start at the beginning of the saved image
-      fpixel[0]=1;
-      fpixel[1]=1;
-
-      // and read the pixels one row at a time, in order to put them in the right place
-      // in the padded image
-
-      for (fpixel[1] = 1; fpixel[1]<=Ny; fpixel[1]++)
-	{
-	  if (fits_read_pix(fptr, TDOUBLE, fpixel, Nx, NULL,
-			    Image+indexArr(iRowStart+fpixel[1]-1,iColStart,NyPad,NxPad)
-			    , NULL, &status) )
-	    {
-	      printErrorIO("readFITS: error in reading file\n");
-	    }
-	  
-	}
-
-      // close the file
-      fits_close_file(fptr, &status);   // close image file for now
+      *fptr=NULL;
+      // print any error message
+      fits_report_error(stderr, status); 
     }
 
-  // print any error message
-  if (status) fits_report_error(stderr, status); 
-  
   return(status);
 }
 
 /*!
   \brief 
-  Reads the image dimensions of a FITS data cube, both in terms of
-  pixels and in terms of physical units.
-
-  \details 
-  Reads the image dimensions of the FITS file given in the argument
-  fname. It returns the dimensions of the image (in pixels) along its
-  two axes in Nx and Ny and the size of each pixel along the two axis
-  in xScale and yScale.
-  
-  The difference with readFITSImageDim is that this subroutine reads
-  in a 4D cube. It only works with FITS files that have a dimension of
-  4, and assumes that the first two directions are the actual image
-  axes.
+  Reads the image dimensions of an open FITS file, both in terms of pixels and in terms
+  of physical units.
 
-  In this and in other subroutines, the x-axis is the same as the columns
-  and the y-axis is the same as the rows of the image. These two notations
-  will be used interchangeably.
+  \details
+  The same as readFITSImagedim(), for a file opened with openFITSImage().
 
   It returns zero if everything was OK or the FITS error code (and prints
   an error message) if it wasn't.
 
-  @param fname[] a string with the filename to be read
+  @param *fptr a pointer to the FITS file opened with openFITSImage()
   @param *Ny on return, an int pointer with the dimension of the "y-axis" (# of rows)
   @param *Nx on return, an int pointer with the dimension of the "x-axis" (# of columns)
   @param *yScale on return, a double pointer with the physical size of a pixel along the y-axis 
   @param *xScale on return, a double pointer with the physical size of a pixel along the x-axis
 
-  \author Dimitrios Psaltis
-  
   \version 1.0
-  
-  \date July 30, 2018
 
   \bug No known bugs
   
@@ -278,50 +177,43 @@ int readFITSImage(char fname[], int Ny, int Nx, int Npad, double *Image)
   \todo nothing left
 
 */
-int readFITSCubedim(char fname[], int *Ny, int *Nx, double *yScale, double *xScale)
+int readFITSImagedimHandle(fitsfile *fptr, int *Ny, int *Nx, double *yScale, double *xScale)
 {
-  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
   int status = 0;   // CFITSIO status value MUST be initialized to zero! 
 
   int bitpix;              // data type for pixel values
   int naxis;               // number of axes
-  long naxes[4] = {1,1,1,1};   // dimension of each axis
+  long naxes[2] = {1,1};   // dimension of each axis
   char keyname[80],value[80],comment[80]; // strings for reading keywords from FITS file
   char *ptr;                     // pointer used for converting strings to numbers
 
-  // open file as READONLY
-  if (!fits_open_file(&fptr, fname, READONLY, &status))
+  // get the parameters of the image
+  if (!fits_get_img_param(fptr, 2, &bitpix, &naxis, naxes, &status) )
     {
-      // get the parameters of the image
-      if (!fits_get_img_param(fptr, 2, &bitpix, &naxis, naxes, &status) )
-        {
-          if (naxis!=4)   // we will only be using 4D cubes
-	    printErrorIO("readFITScube: only 4D cubes are supported\n");
-	  else
-	    {
-	      *Nx=naxes[0];      // naxes[0] are C-like columns
-	      *Ny=naxes[1];
-	    }
-	}
-
-      // read the physical sizes of the pixels, stored in Keywords "CDELT1" and "CDELT2"
-      // start from the first dimension
-      strcpy(keyname,"CDELT1");
-      if (!fits_read_key_str(fptr, keyname, value, comment, &status))
+      if (naxis!=2)   // we will only be using 2D images
+	printErrorIO("readFITS: only 2D images are supported\n");
+      else
 	{
-	  *xScale=strtod(value, &ptr);
+	  *Nx=naxes[0];      // naxes[0] are C-like columns
+	  *Ny=naxes[1];
 	}
+    }
 
-      // continue with the second dimension
-      strcpy(keyname,"CDELT2");
-      if (!fits_read_key_str(fptr, keyname, value, comment, &status))
-	{
-	  *yScale=strtod(value, &ptr);
-	}
+  // read the physical sizes of the pixels, stored in Keywords "CDELT1" and "CDELT2"
+  // start from the first dimension
+  strcpy(keyname,"CDELT1");
+  if (!fits_read_key_str(fptr, keyname, value, comment, &status))
+    {
+      *xScale=strtod(value, &ptr);
+    }
+
+  // continue with the second dimension
+  strcpy(keyname,"CDELT2");
+  if (!fits_read_key_str(fptr, keyname, value, comment, &status))
+    {
+      *yScale=strtod(value, &ptr);
+    }
 
-      fits_close_file(fptr, &status);   // close image file for now
-    } 
-  
   // print any error message
   if (status) fits_report_error(stderr, status); 
 
@@ -330,18 +222,47 @@ int readFITSCubedim(char fname[], int *Ny, int *Nx, double *yScale, double *xSca
 
 /*!
   \brief 
-  Reads the image stored in a FITS data cube and, optionally, pads it with zeros.
+  Closes a FITS file opened with openFITSImage()
+
+  @param *fptr a pointer to the FITS file opened with openFITSImage()
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+  \return Returns zero if everything was OK or the FITS error code if it wasn't
+
+*/
+int closeFITSImage(fitsfile *fptr)
+{
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+
+  fits_close_file(fptr, &status);
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief 
+  Reads the image stored in a FITS file and, optionally, pads it with zeros.
 
   \details
-  Reads the image stored in the FITS file 'fname', with known
-  dimensions Nx and Ny [to be obtained using readFITSdim()]. If Npad
-  is larger than Nx or Ny, then it pads the image so that the
-  corresponding dimension has Npad grid points.
+  Reads the image stored in the FITS file 'fname', with known dimensions
+  Nx and Ny [to be obtained using readFITSdim()]. If Npad is larger than Nx or Ny,
+  then it pads the image so that the corresponding dimension has Npad grid points.
 
-  The difference with readFITSImage is that this subroutine reads
-  in a 4D cube. It only works with FITS files that have a dimension of
-  4, and assumes that the first two directions are the actual image
-  axes.
+  The pixels are stored in the array Image with the type 'datatype', e.g.,
+  TDOUBLE for a double array or TFLOAT for a float array, independent of the
+  type in which they are stored in the file; they are converted if needed.
+  With the type in which they are stored (see readFITSImageNativeType()), 
+  they are not converted at all.
 
   It returns zero if everything was OK or the FITS error code (and prints
   an error message) if it wasn't.
@@ -349,12 +270,15 @@ int readFITSCubedim(char fname[], int *Ny, int *Nx, double *yScale, double *xSca
   @param fname[] a string with the filename to be read
   @param Nx an int with the dimension of the "x-axis"
   @param Ny an int with the dimension of the "y-axis"
+  @param Npad an int with the dimension along each direction of the padded image
+  @param datatype an int with the type of the elements of Image (see sizeFITSType())
+  @param Image a pointer to the (padded) array which returns the image
 
   \author Dimitrios Psaltis
   
   \version 1.0
   
-  \date July 30, 2018
+  \date October 2, 2017
 
   \bug No known bugs
   
@@ -363,77 +287,27 @@ int readFITSCubedim(char fname[], int *Ny, int *Nx, double *yScale, double *xSca
   \todo nothing left
 
 */
-int readFITSCube(char fname[], int Ny, int Nx, double *Image)
+int readFITSImage(char fname[], int Ny, int Nx, int Npad, int datatype, void *Image)
 {
-  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
-  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
-
-  int bitpix;       // data type for pixel values
-  int naxis;        // number of axes
-  long naxes[4] = {1,1,1,1};   // dimension of each axis
-  long fpixel[4] = {1,1,1,1};  // pixel counter
-  int iRowStart,iColStart; // starting grid point at which to place the image, if padding is present
-  int dummyResult;         // dummy variable for the integer result of functions
-  double doubleType;       // dummy double variable to calculate its size
-  
-  // open file as READONLY
-  if (!fits_open_file(&fptr, fname, READONLY, &status))
-    {
-      // get the parameters of the image
-      if (!fits_get_img_param(fptr, 2, &bitpix, &naxis, naxes, &status) )
-        {
-          if (naxis!=4)   // we will only be using 4D images
-	    printErrorIO("readFITScube: only 4D images are supported\n");
-          else
-	    {
-	      if (Nx!=naxes[0])          // check if x-size is as stated in the input
-		{
-		  printErrorIO("readFITScube: error in image x-dimension\n");
-		  return 1;
-		}
-	      if (Ny!=naxes[1])          // check if y-size is as stated in the input
-		{
-		  printErrorIO("readFITScube: error in image y-dimension\n");
-		  return 1;
-		}
-	    }
-	}
-
-      // start at the beginning of the saved image
-      fpixel[0]=1;
-      fpixel[1]=1;
-
-      // and read the pixels one row at a time, in order to put them in the right place
-      // in the image; it is assumed that the first layer is the image
-
-      for (fpixel[1] = 1; fpixel[1]<=Ny; fpixel[1]++)
-	{
-	  if (fits_read_pix(fptr, TDOUBLE, fpixel, Nx, NULL,
-			    Image+indexArr(iRowStart+fpixel[1]-1,iColStart,Ny,Nx)
-			    , NULL, &status) )
-	    {
-	      printErrorIO("readFITS: error in reading file\n");
-	    }
-	  
-	}
-
-      // close the file
-      fits_close_file(fptr, &status);   // close image file for now
-    }
-
-  // print any error message
-  if (status) fits_report_error(stderr, status); 
-  
-  return(status);
+  return readFITSImageRows(fname, Ny, Nx, Npad, 0, Ny, 0, datatype, Image);
 }
 
 /*!
   \brief 
-  Writes visibility amplitudes and phases into a FITS file
+  Reads some rows of the image stored in a FITS file and places them in the padded image.
 
   \details
-  Given two real arrays Va[] and Vp[] of dimensions Nx by Ny, it stores
-  them in the FITS file 'fname'
+  Reads the Nrows rows of the image stored in the FITS file 'fname',
+  starting from the row firstRow (starting from 0), and places them in the
+  same rows of the padded image, as readFITSImage() does for all the rows.
+  The rest of the padded image is not changed, so that an image can be
+  read in blocks of rows, e.g., in order to transform each block while
+  the next one is being read.
+
+  The array Image may hold only the rows of the padded image starting from
+  the row arrayRow (starting from 0), e.g., the slab of rows of one MPI
+  rank; the rows that are read need to be in it. For the whole padded
+  image, arrayRow is zero. The rows are read with readFITSImageRowsHandle().
 
   It returns zero if everything was OK or the FITS error code (and prints
   an error message) if it wasn't.
@@ -441,17 +315,14 @@ int readFITSCube(char fname[], int Ny, int Nx, double *Image)
   @param fname[] a string with the filename to be read
   @param Nx an int with the dimension of the "x-axis"
   @param Ny an int with the dimension of the "y-axis"
-  @param Va[] is a Nx by Ny double array with the visibility amplitudes
-  @param Vp[] is a Nx by Ny double array with the visibility phases (in rad)
-  @param uScale is a double with the physical size of each pixel in the x-direction
-  @param vScale is a double with the physical size of each pixel in the x-direction
-  @param hist[] is a string of characters to be put in the "history" field of the FITS file
+  @param Npad an int with the dimension along each direction of the padded image
+  @param firstRow an int with the first row to be read (starting from 0)
+  @param Nrows an int with the number of rows to be read
+  @param arrayRow an int with the row of the padded image at which the array Image starts (starting from 0)
+  @param datatype an int with the type of the elements of Image (see sizeFITSType())
+  @param Image a pointer to the (padded) array which returns the rows of the image
 
-  \author Dimitrios Psaltis
-  
   \version 1.0
-  
-  \date November 3, 2017
 
   \bug No known bugs
   
@@ -460,100 +331,3120 @@ int readFITSCube(char fname[], int Ny, int Nx, double *Image)
   \todo nothing left
 
 */
-int writeFITSVis(char fname[], int Ny, int Nx, double *Vp, double *Va, double vScale, double uScale, char hist[])
+int readFITSImageRows(char fname[], int Ny, int Nx, int Npad, int firstRow, int Nrows, int arrayRow, int datatype,
+		      void *Image)
 {
-  // output the results into a new FITS file
   fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
-  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
-  long naxes[2] = {1,1};   // dimension of each axis
-  long fpixel[2] = {1,1};  // pixel counter
-  char keyname[80],comment[80]; // strings for writing keywords to the FITS file
-  int writeflag;    // flag for return values of FITS commands
-
-  // set axes dimensions from input parameters
-  naxes[0]=Nx;
-  naxes[1]=Ny;
+  int status;       // CFITSIO status value
 
-  // open file
-  if (!fits_create_file(&fptr, fname, &status))
+  // open file as READONLY
+  status=openFITSImage(fname, &fptr);
+  if (status==0)
     {
+      status=readFITSImageRowsHandle(fptr, Ny, Nx, Npad, firstRow, Nrows, arrayRow, datatype, Image);
+      closeFITSImage(fptr);   // close image file for now
+    }
+
+  return(status);
+}
+
+/*!
+  \brief 
+  Reads some rows of the image stored in an open FITS file and places them in the padded image.
+
+  \details
+  The same as readFITSImageRows(), for a file opened with openFITSImage(); 
+  the rows are read with readFITSImageStridedHandle().
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param *fptr a pointer to the FITS file opened with openFITSImage()
+  @param Nx an int with the dimension of the "x-axis"
+  @param Ny an int with the dimension of the "y-axis"
+  @param Npad an int with the dimension along each direction of the padded image
+  @param firstRow an int with the first row to be read (starting from 0)
+  @param Nrows an int with the number of rows to be read
+  @param arrayRow an int with the row of the padded image at which the array Image starts (starting from 0)
+  @param datatype an int with the type of the elements of Image (see sizeFITSType())
+  @param Image a pointer to the (padded) array which returns the rows of the image
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int readFITSImageRowsHandle(fitsfile *fptr, int Ny, int Nx, int Npad, int firstRow, int Nrows, int arrayRow,
+			    int datatype, void *Image)
+{
+  int iRowStart,iColStart; // starting grid point at which to place the image, if padding is present
+  int NxPad,NyPad;         // size of padded image array
+  int dummyResult;         // dummy variable for the integer result of functions
+
+  // calculate padding
+  dummyResult=ArrayPad(Ny, Nx, Npad, &iRowStart, &iColStart, &NyPad, &NxPad);
+
+  return readFITSImageStridedHandle(fptr, Ny, Nx, firstRow, Nrows, datatype, Image,
+				    indexArr(iRowStart+firstRow-arrayRow,iColStart,NxPad), NxPad, 1);
+}
+
+/*!
+  \brief 
+  Reads some rows of the image stored in a FITS file straight into an array with any layout.
+
+  \details
+  Reads the Nrows rows of the image stored in the FITS file 'fname',
+  starting from the row firstRow (starting from 0), and places the pixel
+  in row i and column j of the image (starting from 0) in the element 
+  offset+(i-firstRow)*rowStride+j*pixelStride of the array buf, so that 
+  the pixels can be read straight into the input array of an FFT, e.g.,
+  an array allocated with fftw_malloc(), with no copy in between:
+
+  - a padded image has rowStride NxPad and pixelStride 1, and offset
+  (iRowStart-1)*NxPad+iColStart-1 (see ArrayPad());
+  - the padded input of an in-place real-to-complex transform has
+  rowStride 2*(NxPad/2+1) and pixelStride 1;
+  - the complex input of a complex-to-complex transform has rowStride 
+  2*NxPad, pixelStride 2, and an offset twice that of the padded image.
+
+  Each row is read in place at its position in buf. If pixelStride is 
+  larger than 1, the pixels of the row are then moved to their positions,
+  from the last to the first, and the elements in between (e.g., the 
+  imaginary parts of a complex array) are set to zero. The rest of the
+  array is not changed, so the padding needs to be set by the caller.
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param fname[] a string with the filename to be read
+  @param Nx an int with the dimension of the "x-axis"
+  @param Ny an int with the dimension of the "y-axis"
+  @param firstRow an int with the first row to be read (starting from 0)
+  @param Nrows an int with the number of rows to be read
+  @param datatype an int with the type of the elements of buf (see sizeFITSType())
+  @param buf a pointer to the array which returns the rows of the image
+  @param offset a long with the element of buf for the first pixel of the row firstRow
+  @param rowStride a long with the number of elements of buf between the rows of the image
+  @param pixelStride an int with the number of elements of buf between the pixels of a row
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning The rows need to be at least Nx*pixelStride elements apart
+  
+  \todo nothing left
+
+*/
+int readFITSImageStrided(char fname[], int Ny, int Nx, int firstRow, int Nrows, int datatype, void *buf,
+			 long offset, long rowStride, int pixelStride)
+{
+  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
+  int status;       // CFITSIO status value
+
+  // open file as READONLY
+  status=openFITSImage(fname, &fptr);
+  if (status==0)
+    {
+      status=readFITSImageStridedHandle(fptr, Ny, Nx, firstRow, Nrows, datatype, buf, offset, rowStride, pixelStride);
+      closeFITSImage(fptr);   // close image file for now
+    }
+
+  return(status);
+}
+
+/*!
+  \brief 
+  Reads some rows of the image stored in an open FITS file straight into an array with any layout.
+
+  \details
+  The same as readFITSImageStrided(), for a file opened with openFITSImage().
+  The array buf may have any of the types of sizeFITSType(), e.g., the type
+  in which the pixels are stored (see readFITSImageNativeType()), so that 
+  they are not converted; a pixelStride larger than one needs TFLOAT or 
+  TDOUBLE. If the image can be mapped into memory (see mapFITSImage()), 
+  the pixels are copied straight from the file with readFITSImageMapped(),
+  which applies BSCALE and BZERO only if they are present. Otherwise,
+  if the rows are contiguous in buf (i.e., rowStride is Nx and pixelStride
+  is one, as for an image that is not padded), all the rows are read with
+  a single call to CFITSIO.
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param *fptr a pointer to the FITS file opened with openFITSImage()
+  @param Nx an int with the dimension of the "x-axis"
+  @param Ny an int with the dimension of the "y-axis"
+  @param firstRow an int with the first row to be read (starting from 0)
+  @param Nrows an int with the number of rows to be read
+  @param datatype an int with the type of the elements of buf (see sizeFITSType())
+  @param buf a pointer to the array which returns the rows of the image
+  @param offset a long with the element of buf for the first pixel of the row firstRow
+  @param rowStride a long with the number of elements of buf between the rows of the image
+  @param pixelStride an int with the number of elements of buf between the pixels of a row
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning The rows need to be at least Nx*pixelStride elements apart
+  
+  \todo nothing left
+
+*/
+int readFITSImageStridedHandle(fitsfile *fptr, int Ny, int Nx, int firstRow, int Nrows, int datatype, void *buf,
+			       long offset, long rowStride, int pixelStride)
+{
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+
+  int bitpix;       // data type for pixel values
+  int naxis;        // number of axes
+  long naxes[2] = {1,1};   // dimension of each axis
+  long fpixel[2] = {1,1};  // pixel counter
+  long index;              // dummy index for counting the pixels of a row
+  int k;                   // dummy index for counting the elements between the pixels
+  size_t elementSize=sizeFITSType(datatype); // size of the elements of buf
+  char *row;               // the first element of a row in buf
+  
+  // get the parameters of the image
+  if (!fits_get_img_param(fptr, 2, &bitpix, &naxis, naxes, &status) )
+    {
+      if (naxis!=2)   // we will only be using 2D images
+	printErrorIO("readFITS: only 2D images are supported\n");
+      else
+	{
+	  if (Nx!=naxes[0])          // check if x-size is as stated in the input
+	    {
+	      printErrorIO("readFITS: error in image x-dimension\n");
+	      return 1;
+	    }
+	  if (Ny!=naxes[1])          // check if y-size is as stated in the input
+	    {
+	      printErrorIO("readFITS: error in image y-dimension\n");
+	      return 1;
+	    }
+	}
+    }
+
+  // do not read past the last row
+  if (firstRow+Nrows>Ny)
+    Nrows=Ny-firstRow;
+
+  // the pixels of an uncompressed image in a local file are taken straight from the file
+  if (status==0 && Nrows>0 &&
+      readFITSImageMapped(fptr, Nx, firstRow, Nrows, datatype, buf, offset, rowStride, pixelStride)==0)
+    return 0;
+
+  // start at the first row to be read
+  fpixel[0]=1;
+  fpixel[1]=firstRow+1;
+
+  // if the rows are contiguous in the array, read them all at once
+  if (status==0 && Nrows>0 && pixelStride==1 && rowStride==Nx)
+    {
+      if (fits_read_pix(fptr, datatype, fpixel, (long)Nrows*Nx, NULL, (char *)buf+elementSize*offset, NULL, &status) )
+	printErrorIO("readFITS: error in reading file\n");
+    }
+  else
+    // otherwise, read the pixels one row at a time, in order to put them in the right place
+    // in the array
+    for (fpixel[1] = firstRow+1; fpixel[1]<=firstRow+Nrows; fpixel[1]++)
+      {
+	row=(char *)buf+elementSize*(offset+(fpixel[1]-1-firstRow)*rowStride);
+	if (fits_read_pix(fptr, datatype, fpixel, Nx, NULL, row, NULL, &status) )
+	  {
+	    printErrorIO("readFITS: error in reading file\n");
+	  }
+
+	// move the pixels apart, from the last to the first, so that none is overwritten
+	if (pixelStride>1)
+	  for (index=Nx-1;index>=0;index--)
+	    {
+	      if (datatype==TFLOAT)
+		{
+		  ((float *)row)[index*pixelStride]=((float *)row)[index];
+		  for (k=1;k<pixelStride;k++)
+		    ((float *)row)[index*pixelStride+k]=0.0;
+		}
+	      else
+		{
+		  ((double *)row)[index*pixelStride]=((double *)row)[index];
+		  for (k=1;k<pixelStride;k++)
+		    ((double *)row)[index*pixelStride+k]=0.0;
+		}
+	    }
+      }
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief 
+  Returns the size of an element of an array of a CFITSIO data type
+
+  @param datatype an int with the CFITSIO type of the array (TBYTE, TSHORT, TINT, TFLOAT, or TDOUBLE)
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning Any other type is taken to be TDOUBLE
+  
+  \todo nothing left
+
+  \return Returns the size (in bytes) of an element
+
+*/
+size_t sizeFITSType(int datatype)
+{
+  switch (datatype)
+    {
+    case TBYTE:
+      return sizeof(unsigned char);
+    case TSHORT:
+      return sizeof(short);
+    case TINT:
+      return sizeof(int);
+    case TFLOAT:
+      return sizeof(float);
+    default:
+      return sizeof(double);
+    }
+}
+
+/*!
+  \brief 
+  Finds the CFITSIO data type in which the pixels of an image are stored
+
+  \details
+  Returns in datatype the type of array that holds the pixels of the image
+  in the current HDU of the open FITS file with no loss and no conversion 
+  other than the byte order: TBYTE, TSHORT, TINT, TFLOAT, or TDOUBLE for
+  BITPIX 8, 16, 32, -32, or -64. If the image has BSCALE and BZERO, the type
+  is that of the scaled values, i.e., TFLOAT for 8- and 16-bit integers and
+  TDOUBLE for 32-bit integers, except for the unsigned integers of the FITS
+  convention (BZERO of 2^15 or 2^31), which are returned as TFLOAT and TDOUBLE,
+  respectively, as are 64-bit and signed 8-bit integers. 
+
+  An array of this type can then be passed to readFITSImageStridedHandle(),
+  e.g., to read a GRRT image of floats with half the bandwidth and none of
+  the conversions of an array of doubles.
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param *fptr a pointer to the open FITS file
+  @param *datatype on return, an int pointer with the CFITSIO type of the pixels
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int readFITSImageNativeType(fitsfile *fptr, int *datatype)
+{
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+  int equivType;    // BITPIX of the (scaled) values of the pixels
+
+  if (!fits_get_img_equivtype(fptr, &equivType, &status))
+    switch (equivType)
+      {
+      case BYTE_IMG:
+	*datatype=TBYTE;
+	break;
+      case SHORT_IMG:
+	*datatype=TSHORT;
+	break;
+      case LONG_IMG:
+	*datatype=TINT;
+	break;
+      case FLOAT_IMG:
+      case SBYTE_IMG:
+      case USHORT_IMG:
+	*datatype=TFLOAT;
+	break;
+      default:
+	*datatype=TDOUBLE;
+      }
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+
+  return(status);
+}
+
+/*!
+  \brief 
+  Maps some rows of an uncompressed image into memory, read-only
+
+  \details
+  The data unit of an uncompressed image is stored at a fixed offset in
+  the file, as big-endian integers or IEEE floats, one row after the other.
+  If the image in the current HDU of the open FITS file has BITPIX 16, -32,
+  or -64 and is stored in a local file (i.e., not compressed, filtered, or 
+  in memory), then the part of the file with the Nrows rows starting from
+  the row firstRow (starting from 0) is mapped read-only into memory with
+  mmap(). On return, data points to the first pixel of the row firstRow,
+  bitpix is the type of the pixels, which are in big-endian order, and 
+  bscale and bzero are the scaling of their values (1 and 0 if there are 
+  no BSCALE and BZERO keywords), which has not been applied. The region 
+  needs to be unmapped with unmapFITSImage(), with the returned map and 
+  mapSize.
+
+  This lets a caller that only scans the pixels (or copies them to another
+  array, see readFITSImageMapped()) skip the internal buffering of CFITSIO
+  and its calls per row.
+
+  It returns zero if the rows were mapped, or one if the image needs to be
+  read with CFITSIO; no error message is printed in that case.
+
+  @param *fptr a pointer to the open FITS file
+  @param firstRow an int with the first row to be mapped (starting from 0)
+  @param Nrows an int with the number of rows to be mapped
+  @param *bitpix on return, an int pointer with the BITPIX of the image (SHORT_IMG, FLOAT_IMG, or DOUBLE_IMG)
+  @param *bscale on return, a double pointer with the BSCALE of the image
+  @param *bzero on return, a double pointer with the BZERO of the image
+  @param **map on return, a pointer to the mapped region
+  @param *mapSize on return, a size_t pointer with the size (in bytes) of the mapped region
+  @param **data on return, a pointer to the first pixel of the row firstRow
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning The file must not be changed while it is mapped
+  
+  \todo nothing left
+
+*/
+int mapFITSImage(fitsfile *fptr, int firstRow, int Nrows, int *bitpix, double *bscale, double *bzero,
+		 void **map, size_t *mapSize, char **data)
+{
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+  int keyStatus;    // CFITSIO status value for the optional keywords
+
+  int naxis;                            // number of axes
+  long naxes[2] = {1,1};                // dimension of each axis
+  char urltype[FLEN_FILENAME];          // type of the file, e.g., file:// for a local file
+  char filename[FLEN_FILENAME];         // name of the file
+  LONGLONG headStart,dataStart,dataEnd; // offsets (in bytes) of the header and data units in the file
+  long pixelSize;                       // size (in bytes) of a pixel in the file
+  off_t start,pageStart;                // offsets (in bytes) of the first row and of its page in the file
+  size_t length;                        // size (in bytes) of the rows
+  struct stat fileStat;                 // properties of the file, for its size
+  int fd;                               // file descriptor for mmap()
+
+  // only uncompressed images of 16-bit integers or floats in local files
+  if (fits_is_compressed_image(fptr, &status) || status)
+    return 1;
+  if (fits_get_img_param(fptr, 2, bitpix, &naxis, naxes, &status) || naxis!=2 ||
+      (*bitpix!=SHORT_IMG && *bitpix!=FLOAT_IMG && *bitpix!=DOUBLE_IMG))
+    return 1;
+  if (fits_url_type(fptr, urltype, &status) || strcmp(urltype,"file://")!=0)
+    return 1;
+  if (fits_file_name(fptr, filename, &status) || 
+      fits_get_hduaddrll(fptr, &headStart, &dataStart, &dataEnd, &status))
+    return 1;
+  if (firstRow<0 || Nrows<=0 || firstRow+Nrows>naxes[1])
+    return 1;
+
+  // the scaling of the pixel values; the keywords are optional, so the
+  // messages for missing keywords are cleared from the CFITSIO error stack
+  *bscale=1.0;
+  *bzero=0.0;
+  fits_write_errmark();
+  keyStatus=0;
+  fits_read_key(fptr, TDOUBLE, "BSCALE", bscale, NULL, &keyStatus);
+  keyStatus=0;
+  fits_read_key(fptr, TDOUBLE, "BZERO", bzero, NULL, &keyStatus);
+  fits_clear_errmark();
+
+  // the rows start at the first page that contains them
+  pixelSize=abs(*bitpix)/8;
+  start=dataStart+(off_t)firstRow*naxes[0]*pixelSize;
+  length=(size_t)Nrows*naxes[0]*pixelSize;
+  pageStart=start-start%sysconf(_SC_PAGESIZE);
+
+  fd=open(filename, O_RDONLY);
+  if (fd<0)
+    return 1;
+  if (fstat(fd, &fileStat)!=0 || fileStat.st_size<start+(off_t)length)
+    {
+      close(fd);
+      return 1;
+    }
+  *mapSize=length+(start-pageStart);
+  *map=mmap(NULL, *mapSize, PROT_READ, MAP_PRIVATE, fd, pageStart);
+  close(fd);                    // the mapping stays valid
+  if (*map==MAP_FAILED)
+    return 1;
+  madvise(*map, *mapSize, MADV_SEQUENTIAL);
+
+  *data=(char *)*map+(start-pageStart);
+
+  return 0;
+}
+
+/*!
+  \brief 
+  Unmaps a region mapped with mapFITSImage()
+
+  @param *map a pointer to the mapped region
+  @param mapSize a size_t with the size (in bytes) of the mapped region
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+  \return Returns zero if everything was OK or one if it wasn't
+
+*/
+int unmapFITSImage(void *map, size_t mapSize)
+{
+  return (munmap(map, mapSize)==0 ? 0 : 1);
+}
+
+/*!
+  \brief 
+  Copies some rows of an uncompressed image straight from the file into an array
+
+  \details
+  Maps the Nrows rows of the image, starting from the row firstRow, with
+  mapFITSImage() and copies the pixels into the array buf, with the same
+  layout as readFITSImageStrided(): the pixel in row i and column j goes to
+  the element offset+(i-firstRow)*rowStride+j*pixelStride, and the elements
+  between the pixels are set to zero. Each pixel is swapped from big-endian
+  to the native byte order (if needed) and converted to the type datatype
+  (TFLOAT or TDOUBLE, or TSHORT for an image of 16-bit integers with no 
+  scaling); BSCALE and BZERO are applied in the same pass, only if they
+  are present. The loops over the pixels of a row have no calls, so that 
+  the compiler can vectorize them.
+
+  It returns zero if the rows were copied, or one if the image cannot be
+  mapped or converted and needs to be read with CFITSIO.
+
+  @param *fptr a pointer to the open FITS file
+  @param Nx an int with the dimension of the "x-axis"
+  @param firstRow an int with the first row to be read (starting from 0)
+  @param Nrows an int with the number of rows to be read
+  @param datatype an int with the type of the elements of buf (TDOUBLE, TFLOAT, or TSHORT)
+  @param buf a pointer to the array which returns the rows of the image
+  @param offset a long with the element of buf for the first pixel of the row firstRow
+  @param rowStride a long with the number of elements of buf between the rows of the image
+  @param pixelStride an int with the number of elements of buf between the pixels of a row
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int readFITSImageMapped(fitsfile *fptr, int Nx, int firstRow, int Nrows, int datatype, void *buf,
+			long offset, long rowStride, int pixelStride)
+{
+  int bitpix;              // data type for pixel values
+  double bscale,bzero;     // scaling of the pixel values
+  int scaled;              // flag for the scaling of the pixel values
+  void *map;               // the mapped region of the file
+  size_t mapSize;          // size (in bytes) of the mapped region
+  char *data;              // the first pixel of the row firstRow in the mapped region
+  const uint16_t *src16;   // the pixels of a row of a BITPIX 16 image, as big-endian words
+  const uint32_t *src32;   // the pixels of a row of a BITPIX -32 image, as big-endian words
+  const uint64_t *src64;   // the pixels of a row of a BITPIX -64 image, as big-endian words
+  uint16_t word16;         // a pixel of a BITPIX 16 image
+  uint32_t word32;         // a pixel of a BITPIX -32 image
+  uint64_t word64;         // a pixel of a BITPIX -64 image
+  int16_t valueShort;      // the value of a pixel of a BITPIX 16 image
+  float valueFloat;        // the value of a pixel of a BITPIX -32 image
+  double valueDouble;      // the value of a pixel of a BITPIX -64 image
+  uint32_t one=1;          // for the byte order of the machine
+  int swap=(*(unsigned char *)&one==1);   // the bytes are swapped on a little-endian machine
+  long i,j;                // dummy indices for counting rows and pixels
+  int k;                   // dummy index for counting the elements between the pixels
+  char *row;               // the first element of a row in buf
+
+  if (datatype!=TFLOAT && datatype!=TDOUBLE && datatype!=TSHORT)
+    return 1;
+
+  if (mapFITSImage(fptr, firstRow, Nrows, &bitpix, &bscale, &bzero, &map, &mapSize, &data)!=0)
+    return 1;
+  scaled=(bscale!=1.0 || bzero!=0.0);
+
+  // the integers are only copied as they are
+  if (datatype==TSHORT && (bitpix!=SHORT_IMG || scaled || pixelStride!=1))
+    {
+      unmapFITSImage(map, mapSize);
+      return 1;
+    }
+
+  for (i=0;i<Nrows;i++)
+    {
+      row=(char *)buf+sizeFITSType(datatype)*(offset+i*rowStride);
+
+      if (bitpix==SHORT_IMG)
+	{
+	  src16=(const uint16_t *)data+i*Nx;
+	  for (j=0;j<Nx;j++)
+	    {
+	      word16=src16[j];
+	      if (swap)
+		word16=(uint16_t)((word16>>8) | (word16<<8));
+	      valueShort=(int16_t)word16;
+	      if (datatype==TSHORT)
+		((short *)row)[j]=valueShort;
+	      else if (datatype==TFLOAT)
+		((float *)row)[j*pixelStride]=(scaled ? valueShort*bscale+bzero : valueShort);
+	      else
+		((double *)row)[j*pixelStride]=(scaled ? valueShort*bscale+bzero : valueShort);
+	    }
+	}
+      else if (bitpix==FLOAT_IMG)
+	{
+	  src32=(const uint32_t *)data+i*Nx;
+	  for (j=0;j<Nx;j++)
+	    {
+	      word32=src32[j];
+	      if (swap)
+		word32=(word32>>24) | ((word32>>8)&0xff00U) | ((word32<<8)&0xff0000U) | (word32<<24);
+	      memcpy(&valueFloat, &word32, sizeof(float));
+	      if (datatype==TFLOAT)
+		((float *)row)[j*pixelStride]=(scaled ? valueFloat*bscale+bzero : valueFloat);
+	      else
+		((double *)row)[j*pixelStride]=(scaled ? valueFloat*bscale+bzero : valueFloat);
+	    }
+	}
+      else
+	{
+	  src64=(const uint64_t *)data+i*Nx;
+	  for (j=0;j<Nx;j++)
+	    {
+	      word64=src64[j];
+	      if (swap)
+		word64=(word64>>56) | ((word64>>40)&0xff00ULL) | ((word64>>24)&0xff0000ULL) |
+		  ((word64>>8)&0xff000000ULL) | ((word64<<8)&0xff00000000ULL) |
+		  ((word64<<24)&0xff0000000000ULL) | ((word64<<40)&0xff000000000000ULL) | (word64<<56);
+	      memcpy(&valueDouble, &word64, sizeof(double));
+	      if (scaled)
+		valueDouble=valueDouble*bscale+bzero;
+	      if (datatype==TFLOAT)
+		((float *)row)[j*pixelStride]=valueDouble;
+	      else
+		((double *)row)[j*pixelStride]=valueDouble;
+	    }
+	}
+
+      // the elements between the pixels, e.g., the imaginary parts of a complex array
+      for (k=1;k<pixelStride;k++)
+	for (j=0;j<Nx;j++)
+	  {
+	    if (datatype==TFLOAT)
+	      ((float *)row)[j*pixelStride+k]=0.0;
+	    else
+	      ((double *)row)[j*pixelStride+k]=0.0;
+	  }
+    }
+
+  unmapFITSImage(map, mapSize);
+
+  return 0;
+}
+
+/*!
+  \brief 
+  Finds an axis of a FITS data cube by its type
+
+  \details
+  Returns the axis (starting from 0) of the data cube in the current HDU
+  whose keyword CTYPEn is ctype (e.g., 'STOKES' or 'TIME'). The first two
+  axes are always the image axes; if none of the other axes has this type,
+  it is assumed to be the third one. A missing CTYPEn keyword is not an error.
+
+  @param *fptr a pointer to the open FITS file
+  @param naxis an int with the number of axes of the data cube
+  @param ctype[] a string with the type of the axis
+  @param *status an int pointer with the CFITSIO status
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+  \return Returns the axis
+
+*/
+int readFITSAxisType(fitsfile *fptr, int naxis, char ctype[], int *status)
+{
+  int axis;                      // dummy index for counting axes
+  char keyname[80],value[80],comment[80]; // strings for reading keywords from FITS file
+
+  for (axis=2;axis<naxis;axis++)
+    {
+      snprintf(keyname,80,"CTYPE%d",axis+1);
+      if (fits_read_key(fptr, TSTRING, keyname, value, comment, status)==0)
+	{
+	  if (strncmp(value,ctype,strlen(ctype))==0)
+	    return axis;
+	}
+      else if (*status==KEY_NO_EXIST)
+	*status=0;
+    }
+
+  return 2;
+}
+
+/*!
+  \brief 
+  Reads the image dimensions of a FITS data cube, both in terms of
+  pixels and in terms of physical units.
+
+  \details 
+  Reads the image dimensions of the FITS file given in the argument
+  fname. It returns the dimensions of the image (in pixels) along its
+  two axes in Nx and Ny and the size of each pixel along the two axis
+  in xScale and yScale.
+  
+  The difference with readFITSImageDim is that this subroutine reads
+  in a 4D cube. It works with FITS files that have a dimension of 2, 3,
+  or 4, and assumes that the first two directions are the actual image
+  axes. It also returns in Nplanes the dimension of the axis of type
+  ctype, e.g., the number of Stokes parameters for 'STOKES' or the number
+  of frames for 'TIME' (see readFITSAxisType()); a 2D image has one plane.
+
+  In this and in other subroutines, the x-axis is the same as the columns
+  and the y-axis is the same as the rows of the image. These two notations
+  will be used interchangeably.
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param fname[] a string with the filename to be read
+  @param *Ny on return, an int pointer with the dimension of the "y-axis" (# of rows)
+  @param *Nx on return, an int pointer with the dimension of the "x-axis" (# of columns)
+  @param ctype[] a string with the type of the axis of the planes
+  @param *Nplanes on return, an int pointer with the number of planes along that axis
+  @param *yScale on return, a double pointer with the physical size of a pixel along the y-axis 
+  @param *xScale on return, a double pointer with the physical size of a pixel along the x-axis
+
+  \author Dimitrios Psaltis
+  
+  \version 1.0
+  
+  \date July 30, 2018
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int readFITSCubedim(char fname[], int *Ny, int *Nx, char ctype[], int *Nplanes, double *yScale, double *xScale)
+{
+  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+
+  int bitpix;              // data type for pixel values
+  int naxis;               // number of axes
+  long naxes[4] = {1,1,1,1};   // dimension of each axis
+  char keyname[80],value[80],comment[80]; // strings for reading keywords from FITS file
+  char *ptr;                     // pointer used for converting strings to numbers
+
+  // open file as READONLY
+  if (!fits_open_file(&fptr, fname, READONLY, &status))
+    {
+      // get the parameters of the image
+      if (!fits_get_img_param(fptr, 4, &bitpix, &naxis, naxes, &status) )
+        {
+          if (naxis<2 || naxis>4)   // we will only be using images and 3D and 4D cubes
+	    {
+	      printErrorIO("readFITScube: only 2D images and 3D and 4D cubes are supported\n");
+	      fits_close_file(fptr, &status);
+	      return 1;
+	    }
+	  else
+	    {
+	      *Nx=naxes[0];      // naxes[0] are C-like columns
+	      *Ny=naxes[1];
+	      *Nplanes=naxes[readFITSAxisType(fptr,naxis,ctype,&status)];
+	    }
+	}
+
+      // read the physical sizes of the pixels, stored in Keywords "CDELT1" and "CDELT2"
+      // start from the first dimension
+      strcpy(keyname,"CDELT1");
+      if (!fits_read_key_str(fptr, keyname, value, comment, &status))
+	{
+	  *xScale=strtod(value, &ptr);
+	}
+
+      // continue with the second dimension
+      strcpy(keyname,"CDELT2");
+      if (!fits_read_key_str(fptr, keyname, value, comment, &status))
+	{
+	  *yScale=strtod(value, &ptr);
+	}
+
+      fits_close_file(fptr, &status);   // close image file for now
+    } 
+  
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+
+  return(status);
+}
+
+/*!
+  \brief 
+  Reads the image stored in a FITS data cube and, optionally, pads it with zeros.
+
+  \details
+  Reads the image stored in the FITS file 'fname', with known
+  dimensions Nx and Ny [to be obtained using readFITSdim()]. If Npad
+  is larger than Nx or Ny, then it pads the image so that the
+  corresponding dimension has Npad grid points.
+
+  The difference with readFITSImage is that this subroutine reads
+  in a 3D or 4D cube. It assumes that the first two directions are the
+  actual image axes, and it reads the Nplanes planes, starting from 
+  the plane 'first' (starting from 0), along the axis of type ctype (see
+  readFITSAxisType()), one after the other: the padded image of the n-th
+  plane that is read starts at element n*NyPad*NxPad of Image. E.g., with
+  ctype 'STOKES', first=0, and Nplanes=4 it reads I, Q, U, and V, and with
+  ctype 'TIME', first=k, and Nplanes=1 it reads the k-th frame of a movie.
+  Along any other axis (e.g., frequency), only the first plane is read.
+
+  The pixels are stored with the type 'datatype' (TDOUBLE or TFLOAT), as
+  in readFITSImage().
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param fname[] a string with the filename to be read
+  @param Nx an int with the dimension of the "x-axis"
+  @param Ny an int with the dimension of the "y-axis"
+  @param Npad an int with the dimension along each direction of the padded image
+  @param ctype[] a string with the type of the axis of the planes
+  @param first an int with the first plane to be read (starting from 0)
+  @param Nplanes an int with the number of planes to be read
+  @param datatype an int with the type of the elements of Image (see sizeFITSType())
+  @param Image a pointer to the Nplanes (padded) images, one after the other
+
+  \author Dimitrios Psaltis
+  
+  \version 1.0
+  
+  \date July 30, 2018
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int readFITSCube(char fname[], int Ny, int Nx, int Npad, char ctype[], int first, int Nplanes, int datatype, void *Image)
+{
+  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+
+  int bitpix;       // data type for pixel values
+  int naxis;        // number of axes
+  long naxes[4] = {1,1,1,1};   // dimension of each axis
+  long fpixel[4] = {1,1,1,1};  // pixel counter
+  int iRowStart,iColStart; // starting grid point at which to place the image, if padding is present
+  int NxPad,NyPad;         // size of padded image array
+  int planeAxis=2;         // axis of the planes
+  int iPlane;              // dummy index for counting planes
+  int dummyResult;         // dummy variable for the integer result of functions
+  double doubleType;       // dummy double variable to calculate its size
+  size_t elementSize=sizeFITSType(datatype); // size of the elements of Image
+  char *plane;             // first byte of the image of a plane
+  
+  // open file as READONLY
+  if (!fits_open_file(&fptr, fname, READONLY, &status))
+    {
+      // get the parameters of the image
+      if (!fits_get_img_param(fptr, 4, &bitpix, &naxis, naxes, &status) )
+        {
+          if (naxis<2 || naxis>4)   // we will only be using 2D, 3D and 4D images
+	    {
+	      printErrorIO("readFITScube: only 2D, 3D and 4D images are supported\n");
+	      fits_close_file(fptr, &status);
+	      return 1;
+	    }
+          else
+	    {
+	      if (Nx!=naxes[0])          // check if x-size is as stated in the input
+		{
+		  printErrorIO("readFITScube: error in image x-dimension\n");
+		  fits_close_file(fptr, &status);
+		  return 1;
+		}
+	      if (Ny!=naxes[1])          // check if y-size is as stated in the input
+		{
+		  printErrorIO("readFITScube: error in image y-dimension\n");
+		  fits_close_file(fptr, &status);
+		  return 1;
+		}
+	      planeAxis=readFITSAxisType(fptr,naxis,ctype,&status);
+	      if (first<0 || first+Nplanes>naxes[planeAxis])
+		{
+		  printErrorIO("readFITScube: error in the number of planes\n");
+		  fits_close_file(fptr, &status);
+		  return 1;
+		}
+	    }
+	}
+
+      // calculate padding
+      dummyResult=ArrayPad(Ny, Nx, Npad, &iRowStart, &iColStart, &NyPad, &NxPad);
+
+      for (iPlane=0;iPlane<Nplanes;iPlane++)
+	{
+	  // start at the beginning of the saved image of this plane
+	  fpixel[0]=1;
+	  fpixel[1]=1;
+	  fpixel[planeAxis]=first+iPlane+1;
+	  plane=(char *)Image+elementSize*iPlane*NyPad*NxPad;
+
+	  // if the image is not padded, read the whole plane at once
+	  if (NyPad==Ny && NxPad==Nx)
+	    {
+	      if (fits_read_pix(fptr, datatype, fpixel, (long)Ny*Nx, NULL, plane, NULL, &status) )
+		printErrorIO("readFITS: error in reading file\n");
+	      continue;
+	    }
+
+	  // otherwise, read the pixels one row at a time, in order to put them in the right place
+	  // in the padded image
+	  for (fpixel[1] = 1; fpixel[1]<=Ny; fpixel[1]++)
+	    {
+	      if (fits_read_pix(fptr, datatype, fpixel, Nx, NULL,
+				plane+elementSize*indexArr(iRowStart+fpixel[1]-1,iColStart,NxPad)
+				, NULL, &status) )
+		{
+		  printErrorIO("readFITS: error in reading file\n");
+		}
+	    }
+	}
+
+      // close the file
+      fits_close_file(fptr, &status);   // close image file for now
+    }
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief 
+  Parses the tiled compression of the output images from a string
+
+  \details
+  The string spec has the form "algorithm[,q[,qPhase]]", where the 
+  algorithm is "none", "rice", "gzip" (the GZIP_2 algorithm of CFITSIO, 
+  which shuffles the bytes of the pixels before compressing them), or 
+  "hcompress", q is the quantization level of the floating-point images,
+  and qPhase is the quantization level of the images of visibility phases
+  (equal to q if it is not given). A quantization level of zero means
+  lossless compression, which CFITSIO allows for floating-point images 
+  only with gzip, and is the default for gzip; a positive level q 
+  quantizes the pixels of each tile to 1/q of its noise, as in the "q" 
+  option of the CFITSIO extended filename syntax (see imcopy), and is 
+  QUANTLEVEL by default for rice and hcompress. The phases are bounded 
+  by pi and are smooth, so they can usually take a coarser quantization 
+  than the amplitudes.
+
+  It returns zero if the string was OK or one (and prints an error message)
+  if it wasn't.
+
+  @param spec[] a string with the compression
+  @param *comp on return, a pointer to the compression
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int parseFITSCompression(char spec[], fitsCompression *comp)
+{
+  char name[FLEN_VALUE];  // name of the algorithm
+  int Nread;              // number of fields read
+
+  comp->type=0;
+  comp->quantize=0.0;
+  comp->quantizePhase=0.0;
+
+  Nread=sscanf(spec,"%70[^,],%f,%f",name,&comp->quantize,&comp->quantizePhase);
+  if (Nread<1 || comp->quantize<0.0 || comp->quantizePhase<0.0)
+    {
+      printErrorIO("invalid compression of the output images\n");
+      return 1;
+    }
+
+  if (strcmp(name,"none")==0)
+    comp->type=0;
+  else if (strcmp(name,"rice")==0)
+    comp->type=RICE_1;
+  else if (strcmp(name,"gzip")==0)
+    comp->type=GZIP_2;
+  else if (strcmp(name,"hcompress")==0)
+    comp->type=HCOMPRESS_1;
+  else
+    {
+      printErrorIO("unknown compression algorithm of the output images\n");
+      return 1;
+    }
+
+  // the defaults of the quantization levels
+  if (Nread<2 && (comp->type==RICE_1 || comp->type==HCOMPRESS_1))
+    comp->quantize=QUANTLEVEL;
+  if (Nread<3)
+    comp->quantizePhase=comp->quantize;
+
+  if ((comp->type==RICE_1 || comp->type==HCOMPRESS_1) && (comp->quantize==0.0 || comp->quantizePhase==0.0))
+    {
+      printErrorIO("lossless compression of floating-point images needs gzip\n");
+      return 1;
+    }
+
+  return 0;
+}
+
+/*!
+  \brief 
+  Creates a new image HDU in a FITS file, compressed if requested
+
+  \details
+  The same as fits_create_img(), except that, if comp is not NULL and sets
+  a compression algorithm, the image is written as a tile-compressed image
+  (i.e., as a binary table extension, which CFITSIO reads back as an image;
+  the first one is placed after an empty primary HDU). The tiles are whole
+  rows of the image (HCOMPTILEROWS rows for HCOMPRESS, which needs 2D 
+  tiles, and one row otherwise), so that the images can be read back one
+  row at a time without decompressing the rest of the image. The phases
+  (isPhase set) are quantized with their own level (see parseFITSCompression()).
+
+  It returns the CFITSIO status.
+
+  @param *fptr a pointer to the open FITS file
+  @param bitpix an int with the type of the image (DOUBLE_IMG or FLOAT_IMG)
+  @param naxis an int with the number of axes of the image
+  @param *naxes a pointer to the dimensions of the axes of the image
+  @param *comp a pointer to the compression of the image, or NULL for none
+  @param isPhase an int with a flag for whether the image holds visibility phases
+  @param *status an int pointer with the CFITSIO status
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning HCOMPRESS needs images with at least 4 rows and columns
+  
+  \todo nothing left
+
+*/
+int createFITSImageHDU(fitsfile *fptr, int bitpix, int naxis, long *naxes, fitsCompression *comp, int isPhase,
+		       int *status)
+{
+  long tile[4] = {1,1,1,1};    // dimensions of the tiles
+
+  if (comp!=NULL && comp->type!=0)
+    {
+      // tiles of whole rows, for the readers of rows
+      tile[0]=naxes[0];
+      tile[1]=(comp->type==HCOMPRESS_1 ? HCOMPTILEROWS : 1);
+      if (tile[1]>naxes[1])
+	tile[1]=naxes[1];
+
+      fits_set_compression_type(fptr, comp->type, status);
+      fits_set_tile_dim(fptr, naxis, tile, status);
+      fits_set_quantize_level(fptr, (isPhase ? comp->quantizePhase : comp->quantize), status);
+    }
+
+  return fits_create_img(fptr, bitpix, naxis, naxes, status);
+}
+
+/*!
+  \brief 
+  Checks whether a filename is the standard input or output
+
+  \details
+  CFITSIO reads the file "-" (or "stdin") from the standard input and 
+  writes the file "-" (or "stdout") to the standard output, keeping the 
+  whole file in memory, so that the tools can be chained with pipes 
+  without files on disk (e.g., "synthimage - | image2uv -o - - | imstat -").
+  Such a file can be read only once and cannot be reopened.
+
+  It returns one if fname is exactly one of these names, or zero if not,
+  so that files such as "stdin_frame.fits" are ordinary files.
+
+  @param fname[] a string with the filename
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int isFITSPipe(char fname[])
+{
+  return (strcmp(fname,"-")==0 || strcmp(fname,"stdin")==0 || strcmp(fname,"stdout")==0);
+}
+
+/*!
+  \brief 
+  Marks an output filename to overwrite an existing file
+
+  \details
+  Prepends to fname the '!' with which CFITSIO deletes an existing file
+  before it creates a new one; otherwise, the writers of this file fail
+  if the output file exists. Nothing is done for the standard output (see
+  isFITSPipe()), for in-memory files (with the prefix "mem://"), or if 
+  the filename already starts with '!'.
+
+  It returns zero if everything was OK or one (and prints an error
+  message) if the filename, with the '!', does not fit in size characters.
+
+  @param fname[] a string with the output filename, which returns the marked filename
+  @param size a size_t with the size of the string fname[]
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int overwriteFITSName(char fname[], size_t size)
+{
+  size_t len=strlen(fname);               // length of the filename
+
+  if (fname[0]=='!' || isFITSPipe(fname) || strncmp(fname,"mem://",6)==0)
+    return 0;
+
+  if (len+2>size)
+    {
+      printErrorIO("output filename too long\n");
+      return 1;
+    }
+
+  memmove(fname+1,fname,len+1);
+  fname[0]='!';
+
+  return 0;
+}
+
+/*!
+  \brief 
+  Writes the keywords that flag a Hermitian half plane of visibilities
+
+  \details
+  Adds to the current HDU the logical keyword HERMHALF, which shows that
+  only the visibilities with u>=0 are stored, and the keyword FULLNX, with
+  the number of columns Nx of the full u-v grid (which cannot be recovered
+  from the Nx/2+1 stored columns when Nx is odd).
+
+  It returns the result of the CFITSIO calls, i.e., zero if everything
+  was OK.
+
+  @param *fptr a pointer to the open FITS file
+  @param Nx an int with the number of columns of the full u-v grid
+  @param *status an int pointer with the CFITSIO status
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int writeFITSVisHalfKeys(fitsfile *fptr, int Nx, int *status)
+{
+  int logicalTrue=1;       // value of the HERMHALF keyword
+  long NxFull=Nx;          // value of the FULLNX keyword
+  int writeflag;           // flag for return values of FITS commands
+
+  writeflag=fits_write_key(fptr,TLOGICAL,"HERMHALF",&logicalTrue,"Hermitian half plane (u>=0) only",status);
+  writeflag+=fits_write_key(fptr,TLONG,"FULLNX",&NxFull,"columns of the full u-v grid",status);
+
+  return writeflag;
+}
+
+/*!
+  \brief
+  Writes the keywords with the position of a window of visibilities
+
+  \details
+  Adds to the current HDU the keywords CRPIX1, CRVAL1, CRPIX2, and CRVAL2,
+  which place the u and v of the first pixel of the window at uvOrigin.
+
+  It returns the result of the CFITSIO calls, i.e., zero if everything
+  was OK.
+
+  @param *fptr a pointer to the open FITS file
+  @param *uvOrigin a pointer to the u and v of the first pixel (in wavelengths)
+  @param *status an int pointer with the CFITSIO status
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int writeFITSVisOriginKeys(fitsfile *fptr, double *uvOrigin, int *status)
+{
+  double refPixel=1.0;     // the reference pixel is the first one
+  int writeflag;           // flag for return values of FITS commands
+
+  writeflag=fits_write_key(fptr,TDOUBLE,"CRPIX1",&refPixel,"reference pixel along u",status);
+  writeflag+=fits_write_key_dbl(fptr,"CRVAL1",uvOrigin[0],12,"u at the reference pixel, in wavelengths",status);
+  writeflag+=fits_write_key(fptr,TDOUBLE,"CRPIX2",&refPixel,"reference pixel along v",status);
+  writeflag+=fits_write_key_dbl(fptr,"CRVAL2",uvOrigin[1],12,"v at the reference pixel, in wavelengths",status);
+
+  return writeflag;
+}
+
+/*!
+  \brief 
+  Writes visibility amplitudes and phases into a FITS file
+
+  \details
+  Given two real arrays Va[] and Vp[] of dimensions Nx by Ny, it stores
+  them in the FITS file 'fname'
+
+  If halfPlane is set, the arrays hold only the Hermitian half plane of 
+  the visibilities (u>=0), with Nx/2+1 columns; the logical keyword 
+  HERMHALF and the keyword FULLNX, with the number of columns Nx of the
+  full grid, are then added to the headers so that a reader can reconstruct
+  the other half using V(-u,-v)=V*(u,v).
+
+  If uvOrigin is not NULL, the arrays hold a window of the u-v plane that
+  is not centered on the zero baseline (see the -z option of image2uv);
+  the u and v of its first pixel are then stored in the keywords CRVAL1 
+  and CRVAL2, with CRPIX1=CRPIX2=1.
+
+  The arrays Va[] and Vp[] have elements of the type 'datatype' (TDOUBLE or
+  TFLOAT) and are written to images of the type 'bitpix' (DOUBLE_IMG or
+  FLOAT_IMG); CFITSIO converts them if the two types are different. If comp
+  is not NULL, the images are tile-compressed (see createFITSImageHDU()),
+  and the phases are quantized with their own level.
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param fname[] a string with the filename to be read
+  @param Nx an int with the dimension of the "x-axis" of the full u-v grid
+  @param Ny an int with the dimension of the "y-axis"
+  @param Va[] is a Nx by Ny array with the visibility amplitudes
+  @param Vp[] is a Nx by Ny array with the visibility phases (in rad)
+  @param uScale is a double with the physical size of each pixel in the x-direction
+  @param vScale is a double with the physical size of each pixel in the x-direction
+  @param hist[] is a string of characters to be put in the "history" field of the FITS file
+  @param halfPlane is an int with a flag for whether only the half plane with u>=0 is stored
+  @param uvOrigin is a pointer to the u and v of the first pixel, or NULL for a grid centered on the zero baseline
+  @param datatype is an int with the type of the elements of Va[] and Vp[] (TDOUBLE or TFLOAT)
+  @param bitpix is an int with the type of the images in the file (DOUBLE_IMG or FLOAT_IMG)
+  @param *comp is a pointer to the compression of the images, or NULL for none
+
+  \author Dimitrios Psaltis
+  
+  \version 1.0
+  
+  \date November 3, 2017
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int writeFITSVis(char fname[], int Ny, int Nx, void *Vp, void *Va, double vScale, double uScale, char hist[], int halfPlane,
+		 double *uvOrigin, int datatype, int bitpix, fitsCompression *comp)
+{
+  // output the results into a new FITS file
+  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+  long naxes[2] = {1,1};   // dimension of each axis
+  long fpixel[2] = {1,1};  // pixel counter
+  char keyname[80],comment[80]; // strings for writing keywords to the FITS file
+  int writeflag;    // flag for return values of FITS commands
+
+  // set axes dimensions from input parameters
+  naxes[0]=(halfPlane ? Nx/2+1 : Nx);
+  naxes[1]=Ny;
+
+  // open file
+  if (!fits_create_file(&fptr, fname, &status))
+    {
+
+      // create a FITS image configuration for the Visibility Amplitude
+      createFITSImageHDU(fptr,bitpix,2,naxes,comp,0,&status);
+
+      // Write the Visibility Amplitudes
+      int writeflag=fits_write_pix(fptr, datatype, fpixel,naxes[0]*naxes[1], Va, &status);
+
+      // write the scale along the u-orientation
+      strcpy(keyname,"CDELT1");
+      writeflag+=fits_write_key_dbl(fptr,keyname,uScale,6, "in wavelengths",&status);
+      // write the scale along the u-orientation
+      strcpy(keyname,"CDELT2");
+      writeflag+=fits_write_key_dbl(fptr,keyname,vScale,6, "in wavelengths",&status);
+
+      // flag the Hermitian half plane layout
+      if (halfPlane)
+	writeflag+=writeFITSVisHalfKeys(fptr,Nx,&status);
+
+      // the position of a window that is not centered on the zero baseline
+      if (uvOrigin!=NULL)
+	writeflag+=writeFITSVisOriginKeys(fptr,uvOrigin,&status);
+      
+      // delete two standard comments
+      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+
+      // add three new comments, showing that it's the amplitudes, the history, and the date
+      writeflag+=fits_write_comment(fptr, "Visibility Amplitudes", &status);
+      writeflag+=fits_write_history(fptr, hist, &status);
+      writeflag+=fits_write_date(fptr, &status);
+
+      // create a FITS image configuration for the Visibility Phases
+      createFITSImageHDU(fptr,bitpix,2,naxes,comp,1,&status);
+
+      // write the visibility phases
+      writeflag+=fits_write_pix(fptr, datatype, fpixel,naxes[0]*naxes[1], Vp, &status);
+
+      // flag the Hermitian half plane layout
+      if (halfPlane)
+	writeflag+=writeFITSVisHalfKeys(fptr,Nx,&status);
+
+      // the position of a window that is not centered on the zero baseline
+      if (uvOrigin!=NULL)
+	writeflag+=writeFITSVisOriginKeys(fptr,uvOrigin,&status);
+
+      // write a new comment that this is about the phases
+      writeflag+=fits_write_comment(fptr, "Visibility Phases", &status);
+
+      // if any of these failed, writeflag will be non zero
+      if (writeflag!=0)
+	{
+	  printErrorIO("writing output file failed!\n");   // print error message
+	  return 1;                                     // return with error code
+	}
+      
+      // close the output file
+      fits_close_file(fptr, &status);   // close image file for now
+
+    }
+  else
+    {
+      printErrorIO("writing output file failed! Perhaps output file already exists\n");   // print error message
+      return 1;                                     // return with error code
+    }
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief 
+  Writes the keywords with the layout of a u-v grid to a FITS file
+
+  \details
+  Writes the physical sizes of the u-v pixels (CDELT1 and CDELT2) and, if
+  needed, the keywords of the Hermitian half plane layout and of the 
+  position of a window that is not centered on the zero baseline (see
+  writeFITSVis()) to the current HDU.
+
+  @param *fptr a pointer to the FITS file
+  @param Nx an int with the number of columns of the full u-v grid
+  @param vScale a double with the physical size of each pixel in the y-direction
+  @param uScale a double with the physical size of each pixel in the x-direction
+  @param halfPlane an int with a flag for whether only the half plane with u>=0 is stored
+  @param uvOrigin a pointer to the u and v of the first pixel, or NULL for a grid centered on the zero baseline
+  @param *status a pointer to the CFITSIO status
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+  \return Returns zero if successful, non-zero if not
+
+*/
+int writeFITSVisGridKeys(fitsfile *fptr, int Nx, double vScale, double uScale, int halfPlane,
+			 double *uvOrigin, int *status)
+{
+  int writeflag;           // flag for return values of FITS commands
+
+  writeflag=fits_write_key_dbl(fptr,"CDELT1",uScale,6, "in wavelengths",status);
+  writeflag+=fits_write_key_dbl(fptr,"CDELT2",vScale,6, "in wavelengths",status);
+  if (halfPlane)
+    writeflag+=writeFITSVisHalfKeys(fptr,Nx,status);
+  if (uvOrigin!=NULL)
+    writeflag+=writeFITSVisOriginKeys(fptr,uvOrigin,status);
+
+  return writeflag;
+}
+
+/*!
+  \brief 
+  Writes complex visibilities into a FITS file
+
+  \details
+  Given two real arrays Vre[] and Vim[] of dimensions Nx by Ny, with the real
+  and imaginary parts of the visibilities, it stores them in the FITS file 
+  'fname' as a single Nx by Ny by 2 image, following the convention of a
+  COMPLEX third axis: the first plane has the real parts and the second
+  plane the imaginary parts. The visibilities can then be interpolated
+  directly, without converting amplitudes and phases back to complex numbers.
+
+  The layout of the u-v grid, the types of the arrays and of the image, and
+  the return value are as for writeFITSVis().
+
+  @param fname[] a string with the filename to be written
+  @param Ny an int with the dimension of the "y-axis"
+  @param Nx an int with the dimension of the "x-axis" of the full u-v grid
+  @param Vre[] is a Nx by Ny array with the real parts of the visibilities
+  @param Vim[] is a Nx by Ny array with the imaginary parts of the visibilities
+  @param vScale is a double with the physical size of each pixel in the y-direction
+  @param uScale is a double with the physical size of each pixel in the x-direction
+  @param hist[] is a string of characters to be put in the "history" field of the FITS file
+  @param halfPlane is an int with a flag for whether only the half plane with u>=0 is stored
+  @param uvOrigin is a pointer to the u and v of the first pixel, or NULL for a grid centered on the zero baseline
+  @param datatype is an int with the type of the elements of Vre[] and Vim[] (TDOUBLE or TFLOAT)
+  @param bitpix is an int with the type of the image in the file (DOUBLE_IMG or FLOAT_IMG)
+  @param *comp is a pointer to the compression of the image, or NULL for none
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int writeFITSVisComplex(char fname[], int Ny, int Nx, void *Vre, void *Vim, double vScale, double uScale, char hist[],
+			int halfPlane, double *uvOrigin, int datatype, int bitpix, fitsCompression *comp)
+{
+  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+  long naxes[3] = {1,1,2};    // dimension of each axis
+  long fpixel[3] = {1,1,1};   // pixel counter
+  double one=1.0;   // value of the keywords of the complex axis
+  int writeflag;    // flag for return values of FITS commands
+
+  // set axes dimensions from input parameters
+  naxes[0]=(halfPlane ? Nx/2+1 : Nx);
+  naxes[1]=Ny;
+
+  // open file
+  if (!fits_create_file(&fptr, fname, &status))
+    {
+      createFITSImageHDU(fptr,bitpix,3,naxes,comp,0,&status);
+
+      // write the real parts to the first plane and the imaginary parts to the second
+      writeflag=fits_write_pix(fptr, datatype, fpixel,naxes[0]*naxes[1], Vre, &status);
+      fpixel[2]=2;
+      writeflag+=fits_write_pix(fptr, datatype, fpixel,naxes[0]*naxes[1], Vim, &status);
+
+      writeflag+=writeFITSVisGridKeys(fptr,Nx,vScale,uScale,halfPlane,uvOrigin,&status);
+
+      // the third axis is the real (1) and imaginary (2) part
+      writeflag+=fits_write_key(fptr,TSTRING,"CTYPE3","COMPLEX","1: real part, 2: imaginary part",&status);
+      writeflag+=fits_write_key(fptr,TDOUBLE,"CRPIX3",&one,"",&status);
+      writeflag+=fits_write_key(fptr,TDOUBLE,"CRVAL3",&one,"",&status);
+      writeflag+=fits_write_key(fptr,TDOUBLE,"CDELT3",&one,"",&status);
+
+      // delete two standard comments
+      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+
+      // add three new comments, showing that it's the complex visibilities, the history, and the date
+      writeflag+=fits_write_comment(fptr, "Complex Visibilities", &status);
+      writeflag+=fits_write_history(fptr, hist, &status);
+      writeflag+=fits_write_date(fptr, &status);
+
+      // if any of these failed, writeflag will be non zero
+      if (writeflag!=0)
+	{
+	  printErrorIO("writing output file failed!\n");   // print error message
+	  return 1;                                     // return with error code
+	}
+      
+      // close the output file
+      fits_close_file(fptr, &status);
+    }
+  else
+    {
+      printErrorIO("writing output file failed! Perhaps output file already exists\n");   // print error message
+      return 1;                                     // return with error code
+    }
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief 
+  Writes visibility amplitudes or power into a FITS file
+
+  \details
+  Given a real array Va[] of dimensions Nx by Ny, with the visibility 
+  amplitudes or, if power is set, the squared visibility amplitudes, it
+  stores it in the FITS file 'fname' as a single image, with no phases.
+
+  The layout of the u-v grid, the types of the array and of the image, and
+  the return value are as for writeFITSVis().
+
+  @param fname[] a string with the filename to be written
+  @param Ny an int with the dimension of the "y-axis"
+  @param Nx an int with the dimension of the "x-axis" of the full u-v grid
+  @param Va[] is a Nx by Ny array with the visibility amplitudes or power
+  @param vScale is a double with the physical size of each pixel in the y-direction
+  @param uScale is a double with the physical size of each pixel in the x-direction
+  @param hist[] is a string of characters to be put in the "history" field of the FITS file
+  @param halfPlane is an int with a flag for whether only the half plane with u>=0 is stored
+  @param uvOrigin is a pointer to the u and v of the first pixel, or NULL for a grid centered on the zero baseline
+  @param power is an int with a flag for whether Va[] holds the squared amplitudes
+  @param datatype is an int with the type of the elements of Va[] (TDOUBLE or TFLOAT)
+  @param bitpix is an int with the type of the image in the file (DOUBLE_IMG or FLOAT_IMG)
+  @param *comp is a pointer to the compression of the image, or NULL for none
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int writeFITSVisAmp(char fname[], int Ny, int Nx, void *Va, double vScale, double uScale, char hist[],
+		    int halfPlane, double *uvOrigin, int power, int datatype, int bitpix, fitsCompression *comp)
+{
+  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+  long naxes[2] = {1,1};   // dimension of each axis
+  long fpixel[2] = {1,1};  // pixel counter
+  int writeflag;    // flag for return values of FITS commands
+
+  // set axes dimensions from input parameters
+  naxes[0]=(halfPlane ? Nx/2+1 : Nx);
+  naxes[1]=Ny;
+
+  // open file
+  if (!fits_create_file(&fptr, fname, &status))
+    {
+      createFITSImageHDU(fptr,bitpix,2,naxes,comp,0,&status);
+
+      writeflag=fits_write_pix(fptr, datatype, fpixel,naxes[0]*naxes[1], Va, &status);
+
+      writeflag+=writeFITSVisGridKeys(fptr,Nx,vScale,uScale,halfPlane,uvOrigin,&status);
+
+      // delete two standard comments
+      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+
+      // add three new comments, showing what is stored, the history, and the date
+      writeflag+=fits_write_comment(fptr, (power ? "Visibility Power" : "Visibility Amplitudes"), &status);
+      writeflag+=fits_write_history(fptr, hist, &status);
+      writeflag+=fits_write_date(fptr, &status);
+
+      // if any of these failed, writeflag will be non zero
+      if (writeflag!=0)
+	{
+	  printErrorIO("writing output file failed!\n");   // print error message
+	  return 1;                                     // return with error code
+	}
+      
+      // close the output file
+      fits_close_file(fptr, &status);
+    }
+  else
+    {
+      printErrorIO("writing output file failed! Perhaps output file already exists\n");   // print error message
+      return 1;                                     // return with error code
+    }
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief 
+  Writes several sets of visibilities into the HDUs of one FITS file
+
+  \details
+  Given Nhdu sets of visibilities on the same u-v grid of dimensions Nx by
+  Ny, it stores each set in its own HDU of the FITS file 'fname': the
+  first set in the primary HDU and the others in image extensions. If
+  Vim[h] is NULL, the h-th HDU is a real Nx by Ny image with Vre[h]
+  (e.g., amplitudes, phases, or power). Otherwise, it is an Nx by Ny by 2
+  image with a COMPLEX third axis, with Vre[h] and Vim[h] as the real and
+  imaginary parts, as in writeFITSVisComplex().
+
+  Each HDU has the keyword EXTNAME set to extname[h], a comment with
+  comment[h], and the keywords of the u-v grid. The history and the date
+  are written only in the primary HDU.
+
+  The layout of the u-v grid, the types of the arrays and of the images,
+  the compression, and the return value are as for writeFITSVis(); the
+  HDUs whose names end in PHASE and the EVPA are quantized as phases.
+
+  @param fname[] a string with the filename to be written
+  @param Ny an int with the dimension of the "y-axis"
+  @param Nx an int with the dimension of the "x-axis" of the full u-v grid
+  @param Nhdu an int with the number of HDUs
+  @param **Vre is an array of Nhdu pointers to the Nx by Ny arrays of the HDUs (real parts for complex HDUs)
+  @param **Vim is an array of Nhdu pointers to the imaginary parts of the HDUs, or NULL for real HDUs
+  @param **extname is an array of Nhdu strings with the names of the HDUs
+  @param **comment is an array of Nhdu strings with the descriptions of the HDUs
+  @param vScale is a double with the physical size of each pixel in the y-direction
+  @param uScale is a double with the physical size of each pixel in the x-direction
+  @param hist[] is a string of characters to be put in the "history" field of the FITS file
+  @param halfPlane is an int with a flag for whether only the half plane with u>=0 is stored
+  @param uvOrigin is a pointer to the u and v of the first pixel, or NULL for a grid centered on the zero baseline
+  @param datatype is an int with the type of the elements of the arrays (TDOUBLE or TFLOAT)
+  @param bitpix is an int with the type of the images in the file (DOUBLE_IMG or FLOAT_IMG)
+  @param *comp is a pointer to the compression of the images, or NULL for none
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int writeFITSVisCube(char fname[], int Ny, int Nx, int Nhdu, void **Vre, void **Vim, char **extname, char **comment,
+		     double vScale, double uScale, char hist[], int halfPlane, double *uvOrigin, int datatype, int bitpix,
+		     fitsCompression *comp)
+{
+  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+  long naxes[3] = {1,1,2};    // dimension of each axis
+  long fpixel[3] = {1,1,1};   // pixel counter
+  double one=1.0;   // value of the keywords of the complex axis
+  int writeflag=0;  // flag for return values of FITS commands
+  int hdu;          // dummy index for counting HDUs
+  int isPhase;      // flag for whether an HDU holds phases
+  size_t len;       // length of the name of an HDU
+
+  // set axes dimensions from input parameters
+  naxes[0]=(halfPlane ? Nx/2+1 : Nx);
+  naxes[1]=Ny;
+
+  // open file
+  if (!fits_create_file(&fptr, fname, &status))
+    {
+      for (hdu=0;hdu<Nhdu;hdu++)
+	{
+	  // phases are the HDUs named *PHASE and the EVPA
+	  len=strlen(extname[hdu]);
+	  isPhase=((len>=5 && strcmp(extname[hdu]+len-5,"PHASE")==0) || strcmp(extname[hdu],"EVPA")==0);
+
+	  // the first call makes the primary HDU, the following ones append extensions
+	  createFITSImageHDU(fptr,bitpix,(Vim[hdu]==NULL ? 2 : 3),naxes,comp,isPhase,&status);
+
+	  fpixel[2]=1;
+	  writeflag+=fits_write_pix(fptr, datatype, fpixel,naxes[0]*naxes[1], Vre[hdu], &status);
+	  if (Vim[hdu]!=NULL)
+	    {
+	      fpixel[2]=2;
+	      writeflag+=fits_write_pix(fptr, datatype, fpixel,naxes[0]*naxes[1], Vim[hdu], &status);
+	    }
+
+	  writeflag+=fits_write_key(fptr,TSTRING,"EXTNAME",extname[hdu],"",&status);
+	  writeflag+=writeFITSVisGridKeys(fptr,Nx,vScale,uScale,halfPlane,uvOrigin,&status);
+
+	  if (Vim[hdu]!=NULL)
+	    {
+	      // the third axis is the real (1) and imaginary (2) part
+	      writeflag+=fits_write_key(fptr,TSTRING,"CTYPE3","COMPLEX","1: real part, 2: imaginary part",&status);
+	      writeflag+=fits_write_key(fptr,TDOUBLE,"CRPIX3",&one,"",&status);
+	      writeflag+=fits_write_key(fptr,TDOUBLE,"CRVAL3",&one,"",&status);
+	      writeflag+=fits_write_key(fptr,TDOUBLE,"CDELT3",&one,"",&status);
+	    }
+
+	  if (hdu==0)
+	    {
+	      // delete two standard comments
+	      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+	      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+	    }
+
+	  // add a comment showing what is stored in this HDU
+	  writeflag+=fits_write_comment(fptr, comment[hdu], &status);
+
+	  if (hdu==0)
+	    {
+	      // and the history and the date in the primary HDU
+	      writeflag+=fits_write_history(fptr, hist, &status);
+	      writeflag+=fits_write_date(fptr, &status);
+	    }
+	}
+
+      // if any of these failed, writeflag will be non zero
+      if (writeflag!=0)
+	{
+	  printErrorIO("writing output file failed!\n");   // print error message
+	  return 1;                                     // return with error code
+	}
+      
+      // close the output file
+      fits_close_file(fptr, &status);
+    }
+  else
+    {
+      printErrorIO("writing output file failed! Perhaps output file already exists\n");   // print error message
+      return 1;                                     // return with error code
+    }
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief 
+  Creates a FITS file for a movie of visibilities, to be written one frame at a time
+
+  \details
+  Creates the FITS file 'fname' for the visibilities of Nt frames of a
+  movie on the same u-v grid of dimensions Nx by Ny, with Nhdu HDUs (the
+  first one is the primary HDU). If isComplex[h] is zero, the h-th HDU is
+  an Nx by Ny by Nt cube (e.g., of amplitudes, phases, or power); otherwise
+  it is an Nx by Ny by 2 by Nt cube with a COMPLEX third axis, with the
+  real and imaginary parts, as in writeFITSVisComplex(). The last axis has
+  CTYPE='TIME' and counts the frames, starting from 0. If Nt is zero, the
+  file holds a single set of visibilities without a time axis, with the 
+  same layout as the files of writeFITSVis(), writeFITSVisComplex(), and
+  writeFITSVisAmp().
+
+  Each HDU has the keyword EXTNAME set to extname[h] (unless extname is
+  NULL), a comment with comment[h], and the keywords of the u-v grid, as in
+  writeFITSVisCube(). The frames are then written with 
+  writeFITSVisMovieFrame(), in any order, or in blocks of rows with
+  writeFITSVisRows(), and the file is closed with closeFITSVisMovie(), so
+  that only one frame, or one block of rows, needs to be in memory at any
+  time.
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param fname[] a string with the filename to be written
+  @param Ny an int with the dimension of the "y-axis"
+  @param Nx an int with the dimension of the "x-axis" of the full u-v grid
+  @param Nt an int with the number of frames (0 for no time axis)
+  @param Nhdu an int with the number of HDUs
+  @param *isComplex is an array of Nhdu flags for the HDUs with real and imaginary parts
+  @param **extname is an array of Nhdu strings with the names of the HDUs, or NULL for no names
+  @param **comment is an array of Nhdu strings with the descriptions of the HDUs
+  @param vScale is a double with the physical size of each pixel in the y-direction
+  @param uScale is a double with the physical size of each pixel in the x-direction
+  @param hist[] is a string of characters to be put in the "history" field of the FITS file
+  @param halfPlane is an int with a flag for whether only the half plane with u>=0 is stored
+  @param bitpix is an int with the type of the images in the file (DOUBLE_IMG or FLOAT_IMG)
+  @param **fptr on return, a pointer to the open FITS file
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int createFITSVisMovie(char fname[], int Ny, int Nx, int Nt, int Nhdu, int *isComplex, char **extname, char **comment,
+		       double vScale, double uScale, char hist[], int halfPlane, int bitpix, fitsfile **fptr)
+{
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+  long naxes[4] = {1,1,1,1};  // dimension of each axis
+  double one=1.0, zero=0.0;   // values of the keywords of the complex and time axes
+  char keyname[80]; // name of the keywords of the time axis
+  int naxis;        // number of axes of an HDU
+  int writeflag=0;  // flag for return values of FITS commands
+  int hdu;          // dummy index for counting HDUs
+
+  // set axes dimensions from input parameters
+  naxes[0]=(halfPlane ? Nx/2+1 : Nx);
+  naxes[1]=Ny;
+
+  // open file
+  if (!fits_create_file(fptr, fname, &status))
+    {
+      for (hdu=0;hdu<Nhdu;hdu++)
+	{
+	  // the time is the last axis, if any
+	  naxis=(isComplex[hdu] ? 3 : 2)+(Nt>0 ? 1 : 0);
+	  naxes[2]=(isComplex[hdu] ? 2 : Nt);
+	  naxes[3]=Nt;
+	  
+	  // the first call makes the primary HDU, the following ones append extensions
+	  fits_create_img(*fptr,bitpix,naxis,naxes, &status);
+
+	  if (extname!=NULL)
+	    writeflag+=fits_write_key(*fptr,TSTRING,"EXTNAME",extname[hdu],"",&status);
+	  writeflag+=writeFITSVisGridKeys(*fptr,Nx,vScale,uScale,halfPlane,NULL,&status);
+
+	  if (isComplex[hdu])
+	    {
+	      // the third axis is the real (1) and imaginary (2) part
+	      writeflag+=fits_write_key(*fptr,TSTRING,"CTYPE3","COMPLEX","1: real part, 2: imaginary part",&status);
+	      writeflag+=fits_write_key(*fptr,TDOUBLE,"CRPIX3",&one,"",&status);
+	      writeflag+=fits_write_key(*fptr,TDOUBLE,"CRVAL3",&one,"",&status);
+	      writeflag+=fits_write_key(*fptr,TDOUBLE,"CDELT3",&one,"",&status);
+	    }
+
+	  // the last axis counts the frames
+	  if (Nt>0)
+	    {
+	      snprintf(keyname,80,"CTYPE%d",naxis);
+	      writeflag+=fits_write_key(*fptr,TSTRING,keyname,"TIME","frame number, starting from 0",&status);
+	      snprintf(keyname,80,"CRPIX%d",naxis);
+	      writeflag+=fits_write_key(*fptr,TDOUBLE,keyname,&one,"",&status);
+	      snprintf(keyname,80,"CRVAL%d",naxis);
+	      writeflag+=fits_write_key(*fptr,TDOUBLE,keyname,&zero,"",&status);
+	      snprintf(keyname,80,"CDELT%d",naxis);
+	      writeflag+=fits_write_key(*fptr,TDOUBLE,keyname,&one,"",&status);
+	    }
+
+	  if (hdu==0)
+	    {
+	      // delete two standard comments
+	      writeflag+=fits_delete_key(*fptr, "COMMENT", &status);
+	      writeflag+=fits_delete_key(*fptr, "COMMENT", &status);
+	    }
+
+	  // add a comment showing what is stored in this HDU
+	  writeflag+=fits_write_comment(*fptr, comment[hdu], &status);
+
+	  if (hdu==0)
+	    {
+	      // and the history and the date in the primary HDU
+	      writeflag+=fits_write_history(*fptr, hist, &status);
+	      writeflag+=fits_write_date(*fptr, &status);
+	    }
+	}
+
+      // if any of these failed, writeflag will be non zero
+      if (writeflag!=0)
+	{
+	  printErrorIO("writing output file failed!\n");   // print error message
+	  return 1;                                     // return with error code
+	}
+    }
+  else
+    {
+      printErrorIO("writing output file failed! Perhaps output file already exists\n");   // print error message
+      return 1;                                     // return with error code
+    }
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief 
+  Writes one frame of a movie of visibilities
+
+  \details
+  Writes the visibilities of the frame iFrame (starting from 0) into the
+  Nhdu HDUs of the FITS file created by createFITSVisMovie(), with the
+  same layout of the u-v grid. For the h-th HDU, Vre[h] is the Nx by Ny
+  array of the frame and, for an HDU with real and imaginary parts, Vim[h]
+  has the imaginary parts (otherwise it is NULL).
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param *fptr a pointer to the FITS file created by createFITSVisMovie()
+  @param Ny an int with the dimension of the "y-axis"
+  @param Nx an int with the dimension of the "x-axis" of the full u-v grid
+  @param halfPlane is an int with a flag for whether only the half plane with u>=0 is stored
+  @param iFrame an int with the frame (starting from 0)
+  @param Nhdu an int with the number of HDUs
+  @param **Vre is an array of Nhdu pointers to the Nx by Ny arrays of the frame (real parts for complex HDUs)
+  @param **Vim is an array of Nhdu pointers to the imaginary parts of the frame, or NULL for real HDUs
+  @param datatype is an int with the type of the elements of the arrays (TDOUBLE or TFLOAT)
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int writeFITSVisMovieFrame(fitsfile *fptr, int Ny, int Nx, int halfPlane, int iFrame,
+			   int Nhdu, void **Vre, void **Vim, int datatype)
+{
+  return writeFITSVisRows(fptr, Ny, Nx, halfPlane, iFrame, 0, Ny, Nhdu, Vre, Vim, datatype);
+}
+
+/*!
+  \brief 
+  Writes a block of rows of one frame of a file of visibilities
+
+  \details
+  Writes the Nrows rows of the u-v grid starting from the row firstRow 
+  (starting from 0) of the frame iFrame (starting from 0) into the Nhdu
+  HDUs of the FITS file created by createFITSVisMovie(). For the h-th HDU, 
+  Vre[h] is the Nx by Nrows array of the rows and, for an HDU with real 
+  and imaginary parts, Vim[h] has the imaginary parts (otherwise it is 
+  NULL). If the file has no time axis, iFrame is zero.
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't, and one if the rows are not all in the
+  Ny rows of the u-v grid.
+
+  @param *fptr a pointer to the FITS file created by createFITSVisMovie()
+  @param Ny an int with the dimension of the "y-axis"
+  @param Nx an int with the dimension of the "x-axis" of the full u-v grid
+  @param halfPlane is an int with a flag for whether only the half plane with u>=0 is stored
+  @param iFrame an int with the frame (starting from 0)
+  @param firstRow an int with the first row to be written (starting from 0)
+  @param Nrows an int with the number of rows to be written
+  @param Nhdu an int with the number of HDUs
+  @param **Vre is an array of Nhdu pointers to the Nx by Nrows arrays of the rows (real parts for complex HDUs)
+  @param **Vim is an array of Nhdu pointers to the imaginary parts of the rows, or NULL for real HDUs
+  @param datatype is an int with the type of the elements of the arrays (TDOUBLE or TFLOAT)
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int writeFITSVisRows(fitsfile *fptr, int Ny, int Nx, int halfPlane, int iFrame, int firstRow, int Nrows,
+		     int Nhdu, void **Vre, void **Vim, int datatype)
+{
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+  long fpixel[4] = {1,1,1,1}; // pixel counter
+  long Npixels=(long)(halfPlane ? Nx/2+1 : Nx)*Nrows; // number of pixels of the rows
+  int hdu;          // dummy index for counting HDUs
+
+  // the rows need to be in the u-v grid
+  if (firstRow<0 || Nrows<0 || firstRow+Nrows>Ny)
+    {
+      printErrorIO("writeFITSVisRows: rows beyond the u-v grid\n");
+      return 1;
+    }
+
+  fpixel[1]=firstRow+1;
+  for (hdu=0;hdu<Nhdu;hdu++)
+    {
+      fits_movabs_hdu(fptr, hdu+1, NULL, &status);
+      if (Vim[hdu]==NULL)
+	{
+	  fpixel[2]=iFrame+1;
+	  fpixel[3]=1;
+	  fits_write_pix(fptr, datatype, fpixel, Npixels, Vre[hdu], &status);
+	}
+      else
+	{
+	  fpixel[2]=1;
+	  fpixel[3]=iFrame+1;
+	  fits_write_pix(fptr, datatype, fpixel, Npixels, Vre[hdu], &status);
+	  fpixel[2]=2;
+	  fits_write_pix(fptr, datatype, fpixel, Npixels, Vim[hdu], &status);
+	}
+    }
+
+  if (status)
+    {
+      printErrorIO("writing output file failed!\n");
+      fits_report_error(stderr, status); 
+    }
+
+  return(status);
+}
+
+/*!
+  \brief 
+  Writes a rectangle of one frame of a file of visibilities
+
+  \details
+  Writes the Nrows rows starting from the row firstRow and the Ncols
+  columns starting from the column firstCol (both starting from 0) of the
+  u-v grid of the frame iFrame (starting from 0) into the Nhdu HDUs of the
+  FITS file created by createFITSVisMovie(), as writeFITSVisRows() does
+  for whole rows. For the h-th HDU, Vre[h] is the Ncols by Nrows array of
+  the rectangle and, for an HDU with real and imaginary parts, Vim[h] has
+  the imaginary parts (otherwise it is NULL). If the file has no time 
+  axis, iFrame is zero.
+
+  This allows a file to be written in pieces that are not whole rows, e.g., 
+  by the MPI ranks that each hold the visibilities with u>=0 of some rows
+  and those with u<0 of the mirrored rows.
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param *fptr a pointer to the FITS file created by createFITSVisMovie()
+  @param iFrame an int with the frame (starting from 0)
+  @param firstRow an int with the first row to be written (starting from 0)
+  @param Nrows an int with the number of rows to be written
+  @param firstCol an int with the first column to be written (starting from 0)
+  @param Ncols an int with the number of columns to be written
+  @param Nhdu an int with the number of HDUs
+  @param **Vre is an array of Nhdu pointers to the Ncols by Nrows arrays of the rectangle (real parts for complex HDUs)
+  @param **Vim is an array of Nhdu pointers to the imaginary parts of the rectangle, or NULL for real HDUs
+  @param datatype is an int with the type of the elements of the arrays (TDOUBLE or TFLOAT)
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int writeFITSVisSubset(fitsfile *fptr, int iFrame, int firstRow, int Nrows, int firstCol, int Ncols,
+		       int Nhdu, void **Vre, void **Vim, int datatype)
+{
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+  long fpixel[4] = {1,1,1,1}; // first pixel of the rectangle
+  long lpixel[4] = {1,1,1,1}; // last pixel of the rectangle
+  int hdu;          // dummy index for counting HDUs
+
+  fpixel[0]=firstCol+1;
+  lpixel[0]=firstCol+Ncols;
+  fpixel[1]=firstRow+1;
+  lpixel[1]=firstRow+Nrows;
+  for (hdu=0;hdu<Nhdu;hdu++)
+    {
+      fits_movabs_hdu(fptr, hdu+1, NULL, &status);
+      if (Vim[hdu]==NULL)
+	{
+	  fpixel[2]=lpixel[2]=iFrame+1;
+	  fits_write_subset(fptr, datatype, fpixel, lpixel, Vre[hdu], &status);
+	}
+      else
+	{
+	  fpixel[3]=lpixel[3]=iFrame+1;
+	  fpixel[2]=lpixel[2]=1;
+	  fits_write_subset(fptr, datatype, fpixel, lpixel, Vre[hdu], &status);
+	  fpixel[2]=lpixel[2]=2;
+	  fits_write_subset(fptr, datatype, fpixel, lpixel, Vim[hdu], &status);
+	}
+    }
+
+  if (status)
+    {
+      printErrorIO("writing output file failed!\n");
+      fits_report_error(stderr, status); 
+    }
+
+  return(status);
+}
+
+/*!
+  \brief 
+  Opens again a FITS file for a movie of visibilities, in order to write more of it
+
+  \details
+  Opens the FITS file 'fname', which was created by createFITSVisMovie()
+  (and closed), for writing with writeFITSVisRows() or writeFITSVisSubset().
+  The file is then closed again with closeFITSVisMovie(). This allows
+  more than one process to write the same file, one after the other.
+
+  @param fname[] a string with the filename to be opened
+  @param **fptr on return, a pointer to the open FITS file
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+  \return Returns zero if everything was OK or the FITS error code if it wasn't
+
+*/
+int openFITSVisMovie(char fname[], fitsfile **fptr)
+{
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+
+  if (fits_open_file(fptr, fname, READWRITE, &status))
+    printErrorIO("opening output file failed!\n");   // print error message
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief 
+  Closes a FITS file for a movie of visibilities
+
+  @param *fptr a pointer to the FITS file created by createFITSVisMovie()
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+  \return Returns zero if everything was OK or the FITS error code if it wasn't
+
+*/
+int closeFITSVisMovie(fitsfile *fptr)
+{
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+
+  fits_close_file(fptr, &status);
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief
+  Writes the visibilities at a list of baselines into a FITS table
+
+  \details
+  Given the Nb baselines (u[],v[]) and the visibilities at them, it stores
+  them in a binary table (extension VISIBILITIES) of the FITS file 'fname',
+  with one row per baseline and the columns U and V (in wavelengths), RE and
+  IM (the real and imaginary parts), AMP, PHASE (in rad), and POWER (the
+  squared amplitudes). The columns AMP, PHASE, and POWER are written only
+  if the corresponding arrays are not NULL. The visibilities are in the 
+  arbitrary units of the brightness of the image, so their columns have
+  no units.
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param fname[] a string with the filename to be written
+  @param Nb an int with the number of baselines
+  @param u[] a double array with the u-coordinates of the baselines
+  @param v[] a double array with the v-coordinates of the baselines
+  @param Vre[] a double array with the real parts of the visibilities
+  @param Vim[] a double array with the imaginary parts of the visibilities
+  @param Va[] a double array with the visibility amplitudes (or NULL)
+  @param Vp[] a double array with the visibility phases (in rad; or NULL)
+  @param Vpow[] a double array with the squared visibility amplitudes (or NULL)
+  @param hist[] is a string of characters to be put in the "history" field of the FITS file
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int writeFITSVisTable(char fname[], int Nb, double *u, double *v, double *Vre, double *Vim,
+		      double *Va, double *Vp, double *Vpow, char hist[])
+{
+  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
+  int status = 0;   // CFITSIO status value MUST be initialized to zero!
+  char *names[7] = {"U","V","RE","IM","AMP","PHASE","POWER"};     // names of all the columns
+  char *units[7] = {"lambda","lambda","","","","rad",""};         // units of all the columns (the image has none)
+  double *data[7];                                                // arrays of all the columns
+  char *ttype[7],*tform[7],*tunit[7];                             // names, formats and units of the columns written
+  int iCol,Ncols=0;                                               // dummy index and number of the columns written
+  int writeflag;    // flag for return values of FITS commands
+
+  // the columns that are written
+  data[0]=u;
+  data[1]=v;
+  data[2]=Vre;
+  data[3]=Vim;
+  data[4]=Va;
+  data[5]=Vp;
+  data[6]=Vpow;
+  for (iCol=0;iCol<7;iCol++)
+    if (data[iCol]!=NULL)
+      {
+	ttype[Ncols]=names[iCol];
+	tform[Ncols]="1D";
+	tunit[Ncols]=units[iCol];
+	data[Ncols]=data[iCol];
+	Ncols++;
+      }
+
+  // open file
+  if (!fits_create_file(&fptr, fname, &status))
+    {
+      // create the table, after an empty primary HDU
+      writeflag=fits_create_tbl(fptr, BINARY_TBL, Nb, Ncols, ttype, tform, tunit, "VISIBILITIES", &status);
+
+      // write the columns
+      for (iCol=0;iCol<Ncols;iCol++)
+	writeflag+=fits_write_col(fptr, TDOUBLE, iCol+1, 1, 1, Nb, data[iCol], &status);
+
+      // add a comment, the history, and the date
+      writeflag+=fits_write_comment(fptr, "Visibilities at a list of baselines", &status);
+      writeflag+=fits_write_history(fptr, hist, &status);
+      writeflag+=fits_write_date(fptr, &status);
+
+      // if any of these failed, writeflag will be non zero
+      if (writeflag!=0)
+	{
+	  printErrorIO("writing output file failed!\n");   // print error message
+	  return 1;                                     // return with error code
+	}
+
+      // close the output file
+      fits_close_file(fptr, &status);
+
+    }
+  else
+    {
+      printErrorIO("writing output file failed! Perhaps output file already exists\n");   // print error message
+      return 1;                                     // return with error code
+    }
+
+  // print any error message
+  if (status) fits_report_error(stderr, status);
+
+  return(status);
+}
+
+/*!
+  \brief 
+  Writes a model image into a FITS file
+
+  \details
+  Given the array Image of dimensions Ny by Nx, it stores
+  it in the FITS file 'fname'
+
+  The array has elements of the type 'datatype' (TDOUBLE or TFLOAT) and is
+  written to an image of the type 'bitpix' (DOUBLE_IMG or FLOAT_IMG);
+  CFITSIO converts it if the two types are different. If comp is not NULL,
+  the image is tile-compressed (see createFITSImageHDU()).
+
+  It returns zero if everything was OK or the FITS error code (and prints
+  an error message) if it wasn't.
+
+  @param fname[] a string with the filename to be read
+  @param Ny an int with the number of rows of the image
+  @param Nx an int with the number of columns of the image
+  @param pixelSize a double with the physical size of each pixel
+  @param Image[] a Ny by Nx array with the image
+  @param hist[] a string of characters to be put in the "history" field of the FITS file
+  @param datatype an int with the type of the elements of Image[] (TDOUBLE or TFLOAT)
+  @param bitpix an int with the type of the image in the file (DOUBLE_IMG or FLOAT_IMG)
+  @param *comp a pointer to the compression of the image, or NULL for none
+
+  \author Dimitrios Psaltis
+  
+  \version 1.0
+  
+  \date November 3, 2017
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int writeFITSImage(char fname[], int Ny, int Nx, double pixelSize, void *Image, char hist[], int datatype, int bitpix,
+		   fitsCompression *comp)
+{
+  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
+  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
+  long naxes[2] = {1,1};   // dimension of each axis
+  long fpixel[2] = {1,1};  // pixel counter
+  char keyname[80],comment[80]; // strings for writing keywords to the FITS file
+  int writeflag;    // flag for return values of FITS commands
+
+  // set axes dimensions from input parameters
+  naxes[0]=Nx;
+  naxes[1]=Ny;
+
+  // open file
+  if (!fits_create_file(&fptr, fname, &status))
+    {
+
+      // create a FITS image configuration for the Image
+      createFITSImageHDU(fptr,bitpix,2,naxes,comp,0,&status);
+
+      // Write the Image
+      int writeflag=fits_write_pix(fptr, datatype, fpixel,naxes[0]*naxes[1], Image, &status);
+
+      // write the scale along the x-orientation
+      strcpy(keyname,"CDELT1");
+      writeflag+=fits_write_key_dbl(fptr,keyname,pixelSize,6, "in degrees",&status);
+      // write the scale along the y-orientation
+      strcpy(keyname,"CDELT2");
+      writeflag+=fits_write_key_dbl(fptr,keyname,pixelSize,6, "in degrees",&status);
+      
+      // delete two standard comments
+      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+
+      // add two new comments, showing the history, and the date
+      writeflag+=fits_write_history(fptr, hist, &status);
+      writeflag+=fits_write_date(fptr, &status);
+
+      // if any of these failed, writeflag will be non zero
+      if (writeflag!=0)
+	{
+	  printErrorIO("writing output file failed!\n");   // print error message
+	  return 1;                                     // return with error code
+	}
+      
+      // close the output file
+      fits_close_file(fptr, &status);   // close image file for now
+
+    }
+  else
+    {
+      printErrorIO("writing output file failed! Perhaps output file already exists\n");   // print error message
+      return 1;                                     // return with error code
+    }
+
+  // print any error message
+  if (status) fits_report_error(stderr, status); 
+  
+  return(status);
+}
+
+/*!
+  \brief 
+  The thread that prefetches the files queued with queueFITSPrefetch()
+
+  \details
+  Takes the filenames from the queue of the prefetcher, one at a time, 
+  and asks the kernel to read each file into the page cache with 
+  posix_fadvise(POSIX_FADV_WILLNEED), which starts the reading and 
+  returns. The open() and the reading of the metadata of each file, which
+  are often the slowest part on a network filesystem, are done on this
+  thread, so that the thread that later reads the file finds it in memory.
+  Files that cannot be opened (e.g., names with the CFITSIO extended 
+  filename syntax) are skipped; they are read as usual.
+
+  @param *arg a pointer to the prefetcher (fitsPrefetch)
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+void *prefetchFITSThread(void *arg)
+{
+  fitsPrefetch *pf=(fitsPrefetch *)arg;   // the prefetcher
+  char *fname;                            // the file that is prefetched
+  int fd;                                 // file descriptor of the file
+
+  pthread_mutex_lock(&pf->lock);
+  while (1)
+    {
+      while (pf->count==0 && !pf->stop)
+	pthread_cond_wait(&pf->cond,&pf->lock);
+      if (pf->stop)
+	break;
+
+      fname=pf->names[pf->first];
+      pf->first=(pf->first+1)%PREFETCHQUEUE;
+      pf->count--;
+      pthread_mutex_unlock(&pf->lock);
+
+      fd=open(fname,O_RDONLY);
+      if (fd>=0)
+	{
+	  posix_fadvise(fd,0,0,POSIX_FADV_WILLNEED);
+	  close(fd);
+	}
+
+      pthread_mutex_lock(&pf->lock);
+    }
+  pthread_mutex_unlock(&pf->lock);
+
+  return NULL;
+}
+
+/*!
+  \brief 
+  Starts a thread that prefetches input files into the page cache
+
+  \details
+  The files are given, in the order in which they will be read, with 
+  queueFITSPrefetch(), and are prefetched one at a time by 
+  prefetchFITSThread() while the caller reads and processes earlier files.
+  The thread is stopped with stopFITSPrefetch().
+
+  It returns zero if the thread was started or one (and prints an error
+  message) if it wasn't, in which case the files are simply not prefetched.
+
+  @param *pf a pointer to the prefetcher
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int startFITSPrefetch(fitsPrefetch *pf)
+{
+  pf->first=0;
+  pf->count=0;
+  pf->stop=0;
+  pthread_mutex_init(&pf->lock,NULL);
+  pthread_cond_init(&pf->cond,NULL);
+
+  if (pthread_create(&pf->thread,NULL,prefetchFITSThread,pf)!=0)
+    {
+      pthread_mutex_destroy(&pf->lock);
+      pthread_cond_destroy(&pf->cond);
+      printErrorIO("could not start the prefetching of the input files\n");
+      return 1;
+    }
+
+  return 0;
+}
+
+/*!
+  \brief 
+  Queues a file to be prefetched
+
+  \details
+  The string fname[] is not copied and needs to exist until the file is
+  prefetched or stopFITSPrefetch() is called. If the queue already has 
+  PREFETCHQUEUE files, the file is not prefetched; the caller never waits.
+  Nothing is done if pf is NULL.
+
+  @param *pf a pointer to the prefetcher started with startFITSPrefetch(), or NULL
+  @param fname[] a string with the filename to be prefetched
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+void queueFITSPrefetch(fitsPrefetch *pf, char fname[])
+{
+  if (pf==NULL)
+    return;
+
+  pthread_mutex_lock(&pf->lock);
+  if (pf->count<PREFETCHQUEUE)
+    {
+      pf->names[(pf->first+pf->count)%PREFETCHQUEUE]=fname;
+      pf->count++;
+      pthread_cond_signal(&pf->cond);
+    }
+  pthread_mutex_unlock(&pf->lock);
+
+  return;
+}
+
+/*!
+  \brief 
+  Stops the thread of a prefetcher
+
+  \details
+  The files that are still in the queue are not prefetched.
+
+  @param *pf a pointer to the prefetcher started with startFITSPrefetch()
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+void stopFITSPrefetch(fitsPrefetch *pf)
+{
+  pthread_mutex_lock(&pf->lock);
+  pf->stop=1;
+  pthread_cond_signal(&pf->cond);
+  pthread_mutex_unlock(&pf->lock);
+
+  pthread_join(pf->thread,NULL);
+  pthread_mutex_destroy(&pf->lock);
+  pthread_cond_destroy(&pf->cond);
+
+  return;
+}
+
+/*!
+  \brief 
+  The thread that writes the outputs queued with queueFITSWrite()
+
+  \details
+  Takes the slots from the queue of the writer, in the order in which 
+  they were queued, writes each one with the write function of the 
+  writer, and returns the slot to the free slots. It counts the writes
+  that fail.
+
+  @param *arg a pointer to the writer (fitsWriter)
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+void *writeFITSThread(void *arg)
+{
+  fitsWriter *w=(fitsWriter *)arg;        // the writer
+  void *slot;                             // the slot that is written
+  int writeflag;                          // flag for the result of writing
+
+  pthread_mutex_lock(&w->lock);
+  while (1)
+    {
+      while (w->Nqueued==0 && !w->stop)
+	pthread_cond_wait(&w->queued,&w->lock);
+      if (w->Nqueued==0)
+	break;
+
+      slot=w->queue[w->first];
+      w->first=(w->first+1)%w->Nslots;
+      w->Nqueued--;
+      pthread_mutex_unlock(&w->lock);
+
+      writeflag=w->write(slot);
+
+      pthread_mutex_lock(&w->lock);
+      if (writeflag!=0)
+	w->Nfailed++;
+      w->freeSlots[w->Nfree++]=slot;
+      pthread_cond_signal(&w->freed);
+    }
+  pthread_mutex_unlock(&w->lock);
+
+  return NULL;
+}
+
+/*!
+  \brief 
+  Starts a bounded queue of outputs that are written in the background
+
+  \details
+  The writer has Nslots buffers ("slots") of slotSize bytes each. The
+  caller takes a free slot with getFITSWriterSlot(), fills it with 
+  whatever the function write() needs to write one output (e.g., the 
+  filename, the keywords, and the arrays of the images), and queues it 
+  with queueFITSWrite(). If background is set, a thread (writeFITSThread())
+  writes the queued slots with write(), one at a time and in order, 
+  through CFITSIO, while the caller goes on computing the next outputs;
+  the caller waits only when all the slots are queued, so that at most
+  Nslots outputs are in memory. Otherwise, each slot is written by 
+  queueFITSWrite() itself, before it returns. The queue is emptied and
+  the thread stopped with stopFITSWriter().
+
+  The function write() returns zero if the output was written, or 
+  non-zero if not. The slots are aligned as the memory of malloc().
+
+  It returns zero if the writer was started or one (and prints an error
+  message) if it wasn't, in which case nothing is left allocated and 
+  stopFITSWriter() is not called.
+
+  @param *w a pointer to the writer
+  @param Nslots an int with the number of slots
+  @param slotSize a size_t with the size of each slot (in bytes)
+  @param *write a pointer to the function that writes the output in a slot
+  @param background an int with a flag for writing in a separate thread
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning With background set, CFITSIO needs to be built with 
+  --enable-reentrant (see fits_is_reentrant()), since the files are 
+  written while the calling thread reads other files
+  
+  \todo nothing left
+
+*/
+int startFITSWriter(fitsWriter *w, int Nslots, size_t slotSize, int (*write)(void *slot), int background)
+{
+  int iSlot;                              // dummy index for counting slots
+
+  w->Nslots=Nslots;
+  w->write=write;
+  w->background=background;
+  w->first=0;
+  w->Nqueued=0;
+  w->Nfailed=0;
+  w->stop=0;
+  w->Nfree=0;
+
+  w->slots=(void **)malloc(sizeof(void *)*Nslots);
+  w->freeSlots=(void **)malloc(sizeof(void *)*Nslots);
+  w->queue=(void **)malloc(sizeof(void *)*Nslots);
+  if (w->slots==NULL || w->freeSlots==NULL || w->queue==NULL)
+    {
+      printErrorIO("malloc failed!\n");
+      goto cleanup;
+    }
+  for (iSlot=0;iSlot<Nslots;iSlot++)
+    {
+      w->slots[iSlot]=malloc(slotSize);
+      if (w->slots[iSlot]==NULL)
+	{
+	  printErrorIO("malloc failed!\n");
+	  goto cleanup;
+	}
+      w->freeSlots[w->Nfree++]=w->slots[iSlot];
+    }
+
+  pthread_mutex_init(&w->lock,NULL);
+  pthread_cond_init(&w->queued,NULL);
+  pthread_cond_init(&w->freed,NULL);
+  if (background && pthread_create(&w->thread,NULL,writeFITSThread,w)!=0)
+    {
+      printErrorIO("could not start the writing of the outputs in the background\n");
+      w->background=0;
+    }
+
+  return 0;
+
+ cleanup:
+  // a writer that could not be started holds nothing, and is not stopped
+  for (iSlot=0;iSlot<w->Nfree;iSlot++)
+    free(w->freeSlots[iSlot]);
+  free(w->slots);
+  free(w->freeSlots);
+  free(w->queue);
+  w->slots=w->freeSlots=w->queue=NULL;
+  w->Nfree=0;
+
+  return 1;
+}
+
+/*!
+  \brief 
+  Takes a free slot of a writer, waiting until one is written if needed
+
+  \details
+  It returns a pointer to the slot.
+
+  @param *w a pointer to the writer started with startFITSWriter()
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+void *getFITSWriterSlot(fitsWriter *w)
+{
+  void *slot;                             // the free slot
+
+  pthread_mutex_lock(&w->lock);
+  while (w->Nfree==0)
+    pthread_cond_wait(&w->freed,&w->lock);
+  slot=w->freeSlots[--w->Nfree];
+  pthread_mutex_unlock(&w->lock);
+
+  return slot;
+}
+
+/*!
+  \brief 
+  Queues a slot of a writer to be written
+
+  \details
+  The slot is written with the write function of the writer, in the 
+  background or right away (see startFITSWriter()), and then returned to
+  the free slots. A slot that was taken with getFITSWriterSlot() but is 
+  not to be written is returned with releaseFITSWriterSlot().
+
+  @param *w a pointer to the writer started with startFITSWriter()
+  @param *slot a pointer to a slot taken with getFITSWriterSlot()
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+void queueFITSWrite(fitsWriter *w, void *slot)
+{
+  int writeflag;                          // flag for the result of writing
+
+  if (!w->background)
+    {
+      writeflag=w->write(slot);
+      pthread_mutex_lock(&w->lock);
+      if (writeflag!=0)
+	w->Nfailed++;
+      w->freeSlots[w->Nfree++]=slot;
+      pthread_mutex_unlock(&w->lock);
+      return;
+    }
+
+  pthread_mutex_lock(&w->lock);
+  w->queue[(w->first+w->Nqueued)%w->Nslots]=slot;
+  w->Nqueued++;
+  pthread_cond_signal(&w->queued);
+  pthread_mutex_unlock(&w->lock);
+
+  return;
+}
+
+/*!
+  \brief 
+  Returns a slot of a writer to the free slots without writing it
+
+  @param *w a pointer to the writer started with startFITSWriter()
+  @param *slot a pointer to a slot taken with getFITSWriterSlot()
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+void releaseFITSWriterSlot(fitsWriter *w, void *slot)
+{
+  pthread_mutex_lock(&w->lock);
+  w->freeSlots[w->Nfree++]=slot;
+  pthread_cond_signal(&w->freed);
+  pthread_mutex_unlock(&w->lock);
+
+  return;
+}
+
+/*!
+  \brief 
+  Writes all the queued slots of a writer and stops it
+
+  \details
+  Waits until the thread of the writer has written all the queued slots,
+  stops it, and frees the slots.
+
+  It returns the number of outputs that could not be written.
+
+  @param *w a pointer to the writer started with startFITSWriter()
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int stopFITSWriter(fitsWriter *w)
+{
+  int iSlot;                              // dummy index for counting slots
+
+  if (w->background)
+    {
+      pthread_mutex_lock(&w->lock);
+      w->stop=1;
+      pthread_cond_signal(&w->queued);
+      pthread_mutex_unlock(&w->lock);
+      pthread_join(w->thread,NULL);
+    }
+  pthread_mutex_destroy(&w->lock);
+  pthread_cond_destroy(&w->queued);
+  pthread_cond_destroy(&w->freed);
+
+  for (iSlot=0;iSlot<w->Nslots;iSlot++)
+    free(w->slots[iSlot]);
+  free(w->slots);
+  free(w->freeSlots);
+  free(w->queue);
+
+  return w->Nfailed;
+}
+
+/*!
+  \brief 
+  Reads the metadata of a FITS file for a catalog
+
+  \details
+  Opens the FITS file 'fname' and reads, from its primary HDU, the sizes
+  of the image (BITPIX, NAXIS, and the first FITSINDEXAXES axes), the 
+  axes of type TIME and STOKES (see readFITSAxisType()), and the keywords
+  CDELT1, CDELT2, OBJECT, FREQ, and MJD (or MJD-OBS), and the number and 
+  the types (IMAGE_HDU, ASCII_TBL, or BINARY_TBL) of all its HDUs. The 
+  value of OBJECT is returned in object[], which needs to have at least
+  FLEN_VALUE characters; the offsets of the strings and the size and the
+  time of the file (see setFITSIndexStat()) are set by the caller.
+
+  The CFITSIO status of opening the file and reading the sizes of the
+  image and the keywords CDELT1 and CDELT2 is stored in the entry, so 
+  that an entry with a non-zero status is read as by readFITSImagedim()
+  and reports the same error. The other keywords are optional. It does 
+  not print any error messages, so that it can be called on more than 
+  one thread (if CFITSIO is reentrant).
+
+  @param fname[] a string with the filename to be read
+  @param *entry on return, a pointer to the metadata of the file
+  @param object[] on return, a string with the value of OBJECT (empty if missing)
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+  \return Returns zero if everything was OK or the FITS error code if it wasn't
+
+*/
+int readFITSIndexEntry(char fname[], fitsIndexEntry *entry, char object[])
+{
+  fitsfile *fptr;                      // FITS file pointer, defined in fitsio.h
+  int status = 0;                      // CFITSIO status value MUST be initialized to zero! 
+  int keyStatus;                       // CFITSIO status of the optional keywords and of the HDUs
+  int bitpix;                          // data type for pixel values
+  int naxis;                           // number of axes
+  long naxes[FITSINDEXAXES];           // dimension of each axis
+  int axis;                            // dummy index for counting axes
+  int hdu;                             // dummy index for counting HDUs
+  int hduType;                         // type of an HDU
+  char value[FLEN_VALUE],comment[FLEN_COMMENT]; // strings for reading keywords from FITS file
+  char *ptr;                           // pointer used for converting strings to numbers
+
+  entry->status=0;
+  entry->bitpix=0;
+  entry->naxis=0;
+  for (axis=0;axis<FITSINDEXAXES;axis++)
+    {
+      naxes[axis]=1;
+      entry->naxes[axis]=1;
+    }
+  entry->timeAxis=2;
+  entry->stokesAxis=2;
+  entry->Nhdu=0;
+  entry->hduTypes=0;
+  entry->unused=0;
+  entry->xScale=0.0;
+  entry->yScale=0.0;
+  entry->freq=NAN;
+  entry->mjd=NAN;
+  object[0]='\0';
+
+  // the errors are kept in the entry, not on the stack of CFITSIO messages
+  fits_write_errmark();
+  
+  // open file as READONLY
+  if (fits_open_file(&fptr, fname, READONLY, &status))
+    {
+      fits_clear_errmark();
+      entry->status=status;
+      return status;
+    }
+
+  // the sizes of the primary image, as in readFITSImagedim() and readFITSCubedim()
+  if (!fits_get_img_param(fptr, FITSINDEXAXES, &bitpix, &naxis, naxes, &status))
+    {
+      entry->bitpix=bitpix;
+      entry->naxis=naxis;
+      for (axis=0;axis<FITSINDEXAXES;axis++)
+	entry->naxes[axis]=naxes[axis];
+      if (naxis>2)
+	{
+	  entry->timeAxis=readFITSAxisType(fptr,(naxis<FITSINDEXAXES ? naxis : FITSINDEXAXES),"TIME",&status);
+	  entry->stokesAxis=readFITSAxisType(fptr,(naxis<FITSINDEXAXES ? naxis : FITSINDEXAXES),"STOKES",&status);
+	}
+    }
+  if (!fits_read_key_str(fptr, "CDELT1", value, comment, &status))
+    entry->xScale=strtod(value, &ptr);
+  if (!fits_read_key_str(fptr, "CDELT2", value, comment, &status))
+    entry->yScale=strtod(value, &ptr);
+  entry->status=status;
+
+  // the optional keywords
+  keyStatus=0;
+  if (fits_read_key(fptr, TSTRING, "OBJECT", object, comment, &keyStatus))
+    object[0]='\0';
+  keyStatus=0;
+  if (fits_read_key(fptr, TDOUBLE, "FREQ", &entry->freq, comment, &keyStatus))
+    entry->freq=NAN;
+  keyStatus=0;
+  if (fits_read_key(fptr, TDOUBLE, "MJD", &entry->mjd, comment, &keyStatus))
+    {
+      keyStatus=0;
+      if (fits_read_key(fptr, TDOUBLE, "MJD-OBS", &entry->mjd, comment, &keyStatus))
+	entry->mjd=NAN;
+    }
+
+  // the structure of the file, until the end of the last HDU (or an error)
+  keyStatus=0;
+  for (hdu=1;fits_movabs_hdu(fptr, hdu, &hduType, &keyStatus)==0;hdu++)
+    if (hdu<=FITSINDEXHDUS)
+      entry->hduTypes|=(uint32_t)(hduType&3)<<(2*(hdu-1));
+  entry->Nhdu=hdu-1;
+
+  keyStatus=0;
+  fits_close_file(fptr, &keyStatus);
+  fits_clear_errmark();
+
+  return entry->status;
+}
+
+/*!
+  \brief 
+  Sets the size and the time of the last modification of a file in its catalog entry
+
+  @param *entry a pointer to the metadata of the file
+  @param *st a pointer to the information on the file returned by stat()
+
+  \version 1.0
 
-      // create a FITS image configuration for the Visibility Amplitude
-      fits_create_img(fptr,DOUBLE_IMG,2,naxes, &status);
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
 
-      // Write the Visibility Amplitudes
-      int writeflag=fits_write_pix(fptr, TDOUBLE, fpixel,Nx*Ny, Va, &status);
+  \return nothing
 
-      // write the scale along the u-orientation
-      strcpy(keyname,"CDELT1");
-      writeflag+=fits_write_key_dbl(fptr,keyname,uScale,6, "in wavelengths",&status);
-      // write the scale along the u-orientation
-      strcpy(keyname,"CDELT2");
-      writeflag+=fits_write_key_dbl(fptr,keyname,vScale,6, "in wavelengths",&status);
-      
-      // delete two standard comments
-      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
-      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+*/
+void setFITSIndexStat(fitsIndexEntry *entry, struct stat *st)
+{
+  entry->size=st->st_size;
+#ifdef __APPLE__
+  entry->mtime=(int64_t)st->st_mtimespec.tv_sec*1000000000+st->st_mtimespec.tv_nsec;
+#else
+  entry->mtime=(int64_t)st->st_mtim.tv_sec*1000000000+st->st_mtim.tv_nsec;
+#endif
 
-      // add three new comments, showing that it's the amplitudes, the history, and the date
-      writeflag+=fits_write_comment(fptr, "Visibility Amplitudes", &status);
-      writeflag+=fits_write_history(fptr, hist, &status);
-      writeflag+=fits_write_date(fptr, &status);
+  return;
+}
 
-      // create a FITS image configuration for the Visibility Phases
-      fits_create_img(fptr,DOUBLE_IMG,2,naxes, &status);
+/*!
+  \brief 
+  Checks whether the catalog entry of a file is up to date
 
-      // write the visibility phases
-      writeflag+=fits_write_pix(fptr, TDOUBLE, fpixel,Nx*Ny, Vp, &status);
+  \details
+  The entry is up to date if the file has the same size and time of 
+  last modification as when it was read into the catalog. This needs
+  a stat() of the file, which is much faster than opening it and 
+  parsing its header.
 
-      // write a new comment that this is about the phases
-      writeflag+=fits_write_comment(fptr, "Visibility Phases", &status);
+  @param *entry a pointer to the metadata of the file in the catalog
+  @param fname[] a string with the filename
 
-      // if any of these failed, writeflag will be non zero
-      if (writeflag!=0)
-	{
-	  printErrorIO("writing output file failed!\n");   // print error message
-	  return 1;                                     // return with error code
-	}
-      
-      // close the output file
-      fits_close_file(fptr, &status);   // close image file for now
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+  \return Returns one if the entry is up to date and zero if it isn't (or the file does not exist)
+
+*/
+int isFITSIndexCurrent(fitsIndexEntry *entry, char fname[])
+{
+  struct stat st;                         // information on the file
+  fitsIndexEntry current;                 // size and time of the file now
+
+  if (stat(fname,&st)!=0)
+    return 0;
+  setFITSIndexStat(&current,&st);
+
+  return (current.size==entry->size && current.mtime==entry->mtime);
+}
+
+/*!
+  \brief 
+  Gets the image dimensions of a FITS file from its catalog entry
+
+  \details
+  Returns the same sizes as readFITSImagedim() (if ctype is NULL) or
+  readFITSCubedim() (with the type ctype of the axis of the planes, 
+  'TIME' or 'STOKES'), without opening the file. If the file could not 
+  be read into the catalog, or if its image does not have the number 
+  of axes that these subroutines need, it returns one and the caller 
+  reads the file as usual, which reports the error.
+
+  @param *entry a pointer to the metadata of the file in the catalog
+  @param ctype[] a string with the type of the axis of the planes, or NULL for a 2D image
+  @param *Ny on return, an int pointer with the dimension of the "y-axis" (# of rows)
+  @param *Nx on return, an int pointer with the dimension of the "x-axis" (# of columns)
+  @param *Nplanes on return, an int pointer with the number of planes along the axis of type ctype (not used if ctype is NULL)
+  @param *yScale on return, a double pointer with the physical size of a pixel along the y-axis 
+  @param *xScale on return, a double pointer with the physical size of a pixel along the x-axis
 
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+  \return Returns zero if the sizes were found in the entry and one if they weren't
+
+*/
+int readFITSIndexDims(fitsIndexEntry *entry, char ctype[], int *Ny, int *Nx, int *Nplanes,
+		      double *yScale, double *xScale)
+{
+  if (entry->status!=0)
+    return 1;
+
+  if (ctype==NULL)
+    {
+      if (entry->naxis!=2)
+	return 1;
     }
   else
     {
-      printErrorIO("writing output file failed! Perhaps output file already exists\n");   // print error message
-      return 1;                                     // return with error code
+      if (entry->naxis<2 || entry->naxis>4)
+	return 1;
+      if (strcmp(ctype,"TIME")==0)
+	*Nplanes=entry->naxes[entry->timeAxis];
+      else if (strcmp(ctype,"STOKES")==0)
+	*Nplanes=entry->naxes[entry->stokesAxis];
+      else
+	return 1;
     }
 
-  // print any error message
-  if (status) fits_report_error(stderr, status); 
-  
-  return(status);
+  *Nx=entry->naxes[0];      // naxes[0] are C-like columns
+  *Ny=entry->naxes[1];
+  *xScale=entry->xScale;
+  *yScale=entry->yScale;
+
+  return 0;
 }
 
 /*!
   \brief 
-  Writes a model image into a FITS file
+  Initializes an empty catalog of FITS files
 
   \details
-  Given the double array Image of dimensions Npixel by Npixel, it stores
-  it in the FITS file 'fname'
+  The strings of the catalog start with an empty string, so that the 
+  offset zero is a missing value (e.g., of OBJECT). The entries are 
+  allocated by the caller.
 
-  It returns zero if everything was OK or the FITS error code (and prints
-  an error message) if it wasn't.
+  @param *index a pointer to the catalog
 
-  @param fname[] a string with the filename to be read
-  @param Npixel an int with the number of pixels along each axis
-  @param pixelSize a double with the physical size of each pixel
-  @param Image[] a Npixel by Npixel double array with the image
-  @param hist[] a string of characters to be put in the "history" field of the FITS file
+  \version 1.0
 
-  \author Dimitrios Psaltis
+  \bug No known bugs
   
-  \version 1.0
+  \warning No known warnings
   
-  \date November 3, 2017
+  \todo nothing left
+
+  \return Returns zero if successful, 1 if not
+
+*/
+int initFITSIndex(fitsIndex *index)
+{
+  index->Nentries=0;
+  index->entries=NULL;
+  index->stringSize=1;
+  index->stringCapacity=1;
+  index->strings=(char *)malloc(1);
+  if (index->strings==NULL)
+    {
+      printErrorIO("malloc failed!\n");
+      return 1;
+    }
+  index->strings[0]='\0';
+
+  return 0;
+}
+
+/*!
+  \brief 
+  Adds a string to the strings of a catalog of FITS files
+
+  @param *index a pointer to the catalog
+  @param string[] the string to be added
+  @param *offset on return, the offset of the string in the strings of the catalog
+
+  \version 1.0
 
   \bug No known bugs
   
@@ -561,66 +3452,277 @@ int writeFITSVis(char fname[], int Ny, int Nx, double *Vp, double *Va, double vS
   
   \todo nothing left
 
+  \return Returns zero if successful, 1 if not
+
 */
-int writeFITSImage(char fname[], int Npixel, double pixelSize, double *Image, char hist[])
+int addFITSIndexString(fitsIndex *index, char string[], uint32_t *offset)
 {
-  fitsfile *fptr;   // FITS file pointer, defined in fitsio.h
-  int status = 0;   // CFITSIO status value MUST be initialized to zero! 
-  long naxes[2] = {1,1};   // dimension of each axis
-  long fpixel[2] = {1,1};  // pixel counter
-  char keyname[80],comment[80]; // strings for writing keywords to the FITS file
-  int writeflag;    // flag for return values of FITS commands
+  size_t length=strlen(string)+1;         // size of the string with its '\0'
+  size_t capacity;                        // new size of the memory for the strings
+  char *strings;                          // the enlarged strings
 
-  // set axes dimensions from input parameters
-  naxes[0]=Npixel;
-  naxes[1]=Npixel;
+  if (index->stringSize+length>UINT32_MAX)
+    {
+      printErrorIO("too many filenames for a catalog\n");
+      return 1;
+    }
 
-  // open file
-  if (!fits_create_file(&fptr, fname, &status))
+  if (index->stringSize+length>index->stringCapacity)
     {
+      for (capacity=2*index->stringCapacity;capacity<index->stringSize+length;capacity*=2)
+	;
+      strings=(char *)realloc(index->strings,capacity);
+      if (strings==NULL)
+	{
+	  printErrorIO("malloc failed!\n");
+	  return 1;
+	}
+      index->strings=strings;
+      index->stringCapacity=capacity;
+    }
 
-      // create a FITS image configuration for the Image
-      fits_create_img(fptr,DOUBLE_IMG,2,naxes, &status);
+  memcpy(index->strings+index->stringSize,string,length);
+  *offset=index->stringSize;
+  index->stringSize+=length;
 
-      // Write the Image
-      int writeflag=fits_write_pix(fptr, TDOUBLE, fpixel,Npixel*Npixel, Image, &status);
+  return 0;
+}
 
-      // write the scale along the x-orientation
-      strcpy(keyname,"CDELT1");
-      writeflag+=fits_write_key_dbl(fptr,keyname,pixelSize,6, "in degrees",&status);
-      // write the scale along the y-orientation
-      strcpy(keyname,"CDELT2");
-      writeflag+=fits_write_key_dbl(fptr,keyname,pixelSize,6, "in degrees",&status);
-      
-      // delete two standard comments
-      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
-      writeflag+=fits_delete_key(fptr, "COMMENT", &status);
+/*!
+  \brief 
+  Reads a catalog of FITS files
 
-      // add two new comments, showing the history, and the date
-      writeflag+=fits_write_history(fptr, hist, &status);
-      writeflag+=fits_write_date(fptr, &status);
+  \details
+  The catalog is written by writeFITSIndex(), e.g., with achieve-index,
+  and is read with one read of its entries and one of its strings. A 
+  catalog that was written on a machine with a different byte order or
+  by a different version of this file is not read.
 
-      // if any of these failed, writeflag will be non zero
-      if (writeflag!=0)
+  It returns zero if everything was OK or one (and prints an error 
+  message) if it wasn't.
+
+  @param fname[] a string with the filename of the catalog
+  @param *index on return, a pointer to the catalog, to be freed with freeFITSIndex()
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int readFITSIndex(char fname[], fitsIndex *index)
+{
+  FILE *fp;                               // pointer to the catalog file
+  fitsIndexHeader header;                 // header of the catalog
+  int iEntry;                             // dummy index for counting entries
+  int status=0;                           // flag for errors
+
+  index->entries=NULL;
+  index->strings=NULL;
+  
+  fp=fopen(fname,"rb");
+  if (fp==NULL)
+    {
+      printErrorIO("could not open the catalog\n");
+      return 1;
+    }
+
+  if (fread(&header,sizeof(header),1,fp)!=1 || memcmp(header.magic,FITSINDEXMAGIC,8)!=0 ||
+      header.order!=FITSINDEXORDER || header.entrySize!=sizeof(fitsIndexEntry) ||
+      header.Nentries<0 || header.stringSize<1 || header.stringSize>UINT32_MAX)
+    {
+      printErrorIO("not a catalog of FITS files, or written on a different machine\n");
+      fclose(fp);
+      return 1;
+    }
+
+  index->Nentries=header.Nentries;
+  index->stringSize=header.stringSize;
+  index->stringCapacity=header.stringSize;
+  index->entries=(fitsIndexEntry *)malloc(sizeof(fitsIndexEntry)*(header.Nentries>0 ? header.Nentries : 1));
+  index->strings=(char *)malloc(header.stringSize);
+  if (index->entries==NULL || index->strings==NULL)
+    {
+      printErrorIO("malloc failed!\n");
+      status=1;
+    }
+  else if (fread(index->entries,sizeof(fitsIndexEntry),header.Nentries,fp)!=(size_t)header.Nentries ||
+	   fread(index->strings,1,header.stringSize,fp)!=header.stringSize ||
+	   index->strings[0]!='\0' || index->strings[header.stringSize-1]!='\0')
+    {
+      printErrorIO("the catalog is truncated\n");
+      status=1;
+    }
+  else
+    for (iEntry=0;iEntry<index->Nentries;iEntry++)
+      if (index->entries[iEntry].name>=header.stringSize || index->entries[iEntry].object>=header.stringSize ||
+	  index->entries[iEntry].timeAxis<0 || index->entries[iEntry].timeAxis>=FITSINDEXAXES ||
+	  index->entries[iEntry].stokesAxis<0 || index->entries[iEntry].stokesAxis>=FITSINDEXAXES)
 	{
-	  printErrorIO("writing output file failed!\n");   // print error message
-	  return 1;                                     // return with error code
+	  printErrorIO("the catalog is corrupted\n");
+	  status=1;
+	  break;
 	}
-      
-      // close the output file
-      fits_close_file(fptr, &status);   // close image file for now
+  fclose(fp);
+
+  if (status!=0)
+    freeFITSIndex(index);
+
+  return status;
+}
+
+/*!
+  \brief 
+  Writes a catalog of FITS files
+
+  \details
+  The catalog file has a header (fitsIndexHeader), the entries, sorted 
+  by filename, and the strings, in the byte order of the machine. It is 
+  written to a temporary file ('fname.tmp') that is then renamed to 
+  'fname', so that a program that reads the catalog while it is updated 
+  finds either the old or the new catalog.
+
+  It returns zero if everything was OK or one (and prints an error 
+  message) if it wasn't.
+
+  @param fname[] a string with the filename of the catalog
+  @param *index a pointer to the catalog, with its entries sorted by filename
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+*/
+int writeFITSIndex(char fname[], fitsIndex *index)
+{
+  FILE *fp;                               // pointer to the catalog file
+  fitsIndexHeader header;                 // header of the catalog
+  char *tmpName;                          // name of the temporary file
+  int status=0;                           // flag for errors
 
+  tmpName=(char *)malloc(strlen(fname)+5);
+  if (tmpName==NULL)
+    {
+      printErrorIO("malloc failed!\n");
+      return 1;
     }
-  else
+  sprintf(tmpName,"%s.tmp",fname);
+
+  memset(&header,0,sizeof(header));
+  memcpy(header.magic,FITSINDEXMAGIC,8);
+  header.order=FITSINDEXORDER;
+  header.entrySize=sizeof(fitsIndexEntry);
+  header.Nentries=index->Nentries;
+  header.stringSize=index->stringSize;
+
+  fp=fopen(tmpName,"wb");
+  if (fp==NULL)
     {
-      printErrorIO("writing output file failed! Perhaps output file already exists\n");   // print error message
-      return 1;                                     // return with error code
+      printErrorIO("could not create the catalog\n");
+      free(tmpName);
+      return 1;
     }
+  if (fwrite(&header,sizeof(header),1,fp)!=1 ||
+      fwrite(index->entries,sizeof(fitsIndexEntry),index->Nentries,fp)!=(size_t)index->Nentries ||
+      fwrite(index->strings,1,index->stringSize,fp)!=index->stringSize)
+    status=1;
+  if (fclose(fp)!=0)
+    status=1;
+
+  if (status==0 && rename(tmpName,fname)!=0)
+    status=1;
+  if (status!=0)
+    {
+      printErrorIO("writing the catalog failed!\n");
+      unlink(tmpName);
+    }
+  free(tmpName);
 
-  // print any error message
-  if (status) fits_report_error(stderr, status); 
+  return status;
+}
+
+/*!
+  \brief 
+  Finds a file in a catalog of FITS files
+
+  \details
+  The filename needs to be the same as in the catalog (e.g., as listed
+  by achieve-index -l); the entries are searched by bisection.
+
+  @param *index a pointer to the catalog, or NULL
+  @param fname[] a string with the filename
+
+  \version 1.0
+
+  \bug No known bugs
   
-  return(status);
+  \warning No known warnings
+  
+  \todo nothing left
+
+  \return Returns a pointer to the entry of the file, or NULL if it is not in the catalog
+
+*/
+fitsIndexEntry *findFITSIndexEntry(fitsIndex *index, char fname[])
+{
+  int low,high,mid;                       // limits and middle of the bisection
+  int cmp;                                // result of the comparison of the filenames
+
+  if (index==NULL)
+    return NULL;
+
+  low=0;
+  high=index->Nentries-1;
+  while (low<=high)
+    {
+      mid=low+(high-low)/2;
+      cmp=strcmp(index->strings+index->entries[mid].name,fname);
+      if (cmp==0)
+	return index->entries+mid;
+      if (cmp<0)
+	low=mid+1;
+      else
+	high=mid-1;
+    }
+
+  return NULL;
+}
+
+/*!
+  \brief 
+  Frees the memory of a catalog of FITS files
+
+  @param *index a pointer to the catalog
+
+  \version 1.0
+
+  \bug No known bugs
+  
+  \warning No known warnings
+  
+  \todo nothing left
+
+  \return nothing
+
+*/
+void freeFITSIndex(fitsIndex *index)
+{
+  free(index->entries);
+  free(index->strings);
+  index->entries=NULL;
+  index->strings=NULL;
+  index->Nentries=0;
+  index->stringSize=0;
+  index->stringCapacity=0;
+
+  return;
 }
 
 /*!
@@ -632,9 +3734,11 @@ int writeFITSImage(char fname[], int Npixel, double pixelSize, double *Image, ch
   element and converts it to an incremental pointer location. The 
   i- and j- coordinates start from (1,1) for the first point
 
+  The location is a long, so that it does not overflow for arrays
+  with more than 2^31 elements
+
   @param i an int with the row coordinate of an element
   @param j an int with the column coordinate of an element
-  @param Ny an int with the number of rows in the image (not used)
   @param Nx an int with the number of columns in the image
 
   \author Dimitrios Psaltis
@@ -650,9 +3754,9 @@ int writeFITSImage(char fname[], int Npixel, double pixelSize, double *Image, ch
   \todo nothing left
 
 */
-int indexArr(int i, int j, int Ny, int Nx)
+long indexArr(int i, int j, int Nx)
 {
-  return (i-1)*Nx+j-1;
+  return (long)(i-1)*Nx+j-1;
 }
 
 /*!
@@ -744,7 +3848,7 @@ int main(void)
     {
       for (j=1;j<=Ny;j++)
 	{
-	  printf("%d %d %e\n",i,j,*(ImageIn+indexArr(i,j,Nx,Ny)));
+	  printf("%d %d %e\n",i,j,*(ImageIn+indexArr(i,j,Ny)));
 	}
     }
   
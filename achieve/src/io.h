@@ -0,0 +1,189 @@
+/*! \file
+  \brief
+  Declarations for the FITS I/O subroutines in io.c
+
+  \details
+  The subroutines that return sizes or locations in arrays (such as
+  indexArr()) return longs, so that the callers need the declarations
+  here to use arrays with more than 2^31 elements
+
+  \version 1.0
+
+*/
+#ifndef IO_H
+#define IO_H
+
+#include<pthread.h>
+#include<stdint.h>
+#include<sys/stat.h>
+#include "fitsio.h"
+
+#define QUANTLEVEL 16.0         //!< default quantization level of the lossy compression of images
+#define PREFETCHQUEUE 256       //!< maximum number of files in the queue of a prefetcher
+#define FITSINDEXMAGIC "ACHVIDX1"  //!< first bytes of a catalog of FITS files (see writeFITSIndex()), with its version
+#define FITSINDEXAXES 4         //!< number of axes of the primary image that are kept in a catalog
+#define FITSINDEXHDUS 16        //!< number of HDUs whose types are kept in a catalog
+#define FITSINDEXORDER 0x01020304 //!< number that marks the byte order of a catalog
+
+/*! \brief The tiled compression of the output images (see parseFITSCompression()) */
+typedef struct {
+  int type;               //!< compression algorithm (0 for none, RICE_1, GZIP_2, or HCOMPRESS_1)
+  float quantize;         //!< quantization level of the images (0 for lossless)
+  float quantizePhase;    //!< quantization level of the images of phases (0 for lossless)
+} fitsCompression;
+
+/*! \brief A thread that prefetches input files (see startFITSPrefetch()) */
+typedef struct {
+  pthread_t thread;             //!< the prefetching thread
+  pthread_mutex_t lock;         //!< lock of the queue
+  pthread_cond_t cond;          //!< signals a new file in the queue, or the end
+  char *names[PREFETCHQUEUE];   //!< the queue of the filenames (a ring)
+  int first;                    //!< position of the first file in the queue
+  int count;                    //!< number of files in the queue
+  int stop;                     //!< flag for stopping the thread
+} fitsPrefetch;
+
+/*! \brief A bounded queue of outputs that are written in the background (see startFITSWriter()) */
+typedef struct {
+  pthread_t thread;             //!< the writing thread
+  pthread_mutex_t lock;         //!< lock of the queue and of the free slots
+  pthread_cond_t queued;        //!< signals a new slot in the queue, or the end
+  pthread_cond_t freed;         //!< signals a slot that was written
+  int (*write)(void *slot);     //!< function that writes the output in a slot
+  int background;               //!< flag for writing on the thread
+  int Nslots;                   //!< number of slots
+  void **slots;                 //!< all the slots
+  void **freeSlots;             //!< the free slots (a stack)
+  int Nfree;                    //!< number of free slots
+  void **queue;                 //!< the slots that are queued for writing (a ring)
+  int first;                    //!< position of the first slot in the queue
+  int Nqueued;                  //!< number of slots in the queue
+  int Nfailed;                  //!< number of outputs that could not be written
+  int stop;                     //!< flag for stopping the thread
+} fitsWriter;
+
+/*! \brief The metadata of a FITS file in a catalog (see readFITSIndexEntry()) */
+typedef struct {
+  int64_t size;                 //!< size of the file (in bytes)
+  int64_t mtime;                //!< time of the last modification of the file (in ns since the Epoch)
+  uint32_t name;                //!< offset of the filename in the strings of the catalog
+  uint32_t object;              //!< offset of the keyword OBJECT in the strings of the catalog (0: missing)
+  int32_t status;               //!< CFITSIO status of reading the sizes of the primary image (0: no error)
+  int32_t bitpix;               //!< BITPIX of the primary image
+  int32_t naxis;                //!< number of axes of the primary image
+  int32_t naxes[FITSINDEXAXES]; //!< dimension of each axis of the primary image
+  int32_t timeAxis;             //!< axis of type TIME (see readFITSAxisType())
+  int32_t stokesAxis;           //!< axis of type STOKES
+  int32_t Nhdu;                 //!< number of HDUs
+  uint32_t hduTypes;            //!< types of the first FITSINDEXHDUS HDUs, two bits per HDU
+  int32_t unused;               //!< padding
+  double xScale,yScale;         //!< CDELT1 and CDELT2 (0 if missing)
+  double freq;                  //!< keyword FREQ (NAN if missing)
+  double mjd;                   //!< keyword MJD or MJD-OBS (NAN if missing)
+} fitsIndexEntry;
+
+/*! \brief The header of a catalog file, followed by the entries and the strings (see writeFITSIndex()) */
+typedef struct {
+  char magic[8];                //!< FITSINDEXMAGIC
+  int32_t order;                //!< FITSINDEXORDER, as written by the machine that wrote the catalog
+  int32_t entrySize;            //!< size of each entry (in bytes)
+  int32_t Nentries;             //!< number of entries
+  int32_t unused;               //!< padding
+  uint64_t stringSize;          //!< size of the strings (in bytes)
+} fitsIndexHeader;
+
+/*! \brief A catalog of the metadata of FITS files (see readFITSIndex()) */
+typedef struct {
+  int Nentries;                 //!< number of files
+  fitsIndexEntry *entries;      //!< metadata of the files, sorted by filename
+  char *strings;                //!< filenames and values of OBJECT, each ending with '\0'
+  size_t stringSize;            //!< size of the strings (in bytes)
+  size_t stringCapacity;        //!< size of the memory allocated for the strings (in bytes)
+} fitsIndex;
+
+void printErrorIO(char errmsg[]);
+
+int readFITSImagedim(char fname[], int *Ny, int *Nx, double *yScale, double *xScale);
+int readFITSImage(char fname[], int Ny, int Nx, int Npad, int datatype, void *Image);
+int readFITSImageRows(char fname[], int Ny, int Nx, int Npad, int firstRow, int Nrows, int arrayRow, int datatype,
+		      void *Image);
+int readFITSImageStrided(char fname[], int Ny, int Nx, int firstRow, int Nrows, int datatype, void *buf,
+			 long offset, long rowStride, int pixelStride);
+int openFITSImage(char fname[], fitsfile **fptr);
+int readFITSImagedimHandle(fitsfile *fptr, int *Ny, int *Nx, double *yScale, double *xScale);
+int readFITSImageRowsHandle(fitsfile *fptr, int Ny, int Nx, int Npad, int firstRow, int Nrows, int arrayRow,
+			    int datatype, void *Image);
+int readFITSImageStridedHandle(fitsfile *fptr, int Ny, int Nx, int firstRow, int Nrows, int datatype, void *buf,
+			       long offset, long rowStride, int pixelStride);
+int closeFITSImage(fitsfile *fptr);
+size_t sizeFITSType(int datatype);
+int readFITSImageNativeType(fitsfile *fptr, int *datatype);
+int mapFITSImage(fitsfile *fptr, int firstRow, int Nrows, int *bitpix, double *bscale, double *bzero,
+		 void **map, size_t *mapSize, char **data);
+int unmapFITSImage(void *map, size_t mapSize);
+int readFITSImageMapped(fitsfile *fptr, int Nx, int firstRow, int Nrows, int datatype, void *buf,
+			long offset, long rowStride, int pixelStride);
+int readFITSAxisType(fitsfile *fptr, int naxis, char ctype[], int *status);
+int readFITSCubedim(char fname[], int *Ny, int *Nx, char ctype[], int *Nplanes, double *yScale, double *xScale);
+int readFITSCube(char fname[], int Ny, int Nx, int Npad, char ctype[], int first, int Nplanes, int datatype, void *Image);
+
+int parseFITSCompression(char spec[], fitsCompression *comp);
+int createFITSImageHDU(fitsfile *fptr, int bitpix, int naxis, long *naxes, fitsCompression *comp, int isPhase,
+		       int *status);
+int isFITSPipe(char fname[]);
+int overwriteFITSName(char fname[], size_t size);
+int writeFITSVisHalfKeys(fitsfile *fptr, int Nx, int *status);
+int writeFITSVisOriginKeys(fitsfile *fptr, double *uvOrigin, int *status);
+int writeFITSVis(char fname[], int Ny, int Nx, void *Vp, void *Va, double vScale, double uScale, char hist[], int halfPlane,
+		 double *uvOrigin, int datatype, int bitpix, fitsCompression *comp);
+int writeFITSVisGridKeys(fitsfile *fptr, int Nx, double vScale, double uScale, int halfPlane,
+			 double *uvOrigin, int *status);
+int writeFITSVisComplex(char fname[], int Ny, int Nx, void *Vre, void *Vim, double vScale, double uScale, char hist[],
+			int halfPlane, double *uvOrigin, int datatype, int bitpix, fitsCompression *comp);
+int writeFITSVisAmp(char fname[], int Ny, int Nx, void *Va, double vScale, double uScale, char hist[],
+		    int halfPlane, double *uvOrigin, int power, int datatype, int bitpix, fitsCompression *comp);
+int writeFITSVisCube(char fname[], int Ny, int Nx, int Nhdu, void **Vre, void **Vim, char **extname, char **comment,
+		     double vScale, double uScale, char hist[], int halfPlane, double *uvOrigin, int datatype, int bitpix,
+		     fitsCompression *comp);
+int createFITSVisMovie(char fname[], int Ny, int Nx, int Nt, int Nhdu, int *isComplex, char **extname, char **comment,
+		       double vScale, double uScale, char hist[], int halfPlane, int bitpix, fitsfile **fptr);
+int writeFITSVisMovieFrame(fitsfile *fptr, int Ny, int Nx, int halfPlane, int iFrame,
+			   int Nhdu, void **Vre, void **Vim, int datatype);
+int writeFITSVisRows(fitsfile *fptr, int Ny, int Nx, int halfPlane, int iFrame, int firstRow, int Nrows,
+		     int Nhdu, void **Vre, void **Vim, int datatype);
+int writeFITSVisSubset(fitsfile *fptr, int iFrame, int firstRow, int Nrows, int firstCol, int Ncols,
+		       int Nhdu, void **Vre, void **Vim, int datatype);
+int openFITSVisMovie(char fname[], fitsfile **fptr);
+int closeFITSVisMovie(fitsfile *fptr);
+int writeFITSVisTable(char fname[], int Nb, double *u, double *v, double *Vre, double *Vim,
+		      double *Va, double *Vp, double *Vpow, char hist[]);
+int writeFITSImage(char fname[], int Ny, int Nx, double pixelSize, void *Image, char hist[], int datatype, int bitpix,
+		   fitsCompression *comp);
+
+void *prefetchFITSThread(void *arg);
+int startFITSPrefetch(fitsPrefetch *pf);
+void queueFITSPrefetch(fitsPrefetch *pf, char fname[]);
+void stopFITSPrefetch(fitsPrefetch *pf);
+void *writeFITSThread(void *arg);
+int startFITSWriter(fitsWriter *w, int Nslots, size_t slotSize, int (*write)(void *slot), int background);
+void *getFITSWriterSlot(fitsWriter *w);
+void queueFITSWrite(fitsWriter *w, void *slot);
+void releaseFITSWriterSlot(fitsWriter *w, void *slot);
+int stopFITSWriter(fitsWriter *w);
+
+int readFITSIndexEntry(char fname[], fitsIndexEntry *entry, char object[]);
+void setFITSIndexStat(fitsIndexEntry *entry, struct stat *st);
+int isFITSIndexCurrent(fitsIndexEntry *entry, char fname[]);
+int readFITSIndexDims(fitsIndexEntry *entry, char ctype[], int *Ny, int *Nx, int *Nplanes,
+		      double *yScale, double *xScale);
+int initFITSIndex(fitsIndex *index);
+int addFITSIndexString(fitsIndex *index, char string[], uint32_t *offset);
+int readFITSIndex(char fname[], fitsIndex *index);
+int writeFITSIndex(char fname[], fitsIndex *index);
+fitsIndexEntry *findFITSIndexEntry(fitsIndex *index, char fname[]);
+void freeFITSIndex(fitsIndex *index);
+
+long indexArr(int i, int j, int Nx);
+int ArrayPad(int Ny, int Nx, int Npad, int *iRowStart, int *iColStart, int *NyPad, int *NxPad);
+
+#endif
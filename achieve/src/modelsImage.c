@@ -3,6 +3,8 @@
 #include<stdlib.h>
 #include<unistd.h>
 #include<string.h>
+
+#include "io.h"
 /*! \file
   \brief 
   Analytic models for images.
@@ -330,8 +332,8 @@ int NModelParam(int modelNumber)
    Fills a double array with the brigtness of a multi-Gaussian analytic model
 
 \details 
-   Given a number of pixels Npixel, the physical size of each pixel pixelSize and an array of model 
-   parameters param[], it fills the Npixel*Npixel double array Image[] with the brightness of a multi
+   Given the numbers of pixels Ny and Nx, the physical size of each pixel pixelSize and an array of model 
+   parameters param[], it fills the Ny*Nx double array Image[] with the brightness of a multi
    Gaussian model.
 
    The functional form of the model is
@@ -363,7 +365,8 @@ int NModelParam(int modelNumber)
 
 \date November 14, 2017
 
-@param Npixel an int with the number of pixels per dimension of the image
+@param Ny an int with the number of rows of the image
+@param Nx an int with the number of columns of the image
 @param pixelSize a double with the physical size of the pixel
 @param param[] a double array with the parameters of the model
 @param *Image a pointer to a double array, which will be filled with the brightness of the
@@ -373,15 +376,16 @@ multi-Gaussian image.
    0 if everything was ok; for now, it always returns zero
 
 */
-int gaussModel(int Npixel, double pixelSize, double param[], double *Image)
+int gaussModel(int Ny, int Nx, double pixelSize, double param[], double *Image)
 {
   int index;                                     // counting index
   int ix,iy;                                     // counting indeces for the x- and y-directions
+  long ipixel;                                   // counting index for all the pixels
 
   // initialize the image
-  for (ix=1;ix<=Npixel*Npixel;ix++)
+  for (ipixel=0;ipixel<(long)Ny*Nx;ipixel++)
     {
-      *(Image+ix-1)=0.0;
+      *(Image+ipixel)=0.0;
     }
   
   // first parameter is the number of model components
@@ -407,20 +411,20 @@ int gaussModel(int Npixel, double pixelSize, double param[], double *Image)
       double sinth=sin(thi);
       double norm=F/(2.*M_PI*sxi*syi);
 	    
-      // now add the brightness of each component to the image
-      for (ix=1;ix<=Npixel;ix++)
+      // now add the brightness of each component to the image, one row at a time
+      for (iy=1;iy<=Ny;iy++)
 	{
-	  // calculate the x-location in physical units centered at the center of the image
-	  // note that the x-axis is increasing to the left (East is left)
-	  double x=-(ix-Npixel/2)*pixelSize;
-	  for (iy=1;iy<=Npixel;iy++)
+	  double y=(iy-Ny/2)*pixelSize;
+	  for (ix=1;ix<=Nx;ix++)
 	    {
-	      double y=(iy-Npixel/2)*pixelSize;
+	      // calculate the x-location in physical units centered at the center of the image
+	      // note that the x-axis is increasing to the left (East is left)
+	      double x=-(ix-Nx/2)*pixelSize;
 	      // calculate the coordinates in the frame rotated along the major and minor axes 
 	      double xp=(x-x0i)*sinth+(y-y0i)*costh;
 	      double yp=(x-x0i)*costh-(y-y0i)*sinth;
 	      // calculate the linear pointer location of this pixel
-	      int indexto=indexArr(iy,ix,Npixel,Npixel);
+	      long indexto=indexArr(iy,ix,Nx);
 	      *(Image+indexto)+=norm*exp(-invsx2*xp*xp-invsy2*yp*yp);
 	    }
 	}
@@ -436,8 +440,8 @@ int gaussModel(int Npixel, double pixelSize, double param[], double *Image)
    Fills a double array with the brigtness of an analytic crescent model.
 
 \details 
-   Given a number of pixels Npixel, the physical size of each pixel pixelSize and an array of model 
-   parameters param[], it fills the Npixel*Npixel double array Image[] with the brightness of the crescent
+   Given the numbers of pixels Ny and Nx, the physical size of each pixel pixelSize and an array of model 
+   parameters param[], it fills the Ny*Nx double array Image[] with the brightness of the crescent
    mode  of  
    <a href="http://adsabs.harvard.edu/abs/2013MNRAS.434..765K">Kmaruddin & Dexter</a>, 2013, MNRAS 414, 765.
 
@@ -482,7 +486,8 @@ int gaussModel(int Npixel, double pixelSize, double param[], double *Image)
 
 \date November 14, 2017
 
-@param Npixel an int with the number of pixels per dimension of the image
+@param Ny an int with the number of rows of the image
+@param Nx an int with the number of columns of the image
 @param pixelSize a double with the physical size of the pixel
 @param param[] a double array with the parameters of the model
 @param *Image a pointer to a double array, which will be filled with the brightness of the
@@ -492,16 +497,17 @@ multi-Gaussian image.
    0 if everything was ok; the number of components with invalid parameters, if there were any
 
 */
-int crescentModel(int Npixel, double pixelSize, double param[], double *Image)
+int crescentModel(int Ny, int Nx, double pixelSize, double param[], double *Image)
 {
   int index;                                     // counting index
   int ix,iy;                                     // counting indeces for the x- and y-directions
+  long ipixel;                                   // counting index for all the pixels
   int result=0;                                  // count number of problems with parameter values
 
   // initialize the image
-  for (ix=1;ix<=Npixel*Npixel;ix++)
+  for (ipixel=0;ipixel<(long)Ny*Nx;ipixel++)
     {
-      *(Image+ix-1)=0.0;
+      *(Image+ipixel)=0.0;
     }
   
   // first parameter is the number of model components
@@ -533,17 +539,17 @@ int crescentModel(int Npixel, double pixelSize, double param[], double *Image)
 	  double a=R*(1.0-tau)*psi*sin(phi);          // horizontal displacement of inner disk
 	  double b=R*(1.0-tau)*psi*cos(phi);          // vertical displacement of inner disk
 	  
-	  // now add the brightness of each component to the image
-	  for (ix=1;ix<=Npixel;ix++)
+	  // now add the brightness of each component to the image, one row at a time
+	  for (iy=1;iy<=Ny;iy++)
 	    {
-	      // calculate the x-location in physical units centered at the center of the image
-	      // note that the x-axis is increasing to the left (East is left)
-	      double x=-(ix-Npixel/2)*pixelSize;
-	      for (iy=1;iy<=Npixel;iy++)
+	      double y=(iy-Ny/2)*pixelSize;
+	      for (ix=1;ix<=Nx;ix++)
 		{
-		  double y=(iy-Npixel/2)*pixelSize;
+		  // calculate the x-location in physical units centered at the center of the image
+		  // note that the x-axis is increasing to the left (East is left)
+		  double x=-(ix-Nx/2)*pixelSize;
 		  // calculate the linear pointer location of this pixel
-		  int indexto=indexArr(iy,ix,Npixel,Npixel);
+		  long indexto=indexArr(iy,ix,Nx);
 
 		  double rout=sqrt((x-x0i)*(x-x0i)+(y-y0i)*(y-y0i));          // distance from center of outer disk
 		  double rin=sqrt((x-x0i-a)*(x-x0i-a)+(y-y0i-b)*(y-y0i-b));   // distance from center of inner disk
@@ -0,0 +1,341 @@
+#include<stdio.h>
+#include<math.h>
+#include<stdlib.h>
+#include<string.h>
+#include<fftw3.h>
+
+#include "nufft.h"
+/*! \file
+  \brief
+  Non-uniform FFT of images, for sampling visibilities at arbitrary (u,v) points
+
+  \details
+  Calculates the Fourier transform of an Ny by Nx image
+  \f[
+  F(\xi,\eta)=\sum_{r=0}^{N_y-1}\sum_{c=0}^{N_x-1} I_{r,c}
+      e^{-2\pi i\left[\xi (c-x_0)+\eta (r-y_0)\right]}
+  \f]
+  at an arbitrary list of points \f$(\xi,\eta)\f$, in cycles per pixel,
+  with the type-2 non-uniform FFT of
+  <a href="http://adsabs.harvard.edu/abs/2004SIAMR..46..443G">Greengard & Lee</a>,
+  2004, SIAM Review 46, 443.
+
+  The image is first divided by the Fourier transform of a gaussian
+  kernel (deconvolution) and zero-padded to a grid that is NUFFTOVERSAMPLE
+  times larger along each direction. Its FFT on this grid is then
+  convolved with the gaussian kernel at each of the requested points, using
+  the 2*Msp grid points closest to the point along each direction. With
+  Msp=NUFFTSPREAD=12 and an oversampling factor of 2, the relative error
+  is about 1e-12.
+
+  The cost is that of one FFT of the oversampled image plus (2 Msp)^2
+  operations per point, instead of one operation per pixel per point for
+  a direct Fourier transform, and it does not require the image to be
+  padded in order to sample the visibilities at a fine resolution.
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+
+#define RED "\x1B[31m"                   //!< color RED for error output
+#define RESETCOLOR "\x1B[0m"             //!< color to reset to normal
+
+/*!
+\brief Prints an error message
+
+\details
+
+\version 1.0
+
+@param errmsg[] a string with the error message to be printed
+
+\return nothing
+
+*/
+void printErrorNufft(char errmsg[])
+{
+  fprintf(stderr,RED "nufft: %s" RESETCOLOR,errmsg);
+
+  return;
+}
+
+/*!
+  \brief
+  Makes a plan for the non-uniform FFT of Ny by Nx images
+
+  \details
+  Allocates the oversampled grid and its FFT, calculates the widths of
+  the gaussian kernels and the deconvolution factors, and makes the FFTW
+  plan for the real-to-complex transform of the oversampled grid. The same
+  plan can be used for any number of images of the same size.
+
+  The widths of the kernels follow Greengard & Lee (2004),
+  \f$\tau=\pi M_{sp}/[N^2 R(R-1/2)]\f$, where R is the oversampling factor.
+
+  @param Ny an int with the number of rows of the image
+  @param Nx an int with the number of columns of the image
+  @param Msp an int with the number of grid points on each side of a sample used for interpolation
+  @param planFlags an unsigned int with the FFTW planning flags
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning Planning with FFTW_MEASURE or FFTW_PATIENT is done before any image is placed on the grid
+
+  \todo nothing left
+
+  \return Returns a pointer to the plan, or NULL if it could not be made
+
+*/
+nufftPlan *nufftPlanCreate(int Ny, int Nx, int Msp, unsigned planFlags)
+{
+  nufftPlan *plan;                                  // the new plan
+  int index;                                        // generic integer variable
+  int R=NUFFTOVERSAMPLE;                            // oversampling factor
+
+  plan=(nufftPlan *)malloc(sizeof(nufftPlan));
+  if (plan==NULL)
+    {
+      printErrorNufft("malloc failed!\n");
+      return NULL;
+    }
+
+  plan->Nx=Nx;
+  plan->Ny=Ny;
+  plan->Mx=R*Nx;
+  plan->My=R*Ny;
+  plan->Msp=Msp;
+  plan->taux=M_PI*Msp/((double)Nx*Nx*R*(R-0.5));
+  plan->tauy=M_PI*Msp/((double)Ny*Ny*R*(R-0.5));
+  plan->p=NULL;
+
+  plan->decx=(double *)malloc(sizeof(double)*Nx);
+  plan->decy=(double *)malloc(sizeof(double)*Ny);
+  plan->grid=(double *)fftw_malloc(sizeof(double)*plan->My*plan->Mx);
+  plan->Fgrid=(fftw_complex *)fftw_malloc(sizeof(fftw_complex)*plan->My*(plan->Mx/2+1));
+  if (plan->decx==NULL || plan->decy==NULL || plan->grid==NULL || plan->Fgrid==NULL)
+    {
+      printErrorNufft("malloc failed!\n");
+      nufftPlanDestroy(plan);
+      return NULL;
+    }
+
+  // deconvolution factors, i.e., the inverse of the Fourier transform of the
+  // gaussian kernel, sqrt(4 pi tau) exp(-tau j^2), with j counted from the
+  // center of the image
+  for (index=0;index<Nx;index++)
+    plan->decx[index]=exp(plan->taux*(index-Nx/2)*(index-Nx/2))/sqrt(4.*M_PI*plan->taux);
+  for (index=0;index<Ny;index++)
+    plan->decy[index]=exp(plan->tauy*(index-Ny/2)*(index-Ny/2))/sqrt(4.*M_PI*plan->tauy);
+
+  plan->p=fftw_plan_dft_r2c_2d(plan->My,plan->Mx,plan->grid,plan->Fgrid,planFlags);
+  if (plan->p==NULL)
+    {
+      printErrorNufft("FFTW planning failed!\n");
+      nufftPlanDestroy(plan);
+      return NULL;
+    }
+
+  return plan;
+}
+
+/*!
+  \brief
+  Calculates the Fourier transform of an image at a list of points
+
+  \details
+  Calculates the Fourier transform F(xi,eta) of the Ny by Nx image with
+  respect to the point (x0,y0) of the image (in pixels, starting from 0),
+  at the Nb points (xi,eta) (in cycles per pixel), using the non-uniform
+  FFT described at the top of this file.
+
+  The points are independent of each other and are shared among the
+  OpenMP threads.
+
+  It returns zero if everything was OK, 1 if it wasn't.
+
+  @param *plan a pointer to the plan made by nufftPlanCreate()
+  @param *Image a pointer to the Ny by Nx image
+  @param x0 a double with the x-coordinate of the phase center (in pixels, starting from 0)
+  @param y0 a double with the y-coordinate of the phase center (in pixels, starting from 0)
+  @param Nb an int with the number of points
+  @param *xi a pointer to the Nb coordinates of the points along the x-direction (in cycles per pixel)
+  @param *eta a pointer to the Nb coordinates of the points along the y-direction (in cycles per pixel)
+  @param *Vre on return, a pointer to the real parts of the transform at the points
+  @param *Vim on return, a pointer to the imaginary parts of the transform at the points
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+int nufftExecute(nufftPlan *plan, double *Image, double x0, double y0,
+		 int Nb, double *xi, double *eta, double *Vre, double *Vim)
+{
+  int Nx=plan->Nx, Ny=plan->Ny;                     // size of the image
+  int Mx=plan->Mx, My=plan->My;                     // size of the oversampled grid
+  int MxHalf=plan->Mx/2+1;                          // number of columns of the FFT of the grid
+  int Msp=plan->Msp;                                // half-width of the interpolation
+  int indexR,indexC;                                // dummy indices for counting rows and columns
+  int ib;                                           // dummy index for counting points
+  int kx,ky;                                        // dummy indices for the interpolation
+  int mx,my,mx0,my0;                                // grid points of the interpolation
+  long index;                                       // index of the element of the FFT of the grid
+  double *wx,*wy;                                   // weights of the interpolation along each direction
+  double omegax,omegay;                             // angular frequencies of a point
+  double delta;                                     // distance of a point from a grid point
+  double sumRe,sumIm,rowRe,rowIm;                   // sums for the interpolation
+  double re,im,shift;                               // components of the result and the phase shift
+  double norm;                                      // normalization of the interpolation
+  int failed=0;                                     // flag for a thread that could not allocate its weights
+
+  // place the deconvolved image on the oversampled grid, with its center
+  // at the origin of the grid (and the negative indices wrapped around)
+  memset(plan->grid,0,sizeof(double)*My*Mx);
+  for (indexR=0;indexR<Ny;indexR++)
+    {
+      my=(indexR-Ny/2+My)%My;
+      for (indexC=0;indexC<Nx;indexC++)
+	{
+	  mx=(indexC-Nx/2+Mx)%Mx;
+	  plan->grid[(long)my*Mx+mx]=Image[(long)indexR*Nx+indexC]*plan->decx[indexC]*plan->decy[indexR];
+	}
+    }
+
+  // FFT of the grid
+  fftw_execute(plan->p);
+
+  norm=(2.*M_PI/Mx)*(2.*M_PI/My);
+
+  // interpolate the FFT of the grid to each point with the gaussian kernel
+#pragma omp parallel private(wx,wy,ib,kx,ky,mx,my,mx0,my0,index,omegax,omegay,delta,sumRe,sumIm,rowRe,rowIm,re,im,shift)
+  {
+    wx=(double *)malloc(sizeof(double)*2*Msp);
+    wy=(double *)malloc(sizeof(double)*2*Msp);
+    if (wx==NULL || wy==NULL)
+      {
+#pragma omp atomic write
+	failed=1;
+      }
+
+    // every thread takes part in the loop, but one without weights does no work
+#pragma omp for schedule(static)
+    for (ib=0;ib<Nb;ib++)
+      {
+	if (wx==NULL || wy==NULL)
+	  continue;
+	omegax=2.*M_PI*xi[ib];
+	omegay=2.*M_PI*eta[ib];
+
+	// the closest grid points below the point
+	mx0=(int)floor(xi[ib]*Mx);
+	my0=(int)floor(eta[ib]*My);
+
+	// the weights of the 2 Msp closest grid points along each direction
+	for (kx=0;kx<2*Msp;kx++)
+	  {
+	    delta=omegax-2.*M_PI*(mx0+kx-Msp+1)/Mx;
+	    wx[kx]=exp(-delta*delta/(4.*plan->taux));
+	  }
+	for (ky=0;ky<2*Msp;ky++)
+	  {
+	    delta=omegay-2.*M_PI*(my0+ky-Msp+1)/My;
+	    wy[ky]=exp(-delta*delta/(4.*plan->tauy));
+	  }
+
+	sumRe=0.0;
+	sumIm=0.0;
+	for (ky=0;ky<2*Msp;ky++)
+	  {
+	    my=((my0+ky-Msp+1)%My+My)%My;
+	    rowRe=0.0;
+	    rowIm=0.0;
+	    for (kx=0;kx<2*Msp;kx++)
+	      {
+		mx=((mx0+kx-Msp+1)%Mx+Mx)%Mx;
+		if (mx<MxHalf)
+		  {
+		    index=(long)my*MxHalf+mx;
+		    rowRe+=wx[kx]*plan->Fgrid[index][0];
+		    rowIm+=wx[kx]*plan->Fgrid[index][1];
+		  }
+		else    // the r2c transform has only u>=0; use F(-u,-v)=F*(u,v)
+		  {
+		    index=(long)((My-my)%My)*MxHalf+Mx-mx;
+		    rowRe+=wx[kx]*plan->Fgrid[index][0];
+		    rowIm-=wx[kx]*plan->Fgrid[index][1];
+		  }
+	      }
+	    sumRe+=wy[ky]*rowRe;
+	    sumIm+=wy[ky]*rowIm;
+	  }
+	sumRe*=norm;
+	sumIm*=norm;
+
+	// the transform so far is with respect to the center (Nx/2,Ny/2) of the
+	// image; shift it to the point (x0,y0)
+	shift=-omegax*(Nx/2-x0)-omegay*(Ny/2-y0);
+	re=cos(shift);
+	im=sin(shift);
+	Vre[ib]=sumRe*re-sumIm*im;
+	Vim[ib]=sumRe*im+sumIm*re;
+      }
+
+    free(wx);
+    free(wy);
+  }
+
+  if (failed)
+    {
+      printErrorNufft("malloc failed!\n");
+      return 1;
+    }
+
+  return 0;
+}
+
+/*!
+  \brief
+  Destroys a plan for the non-uniform FFT and frees its memory
+
+  \details
+  The plan may be one that nufftPlanCreate() could not complete, with 
+  some of its arrays or its FFTW plan missing (NULL).
+
+  @param *plan a pointer to the plan made by nufftPlanCreate()
+
+  \version 1.0
+
+  \bug No known bugs
+
+  \warning No known warnings
+
+  \todo nothing left
+
+*/
+void nufftPlanDestroy(nufftPlan *plan)
+{
+  if (plan==NULL)
+    return;
+
+  if (plan->p!=NULL)
+    fftw_destroy_plan(plan->p);
+  fftw_free(plan->grid);
+  fftw_free(plan->Fgrid);
+  free(plan->decx);
+  free(plan->decy);
+  free(plan);
+
+  return;
+}
@@ -0,0 +1,36 @@
+/*! \file
+  \brief
+  Declarations for the non-uniform FFT of images in nufft.c
+
+  \version 1.0
+
+*/
+#ifndef NUFFT_H
+#define NUFFT_H
+
+#include<fftw3.h>
+
+#define NUFFTOVERSAMPLE 2                //!< oversampling factor of the NUFFT grid
+#define NUFFTSPREAD 12                   //!< number of grid points on each side of a sample used for interpolation (~1e-12 accuracy)
+
+/*!
+  \brief Plan for the non-uniform FFT of Ny by Nx images
+*/
+typedef struct
+{
+  int Nx,Ny;                    //!< size of the image
+  int Mx,My;                    //!< size of the oversampled grid
+  int Msp;                      //!< number of grid points on each side of a sample used for interpolation
+  double taux,tauy;             //!< widths of the gaussian interpolation kernels along the two directions
+  double *decx,*decy;           //!< deconvolution factors along the two directions
+  double *grid;                 //!< oversampled, deconvolved image
+  fftw_complex *Fgrid;          //!< FFT of the oversampled image (My by Mx/2+1)
+  fftw_plan p;                  //!< FFTW plan for the oversampled image
+} nufftPlan;
+
+nufftPlan *nufftPlanCreate(int Ny, int Nx, int Msp, unsigned planFlags);
+int nufftExecute(nufftPlan *plan, double *Image, double x0, double y0,
+		 int Nb, double *xi, double *eta, double *Vre, double *Vim);
+void nufftPlanDestroy(nufftPlan *plan);
+
+#endif
@@ -3,28 +3,32 @@
 #include<stdlib.h>
 #include<unistd.h>
 #include<string.h>
+#include<limits.h>
 
-#include "fitsio.h"
+#include "io.h"
 /*! \file
   \brief 
   Creates a synthetic static image based on a model
 
   \details
-  This program creates a synthetic static square image from a model 
+  This program creates a synthetic static image from a model 
   and stores the result in an output FITS file.
 
-  Use: synthimage [-sv] -p Npixels -c size -m modelname -d param1,param2,... filename
+  Use: synthimage [-svF] [-f 32|64] [-C algorithm[,q]] -p Nx[,Ny] -c size -m modelname -d param1,param2,... filename
 
   The required option is:
-  - "filename": sets the output image filename (FITS)
+  - "filename": sets the output image filename (FITS). With "-", the image is written to the standard output, and nothing else is printed there (as with -s), so that it can be piped into another tool (e.g., "synthimage -p 256 - | image2uv -o uv.fits -"). Any CFITSIO filename, e.g., "mem://", may be given.
 
   The optional options are:
-  - "-p Npixels": sets the number of image pixels per dimension (default 512)
+  - "-p Nx[,Ny]": sets the number of image pixels along the x- and y-directions; with a single number, the image is square (default 512). There is no limit other than the available memory
   - "-c size": physical dimension of each pixel in microarcsec (default 1.0)
   - "-m modelname": the name of the model to be used (default "gauss")
   - "-d param1,param2,...": the values of the various model parameters (separated by commas, with no spaces between them or in quotes) (default 1,0.0,0.0,20.0,20.0)
+  - "-f 32|64": sets the precision of the output image; with "32" it is written as a float (FLOAT_IMG) image, which is half the size, and with "64" (the default) as a double (DOUBLE_IMG) image. The model is always calculated in double precision.
+  - "-C algorithm[,q]": writes the image tile-compressed, one tile per row, with the algorithm "rice", "gzip", or "hcompress" of CFITSIO and the quantization level q (0 for lossless, only with gzip; see parseFITSCompression() in io.c)
   - "-s": silent mode. It does not print anything and uses defaults 
   - "-v": verbose mode. It prints a lot more information 
+  - "-F": overwrites an existing output file, by prefixing its name with the '!' of CFITSIO (see overwriteFITSName() in io.c)
 
   If no options are given, it prints a help message
 
@@ -37,6 +41,11 @@
   one gaussian component, centered at (0.0,0.0) microarcsec from the center of the image
   and with standard deviation equal to 10.0 and 2.0 microarcsec along the x- and y- 
   orientations.
+
+  - synthimage -p 4096,2048 -c 0.5 -m crescent image.fits
+
+  Creates a synthetic image with 4096 columns and 2048 rows, with each pixel having a
+  physical dimension of 0.5 microarcsec, from the default crescent model.
   
   \author Dimitrios Psaltis
   
@@ -55,7 +64,6 @@
 
 #define VMODEDEFAULT 1                     //!< default verbose mode "medium"
 #define MAXCHAR 80                         //!< maximum number of characters for strings
-#define MAXPIXEL 4096                      //!< maximum number of pixels per size of image
 #define NPIXELDEFAULT 512                  //!< default number of pixels
 #define PIXELSIZEDEFAULT 1.0               //!< default pixel size
 #define MODELDEFAULT "gauss"               //!< default model
@@ -113,25 +121,30 @@ void printhelp(void)
 {
 
     printf("\n");
-    printf("This program creates a synthetic static square image from a model\n");
+    printf("This program creates a synthetic static image from a model\n");
     printf("and stores the result in an output FITS file.\n");
     printf("\n");
     
     printf("Use:\n");
-    printf("  synthimage [-sv] -p Npixels -c size -m modelname -d param1,param2,... filename\n");
+    printf("  synthimage [-svF] [-f 32|64] [-C algorithm[,q]] -p Nx[,Ny] -c size -m modelname -d param1,param2,... filename\n");
     printf("\n");
     printf("The required option is:\n");
-    printf("filename: sets the output image filename (FITS)\n");
+    printf("filename: sets the output image filename (FITS; - for the standard output)\n");
     printf("\n");
     printf("The optional options are:\n");
-    printf(" -p Npixels: sets the number of image pixels per dimension (default: 512)\n");
+    printf(" -p Nx[,Ny]: sets the number of image pixels along x and y; a single number gives a square image (default: 512)\n");
     printf(" -c  size: physical dimension of each pixel in microarcsec (default: 1.0)\n");
     printf(" -m modelname: the name of the model to be used (default: gauss)\n");
     printf(" -d param1,param2,...: the values of the various model parameters (separated\n");
     printf("                       by commas, with no spaces between them or in quotes)\n");
     printf("                       (default 1,0.0,0.0,20.0,20.0)\n");
+    printf(" -f 32|64: writes the image in single (32) or double (64) precision (default: 64)\n");
+    printf(" -C algorithm[,q]: writes the image tile-compressed with rice, gzip, or hcompress and the\n");
+    printf("                   quantization level q (0: lossless, only with gzip; default: 0 for gzip, %g otherwise)\n",
+	   QUANTLEVEL);
     printf(" -s: silent mode. It does not print anything and uses defaults \n");
     printf(" -v: verbose mode. It prints a lot more information \n");
+    printf(" -F: overwrites an existing output file\n");
     printf("\n");
     printf("If no options are given, it prints a help message.\n");
     printf("\n");
@@ -170,7 +183,9 @@ provides a valid answer, it replaces the value for that option.
 
 @param *outFileName a string which provides and returns the output filename
 
-@param *Npixel an intereger returning the number of pixels per dimension
+@param *Ny an intereger returning the number of pixels along the y-direction (rows)
+
+@param *Nx an intereger returning the number of pixels along the x-direction (columns)
 
 @param *pixelSize a double returning the size of each pixel in microarcsec
 
@@ -185,9 +200,9 @@ provides a valid answer, it replaces the value for that option.
 \return Returns zero if successful, 1 if not
 
 */
-int verboseinput(char *outFileName, int *Npixel, double *pixelSize, char *model, int *modelNumber, char *paramstring, double param[])
+int verboseinput(char *outFileName, int *Ny, int *Nx, double *pixelSize, char *model, int *modelNumber, char *paramstring, double param[])
 {
-  int NpixelInput;               // new value for Npixel
+  int NpixelInput;               // new value for Nx or Ny
   double pixelSizeInput;         // new value for pixelSize
   int Ncomp;                     // number of components
   double paramInput;             // input value of a parameter
@@ -197,12 +212,17 @@ int verboseinput(char *outFileName, int *Npixel, double *pixelSize, char *model,
   int iComp,iParam;              // index variables to count model components and parameters
   int index;                     // cummulative index variable to count all model parameters
   
-  // ask for new number of pixels
-  printf("Number of pixels [%d]: ",*Npixel);
+  // ask for new numbers of pixels
+  printf("Number of pixels along x [%d]: ",*Nx);
   fgets(line, sizeof line, stdin);
   NpixelInput=strtol(line, &ptr, 10);
-  if (NpixelInput!=0)
-    *Npixel=NpixelInput;
+  if (NpixelInput>0)
+    *Nx=NpixelInput;
+  printf("Number of pixels along y [%d]: ",*Ny);
+  fgets(line, sizeof line, stdin);
+  NpixelInput=strtol(line, &ptr, 10);
+  if (NpixelInput>0)
+    *Ny=NpixelInput;
 
   // ask for new number of pixels
   printf("Pixel size in microarcsec [%12.5f]: ",*pixelSize);
@@ -294,10 +314,13 @@ The required options are:
 - <filename>: sets the input image filename (FITS)
 
   The optional options are:
-  - "-p Npixels": sets the number of image pixels per dimension (default 512)
+  - "-p Nx[,Ny]": sets the number of image pixels along the x- and y-directions; with a single number, the image is square (default 512). There is no limit other than the available memory
   - "-c size": physical dimension of each pixel in microarcsec (default 1.0)
   - "-m modelname": the name of the model to be used (default "gauss")
   - "-d param1,param2,...": the values of the various model parameters (separated by commas, with no spaces between them or in quotes) (default 1,0.0,0.0,20.0,20.0)
+  - "-f 32|64": sets the precision of the output image (default 64)
+  - "-C algorithm[,q]": sets the tiled compression of the output image
+  - "-F": overwrites an existing output file
   - "-s": silent mode. It does not print anything and uses defaults 
   - "-v": verbose mode. It prints a lot more information 
 
@@ -319,7 +342,9 @@ The required options are:
 
 @param *vmode an int with a flag for the chosen verbose mode (0:silent, 1: normal, 2: verbose)
 
-@param *Npixel an intereger returning the number of pixels per dimension
+@param *Ny an intereger returning the number of pixels along the y-direction (rows)
+
+@param *Nx an intereger returning the number of pixels along the x-direction (columns)
 
 @param *pixelSize a double returning the size of each pixel in microarcsec
 
@@ -329,22 +354,32 @@ The required options are:
 
 @param *paramstring a string of parameters
 
+@param *single an int returning a flag for an output image in single precision
+
+@param *comp a pointer returning the compression of the output image
+
 \return Returns zero if successful, 1 if not
 
 */
-int parse(int argc, char *argv[], char *outFileName, int *vmode, int *Npixel, double *pixelSize, char *model, char *paramstring)
+int parse(int argc, char *argv[], char *outFileName, int *vmode, int *Ny, int *Nx, double *pixelSize, char *model, char *paramstring,
+	  int *single, fitsCompression *comp)
 {
   int opt = 0;
   int index;
+  int overwrite=0;               // flag for overwriting an existing output file
   char *ptr;                     // pointer used for converting strings to numbers
+  long NxInput,NyInput;          // numbers of pixels given with -p
 
   opterr=0;            // do not print any other errors
 
   // initialize default parameters
-  *Npixel=NPIXELDEFAULT;
+  *Nx=NPIXELDEFAULT;
+  *Ny=NPIXELDEFAULT;
   *pixelSize=PIXELSIZEDEFAULT;
   strcpy(model,MODELDEFAULT);
   strcpy(paramstring,PARAMDEFAULTG);
+  *single=0;
+  comp->type=0;
 
   if (argc==1)         // if no options are given
     {
@@ -355,15 +390,23 @@ int parse(int argc, char *argv[], char *outFileName, int *vmode, int *Npixel, do
   *vmode=VMODEDEFAULT;                      // default verbose mode "high"
 
   // parse through arguments with options
-  while ((opt = getopt(argc, argv, "svp:c:m:d:")) != -1)
+  while ((opt = getopt(argc, argv, "svp:c:m:d:f:C:F")) != -1)
     {
       switch(opt)
 	{
 	case 'c':                           // size of pixels
 	  *pixelSize=strtod(optarg, &ptr);
 	  break;
-        case 'p':                           // number of pixels
-	  *Npixel=strtoumax(optarg, NULL, 10);
+        case 'p':                           // numbers of pixels, Nx or Nx,Ny
+	  NxInput=strtol(optarg, &ptr, 10);
+	  NyInput=(*ptr==',' ? strtol(ptr+1, &ptr, 10) : NxInput);
+	  if (*ptr!='\0' || NxInput<=0 || NyInput<=0 || NxInput>INT_MAX || NyInput>INT_MAX)
+	    {
+	      printErrorSynthimage("Invalid number of pixels\n");
+	      return 1;
+	    }
+	  *Nx=NxInput;
+	  *Ny=NyInput;
 	  break;
 	case 'm':                           // string with the model name
 	  strcpy(model,optarg);
@@ -371,6 +414,24 @@ int parse(int argc, char *argv[], char *outFileName, int *vmode, int *Npixel, do
 	case 'd':                           // string with the various parameters
 	  strcpy(paramstring,optarg);
 	  break;
+	case 'f':                           // precision of the output image
+	  if (strcmp(optarg,"32")==0)
+	    *single=1;
+	  else if (strcmp(optarg,"64")==0)
+	    *single=0;
+	  else
+	    {
+	      printErrorSynthimage("Invalid precision; use 32 or 64\n");
+	      return 1;
+	    }
+	  break;
+	case 'F':
+	  overwrite=1;                      // overwrite an existing output file
+	  break;
+	case 'C':                           // tiled compression of the output image
+	  if (parseFITSCompression(optarg,comp)!=0)
+	    return 1;
+	  break;
 	case 's':
 	  *vmode=0;                         // verbose mode "silent"
 	  break;
@@ -402,10 +463,16 @@ int parse(int argc, char *argv[], char *outFileName, int *vmode, int *Npixel, do
     }
 
   // output file name is the single non-option argument
-  strcpy(outFileName,argv[optind]);
+  snprintf(outFileName,MAXCHAR,"%s",argv[optind]);
+  if (overwrite && overwriteFITSName(outFileName,MAXCHAR)!=0)
+    return 1;
+
+  // the output file on the standard output cannot be mixed with messages
+  if (isFITSPipe(outFileName))
+    *vmode=0;
 
   // check all the required options
-  if (*Npixel<=0 || *Npixel>MAXPIXEL) // if the number of pixels is out of range
+  if (*Nx<=0 || *Ny<=0)               // if the number of pixels is out of range
     {
       printErrorSynthimage("Invalid number of pixels\n");
       return 1;
@@ -437,8 +504,10 @@ int main(int argc, char *argv[])
   char outFileName[MAXCHAR];                        // string for the output filenames
   char hist[MAXCHAR];                               // string for history in output FITS file
   int vmode;                                        // flag for verbose mode
+  int single;                                       // flag for an output image in single precision
+  fitsCompression comp;                             // compression of the output image
   
-  int Npixel;                                       // size of image along each side
+  int Nx,Ny;                                        // size of image along the x- and y-directions
   double pixelSize;                                 // physical sizes of image pixels along the two directions
   double *ImageOut;                                 // pointer to image array
 
@@ -451,7 +520,7 @@ int main(int argc, char *argv[])
   int writeflag;                                    // variable to store result of writing to a file
 
   // parse the command line
-  int parseflag=parse(argc, argv,&outFileName,&vmode,&Npixel, &pixelSize, &model, paramstring);
+  int parseflag=parse(argc, argv,&outFileName,&vmode,&Ny,&Nx, &pixelSize, &model, paramstring, &single, &comp);
 
   // if there was an error in parsing, return with an error code
   if (parseflag!=0) return 1;
@@ -485,23 +554,28 @@ int main(int argc, char *argv[])
   // if the verbose mode is selected, check for all parameters
   if (vmode==2)
     {
-      dummyResult=verboseinput(outFileName, &Npixel, &pixelSize, model, &modelNumber, paramstring, param);
+      dummyResult=verboseinput(outFileName, &Ny, &Nx, &pixelSize, model, &modelNumber, paramstring, param);
       // if there was a problem
       if (dummyResult!=0)
 	return 1;
     }
   
   // allocate memory for the image array
-  ImageOut = (int *)malloc(sizeof(double)*Npixel*Npixel);  // allocate memory to store image
+  ImageOut = (double *)malloc(sizeof(double)*(size_t)Nx*Ny);  // allocate memory to store image
+  if (ImageOut==NULL)
+    {
+      printErrorSynthimage("malloc failed! The image is too large for the available memory\n");
+      return 1;
+    }
 
   // calculate the brightness of the image
   switch (modelNumber)
     {
     case 0:                                                 // gaussian model
-      dummyResult=gaussModel(Npixel,pixelSize,param,ImageOut);
+      dummyResult=gaussModel(Ny,Nx,pixelSize,param,ImageOut);
       break;
     case 1:                                                 // crescent model
-      dummyResult=crescentModel(Npixel,pixelSize,param,ImageOut);
+      dummyResult=crescentModel(Ny,Nx,pixelSize,param,ImageOut);
       break;
     }
 
@@ -515,10 +589,12 @@ int main(int argc, char *argv[])
   strcpy(hist,"synthetic image from model ");
   strcat(hist,model);
   
-  writeflag=writeFITSImage(outFileName,Npixel,pixelSize*muarcsecToDegrees,ImageOut,hist);
+  // the image is converted to float when it is written in single precision
+  writeflag=writeFITSImage(outFileName,Ny,Nx,pixelSize*muarcsecToDegrees,ImageOut,hist,
+			   TDOUBLE,(single ? FLOAT_IMG : DOUBLE_IMG),&comp);
 
   if (vmode!=0)
-    printf("synthimage: Created a %dx%d synthetic image\n",Npixel,Npixel);
+    printf("synthimage: Created a %dx%d synthetic image\n",Nx,Ny);
   
   // free the allocated memory
   free(ImageOut);